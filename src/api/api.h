@@ -43,12 +43,15 @@ extern const luaL_Reg lovrModelData[];
 extern const luaL_Reg lovrQuat[];
 extern const luaL_Reg lovrRandomGenerator[];
 extern const luaL_Reg lovrRasterizer[];
+extern const luaL_Reg lovrReadback[];
 extern const luaL_Reg lovrShader[];
 extern const luaL_Reg lovrShaderBlock[];
 extern const luaL_Reg lovrSliderJoint[];
 extern const luaL_Reg lovrSoundData[];
 extern const luaL_Reg lovrSource[];
 extern const luaL_Reg lovrSphereShape[];
+extern const luaL_Reg lovrSpriteBatch[];
+extern const luaL_Reg lovrText[];
 extern const luaL_Reg lovrTexture[];
 extern const luaL_Reg lovrTextureData[];
 extern const luaL_Reg lovrThread[];
@@ -80,6 +83,7 @@ extern const char* JointTypes[];
 extern const char* MaterialColors[];
 extern const char* MaterialScalars[];
 extern const char* MaterialTextures[];
+extern const char* PointFormats[];
 extern const char* ShaderTypes[];
 extern const char* ShapeTypes[];
 extern const char* SourceTypes[];
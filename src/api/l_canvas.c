@@ -50,18 +50,45 @@ void luax_readattachments(lua_State* L, int index, Attachment* attachments, int*
   }
 }
 
-static int l_lovrCanvasNewTextureData(lua_State* L) {
-  Canvas* canvas = luax_checktype(L, 1, Canvas);
-  uint32_t index = luaL_optinteger(L, 2, 1) - 1;
+// index, x, y, width, height, format
+static void luax_readcanvasregion(lua_State* L, Canvas* canvas, uint32_t* index, uint32_t* x, uint32_t* y, uint32_t* width, uint32_t* height, TextureFormat* format) {
   uint32_t count;
   lovrCanvasGetAttachments(canvas, &count);
-  lovrAssert(index < count, "Can not create a TextureData from Texture #%d of Canvas (it only has %d textures)", index, count);
-  TextureData* textureData = lovrCanvasNewTextureData(canvas, index);
+  *index = luaL_optinteger(L, 2, 1) - 1;
+  lovrAssert(*index < count, "Can not create a TextureData from Texture #%d of Canvas (it only has %d textures)", *index + 1, count);
+  uint32_t canvasWidth = lovrCanvasGetWidth(canvas);
+  uint32_t canvasHeight = lovrCanvasGetHeight(canvas);
+  *x = luaL_optinteger(L, 3, 0);
+  *y = luaL_optinteger(L, 4, 0);
+  lovrAssert(*x <= canvasWidth && *y <= canvasHeight, "Trying to read pixels outside the Canvas's bounds");
+  *width = luaL_optinteger(L, 5, canvasWidth - *x);
+  *height = luaL_optinteger(L, 6, canvasHeight - *y);
+  lovrAssert(*width <= canvasWidth - *x && *height <= canvasHeight - *y, "Trying to read pixels outside the Canvas's bounds");
+  *format = luaL_checkoption(L, 7, "rgba", TextureFormats);
+}
+
+static int l_lovrCanvasNewTextureData(lua_State* L) {
+  Canvas* canvas = luax_checktype(L, 1, Canvas);
+  uint32_t index, x, y, width, height;
+  TextureFormat format;
+  luax_readcanvasregion(L, canvas, &index, &x, &y, &width, &height, &format);
+  TextureData* textureData = lovrCanvasNewTextureData(canvas, index, x, y, width, height, format);
   luax_pushtype(L, TextureData, textureData);
   lovrRelease(TextureData, textureData);
   return 1;
 }
 
+static int l_lovrCanvasNewTextureDataAsync(lua_State* L) {
+  Canvas* canvas = luax_checktype(L, 1, Canvas);
+  uint32_t index, x, y, width, height;
+  TextureFormat format;
+  luax_readcanvasregion(L, canvas, &index, &x, &y, &width, &height, &format);
+  Readback* readback = lovrReadbackCreate(canvas, index, x, y, width, height, format);
+  luax_pushtype(L, Readback, readback);
+  lovrRelease(Readback, readback);
+  return 1;
+}
+
 static int l_lovrCanvasRenderTo(lua_State* L) {
   Canvas* canvas = luax_checktype(L, 1, Canvas);
   luaL_checktype(L, 2, LUA_TFUNCTION);
@@ -134,6 +161,7 @@ static int l_lovrCanvasIsStereo(lua_State* L) {
 
 const luaL_Reg lovrCanvas[] = {
   { "newTextureData", l_lovrCanvasNewTextureData },
+  { "newTextureDataAsync", l_lovrCanvasNewTextureDataAsync },
   { "renderTo", l_lovrCanvasRenderTo },
   { "getTexture", l_lovrCanvasGetTexture },
   { "setTexture", l_lovrCanvasSetTexture },
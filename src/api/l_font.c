@@ -1,5 +1,11 @@
 #include "api.h"
 #include "graphics/font.h"
+#include "graphics/text.h"
+#include "core/arr.h"
+#include "core/ref.h"
+#include "core/utf.h"
+#include <stdlib.h>
+#include <string.h>
 
 static int l_lovrFontGetWidth(lua_State* L) {
   Font* font = luax_checktype(L, 1, Font);
@@ -15,6 +21,102 @@ static int l_lovrFontGetWidth(lua_State* L) {
   return 2;
 }
 
+#define MAX_CODEPOINT 0x10ffff
+
+// Reads a codepoint or a { first, last } range from the top of the stack, clamped to valid codepoints
+static void luax_readcodepointrange(lua_State* L, uint32_t* first, uint32_t* last) {
+  lua_Integer a, b;
+  if (lua_istable(L, -1)) {
+    lua_rawgeti(L, -1, 1);
+    lua_rawgeti(L, -2, 2);
+    a = luaL_checkinteger(L, -2);
+    b = luaL_optinteger(L, -1, a);
+    lua_pop(L, 2);
+  } else {
+    a = b = luaL_checkinteger(L, -1);
+  }
+
+  a = MAX(a, 0);
+  b = MIN(b, MAX_CODEPOINT);
+  if (b < a) {
+    *first = 1;
+    *last = 0;
+  } else {
+    *first = (uint32_t) a;
+    *last = (uint32_t) b;
+  }
+}
+
+// Accepts a string, or a table of codepoints and { first, last } codepoint ranges.  Tables are
+// checked before anything is allocated, so a bad entry can't leak the list.
+static int l_lovrFontPrewarm(lua_State* L) {
+  Font* font = luax_checktype(L, 1, Font);
+  arr_t(uint32_t) codepoints;
+  arr_init(&codepoints);
+
+  if (lua_type(L, 2) == LUA_TSTRING) {
+    size_t length;
+    const char* str = lua_tolstring(L, 2, &length);
+    const char* end = str + length;
+    unsigned int codepoint;
+    size_t bytes;
+    while ((bytes = utf8_decode(str, end, &codepoint)) > 0) {
+      arr_push(&codepoints, codepoint);
+      str += bytes;
+    }
+  } else {
+    luaL_checktype(L, 2, LUA_TTABLE);
+    int count = luax_len(L, 2);
+    size_t total = 0;
+    uint32_t first, last;
+    for (int i = 1; i <= count; i++) {
+      lua_rawgeti(L, 2, i);
+      luax_readcodepointrange(L, &first, &last);
+      total += first <= last ? last - first + 1 : 0;
+      lua_pop(L, 1);
+    }
+
+    arr_reserve(&codepoints, total);
+    for (int i = 1; i <= count; i++) {
+      lua_rawgeti(L, 2, i);
+      luax_readcodepointrange(L, &first, &last);
+      for (uint32_t c = first; c <= last; c++) {
+        arr_push(&codepoints, c);
+      }
+      lua_pop(L, 1);
+    }
+  }
+
+  lovrFontPrewarm(font, codepoints.data, codepoints.length);
+  arr_free(&codepoints);
+  return 0;
+}
+
+static int l_lovrFontIsAsync(lua_State* L) {
+  Font* font = luax_checktype(L, 1, Font);
+  lua_pushboolean(L, lovrFontIsAsync(font));
+  return 1;
+}
+
+static int l_lovrFontSetAsync(lua_State* L) {
+  Font* font = luax_checktype(L, 1, Font);
+  lovrFontSetAsync(font, lua_toboolean(L, 2));
+  return 0;
+}
+
+static int l_lovrFontNewText(lua_State* L) {
+  Font* font = luax_checktype(L, 1, Font);
+  size_t length;
+  const char* string = luaL_optlstring(L, 2, "", &length);
+  float wrap = luax_optfloat(L, 3, 0.f);
+  HorizontalAlign halign = luaL_checkoption(L, 4, "center", HorizontalAligns);
+  VerticalAlign valign = luaL_checkoption(L, 5, "middle", VerticalAligns);
+  Text* text = lovrTextCreate(font, string, length, wrap, halign, valign);
+  luax_pushtype(L, Text, text);
+  lovrRelease(Text, text);
+  return 1;
+}
+
 static int l_lovrFontGetHeight(lua_State* L) {
   Font* font = luax_checktype(L, 1, Font);
   lua_pushnumber(L, lovrFontGetHeight(font));
@@ -116,5 +218,9 @@ const luaL_Reg lovrFont[] = {
   { "setPixelDensity", l_lovrFontSetPixelDensity },
   { "getRasterizer", l_lovrFontGetRasterizer},
   { "hasGlyphs", l_lovrFontHasGlyphs },
+  { "newText", l_lovrFontNewText },
+  { "prewarm", l_lovrFontPrewarm },
+  { "isAsync", l_lovrFontIsAsync },
+  { "setAsync", l_lovrFontSetAsync },
   { NULL, NULL }
 };
@@ -6,6 +6,8 @@
 #include "graphics/mesh.h"
 #include "graphics/model.h"
 #include "graphics/shader.h"
+#include "graphics/spriteBatch.h"
+#include "graphics/text.h"
 #include "data/blob.h"
 #include "data/modelData.h"
 #include "data/rasterizer.h"
@@ -32,6 +34,8 @@ const char* AttributeTypes[] = {
   [I32] = "int",
   [U32] = "uint",
   [F32] = "float",
+  [F16] = "half",
+  [I10_10_10_2] = "int10_10_10_2",
   NULL
 };
 
@@ -88,6 +92,28 @@ const char* DefaultShaders[] = {
   [SHADER_PANO] = "pano",
   [SHADER_FONT] = "font",
   [SHADER_FILL] = "screenspace",
+  [SHADER_SPRITE] = "sprite",
+  NULL
+};
+
+static const char* FlushReasons[] = {
+  [FLUSH_BATCH_LIMIT] = "batchlimit",
+  [FLUSH_BUFFER_FULL] = "bufferfull",
+  [FLUSH_CAMERA] = "camera",
+  [FLUSH_CANVAS] = "canvas",
+  [FLUSH_RESOURCE] = "resource",
+  [FLUSH_EXPLICIT] = "explicit",
+  [FLUSH_STATS] = "stats",
+  NULL
+};
+
+static const char* StreamTypes[] = {
+  [STREAM_VERTEX] = "vertex",
+  [STREAM_DRAWID] = "drawid",
+  [STREAM_INDEX] = "index",
+  [STREAM_MODEL] = "model",
+  [STREAM_COLOR] = "color",
+  [STREAM_FRAME] = "frame",
   NULL
 };
 
@@ -145,6 +171,12 @@ const char* MaterialTextures[] = {
   NULL
 };
 
+const char* PointFormats[] = {
+  [POINT_FORMAT_XYZ] = "xyz",
+  [POINT_FORMAT_XYZRGBA] = "xyzrgba",
+  NULL
+};
+
 const char* ShaderTypes[] = {
   [SHADER_GRAPHICS] = "graphics",
   [SHADER_COMPUTE] = "compute",
@@ -180,6 +212,7 @@ const char* TextureFormats[] = {
   [FORMAT_DXT1] = "dxt1",
   [FORMAT_DXT3] = "dxt3",
   [FORMAT_DXT5] = "dxt5",
+  [FORMAT_BC5] = "bc5",
   [FORMAT_ASTC_4x4] = "astc4x4",
   [FORMAT_ASTC_5x4] = "astc5x4",
   [FORMAT_ASTC_5x5] = "astc5x5",
@@ -246,7 +279,8 @@ static uint32_t luax_getvertexcount(lua_State* L, int index) {
   }
 }
 
-static void luax_readvertices(lua_State* L, int index, float* v, uint32_t count) {
+// Reads count vertices, starting at vertex start
+static void luax_readvertices(lua_State* L, int index, float* v, uint32_t start, uint32_t count) {
   switch (lua_type(L, index)) {
     case LUA_TTABLE:
       lua_rawgeti(L, index, 1);
@@ -254,7 +288,7 @@ static void luax_readvertices(lua_State* L, int index, float* v, uint32_t count)
         lua_pop(L, 1);
         for (uint32_t i = 0; i < count; i++) {
           for (int j = 0; j < 3; j++) {
-            lua_rawgeti(L, index, 3 * i + j + 1);
+            lua_rawgeti(L, index, 3 * (start + i) + j + 1);
             v[j] = lua_tonumber(L, -1);
             lua_pop(L, 1);
           }
@@ -264,7 +298,7 @@ static void luax_readvertices(lua_State* L, int index, float* v, uint32_t count)
       } else {
         lua_pop(L, 1);
         for (uint32_t i = 0; i < count; i++) {
-          lua_rawgeti(L, index, i + 1);
+          lua_rawgeti(L, index, start + i + 1);
           vec3_init(v, luax_checkvector(L, -1, V_VEC3, NULL));
           lua_pop(L, 1);
           v[3] = v[4] = v[5] = v[6] = v[7] = 0.f;
@@ -276,7 +310,7 @@ static void luax_readvertices(lua_State* L, int index, float* v, uint32_t count)
     case LUA_TNUMBER:
       for (uint32_t i = 0; i < count; i++) {
         for (int j = 0; j < 3; j++) {
-          v[j] = lua_tonumber(L, index + 3 * i + j);
+          v[j] = lua_tonumber(L, index + 3 * (start + i) + j);
         }
         v[3] = v[4] = v[5] = v[6] = v[7] = 0.f;
         v += 8;
@@ -285,7 +319,7 @@ static void luax_readvertices(lua_State* L, int index, float* v, uint32_t count)
 
     default:
       for (uint32_t i = 0; i < count; i++) {
-        vec3_init(v, luax_checkvector(L, index + i, V_VEC3, NULL));
+        vec3_init(v, luax_checkvector(L, index + start + i, V_VEC3, NULL));
         v[3] = v[4] = v[5] = v[6] = v[7] = 0.f;
         v += 8;
       }
@@ -347,6 +381,10 @@ static int l_lovrGraphicsCreateWindow(lua_State* L) {
   flags.resizable = lua_toboolean(L, -1);
   lua_pop(L, 1);
 
+  lua_getfield(L, 1, "headless");
+  flags.headless = lua_toboolean(L, -1);
+  lua_pop(L, 1);
+
   lua_getfield(L, 1, "msaa");
   flags.msaa = lua_tointeger(L, -1);
   lua_pop(L, 1);
@@ -403,6 +441,13 @@ static int l_lovrGraphicsHasWindow(lua_State *L) {
   return 1;
 }
 
+static int l_lovrGraphicsNewScreenshot(lua_State* L) {
+  TextureData* textureData = lovrGraphicsNewScreenshot();
+  luax_pushtype(L, TextureData, textureData);
+  lovrRelease(TextureData, textureData);
+  return 1;
+}
+
 static int l_lovrGraphicsTick(lua_State* L) {
   const char* label = luaL_checkstring(L, 1);
   lovrGraphicsTick(label);
@@ -410,12 +455,51 @@ static int l_lovrGraphicsTick(lua_State* L) {
 }
 
 static int l_lovrGraphicsTock(lua_State* L) {
-  lovrGraphicsFlush();
   const char* label = luaL_checkstring(L, 1);
   lua_pushnumber(L, lovrGraphicsTock(label));
   return 1;
 }
 
+static int l_lovrGraphicsGetTimerZones(lua_State* L) {
+  uint32_t count = lovrGraphicsGetZoneCount();
+  lua_createtable(L, count, 0);
+  for (uint32_t i = 0; i < count; i++) {
+    GpuZoneStats zone;
+    lovrGraphicsGetZoneStats(i, &zone);
+    lua_createtable(L, 0, 8);
+    lua_pushstring(L, zone.name);
+    lua_setfield(L, -2, "name");
+    if (zone.parent != ~0u) {
+      lua_pushinteger(L, zone.parent + 1);
+      lua_setfield(L, -2, "parent");
+    }
+    lua_pushinteger(L, zone.depth);
+    lua_setfield(L, -2, "depth");
+    lua_pushinteger(L, zone.samples);
+    lua_setfield(L, -2, "samples");
+    lua_pushnumber(L, zone.last);
+    lua_setfield(L, -2, "last");
+    lua_pushnumber(L, zone.min);
+    lua_setfield(L, -2, "min");
+    lua_pushnumber(L, zone.average);
+    lua_setfield(L, -2, "average");
+    lua_pushnumber(L, zone.max);
+    lua_setfield(L, -2, "max");
+    lua_rawseti(L, -2, i + 1);
+  }
+  return 1;
+}
+
+static int l_lovrGraphicsIsProfiling(lua_State* L) {
+  lua_pushboolean(L, lovrGraphicsIsProfiling());
+  return 1;
+}
+
+static int l_lovrGraphicsSetProfiling(lua_State* L) {
+  lovrGraphicsSetProfiling(lua_toboolean(L, 1));
+  return 0;
+}
+
 static int l_lovrGraphicsGetFeatures(lua_State* L) {
   const GpuFeatures* features = lovrGraphicsGetFeatures();
   lua_newtable(L);
@@ -429,6 +513,8 @@ static int l_lovrGraphicsGetFeatures(lua_State* L) {
   lua_setfield(L, -2, "instancedstereo");
   lua_pushboolean(L, features->multiview);
   lua_setfield(L, -2, "multiview");
+  lua_pushboolean(L, features->rgtc);
+  lua_setfield(L, -2, "rgtc");
   lua_pushboolean(L, features->timers);
   lua_setfield(L, -2, "timers");
   return 1;
@@ -450,23 +536,113 @@ static int l_lovrGraphicsGetLimits(lua_State* L) {
   return 1;
 }
 
+static void luax_pushstats(lua_State* L, int index, const GpuStats* stats) {
+  lua_pushinteger(L, stats->drawCalls);
+  lua_setfield(L, index, "drawcalls");
+  lua_pushinteger(L, stats->shaderSwitches);
+  lua_setfield(L, index, "shaderswitches");
+  lua_pushinteger(L, stats->bindsAvoided);
+  lua_setfield(L, index, "bindsavoided");
+  lua_pushinteger(L, stats->textureBinds);
+  lua_setfield(L, index, "texturebinds");
+  lua_pushinteger(L, stats->framebufferBinds);
+  lua_setfield(L, index, "framebufferbinds");
+  lua_pushinteger(L, stats->pipelineChanges);
+  lua_setfield(L, index, "pipelinechanges");
+  lua_pushinteger(L, stats->bufferDiscards);
+  lua_setfield(L, index, "bufferdiscards");
+  lua_pushinteger(L, stats->batchesMerged);
+  lua_setfield(L, index, "batchesmerged");
+  lua_pushnumber(L, (lua_Number) stats->textureBytes);
+  lua_setfield(L, index, "texturebytes");
+  lua_pushnumber(L, (lua_Number) stats->vertices);
+  lua_setfield(L, index, "vertices");
+  lua_pushnumber(L, (lua_Number) stats->indices);
+  lua_setfield(L, index, "indices");
+
+  lua_createtable(L, 0, MAX_FLUSH_REASONS);
+  for (int i = 0; i < MAX_FLUSH_REASONS; i++) {
+    lua_pushinteger(L, stats->flushes[i]);
+    lua_setfield(L, -2, FlushReasons[i]);
+  }
+  lua_setfield(L, index, "flushes");
+
+  lua_createtable(L, 0, MAX_STREAMS);
+  for (int i = 0; i < MAX_STREAMS; i++) {
+    lua_pushnumber(L, (lua_Number) stats->bytesMapped[i]);
+    lua_setfield(L, -2, StreamTypes[i]);
+  }
+  lua_setfield(L, index, "bytesmapped");
+
+  lua_createtable(L, 0, MAX_STREAMS);
+  for (int i = 0; i < MAX_STREAMS; i++) {
+    lua_pushnumber(L, (lua_Number) stats->bytesFlushed[i]);
+    lua_setfield(L, -2, StreamTypes[i]);
+  }
+  lua_setfield(L, index, "bytesflushed");
+}
+
 static int l_lovrGraphicsGetStats(lua_State* L) {
   if (lua_gettop(L) > 0) {
     luaL_checktype(L, 1, LUA_TTABLE);
     lua_settop(L, 1);
   } else {
-    lua_createtable(L, 0, 2);
+    lua_createtable(L, 0, 14);
   }
 
-  lovrGraphicsFlush();
-  const GpuStats* stats = lovrGraphicsGetStats();
-  lua_pushinteger(L, stats->drawCalls);
-  lua_setfield(L, 1, "drawcalls");
-  lua_pushinteger(L, stats->shaderSwitches);
-  lua_setfield(L, 1, "shaderswitches");
+  // Flushing makes the stats include pending draws.  It has its own reason, so it's easy to tell
+  // apart from the flushes the app would have had anyway.
+  lovrGraphicsFlushWithReason(FLUSH_STATS);
+  luax_pushstats(L, 1, lovrGraphicsGetStats());
+  return 1;
+}
+
+static int l_lovrGraphicsGetStatsHistory(lua_State* L) {
+  uint32_t frame = luaL_optinteger(L, 1, 1);
+  const GpuStats* stats = lovrGraphicsGetStatsHistory(frame);
+
+  if (!stats) {
+    lua_pushnil(L);
+    return 1;
+  }
+
+  if (lua_istable(L, 2)) {
+    lua_settop(L, 2);
+  } else {
+    lua_settop(L, 1);
+    lua_createtable(L, 0, 14);
+  }
+
+  luax_pushstats(L, 2, stats);
+  return 1;
+}
+
+static int l_lovrGraphicsGetTextureStreamBudget(lua_State* L) {
+  lua_pushinteger(L, lovrGraphicsGetTextureStreamBudget());
   return 1;
 }
 
+static int l_lovrGraphicsSetTextureStreamBudget(lua_State* L) {
+  lua_Integer budget = luaL_checkinteger(L, 1);
+  lovrAssert(budget >= 0, "Texture stream budget can not be negative");
+  lovrGraphicsSetTextureStreamBudget((size_t) budget);
+  return 0;
+}
+
+static int l_lovrGraphicsPrewarmShaders(lua_State* L) {
+  int top = lua_gettop(L);
+  if (top == 0) {
+    for (int i = 0; i < MAX_DEFAULT_SHADERS; i++) {
+      lovrGraphicsGetDefaultShader(i);
+    }
+  } else {
+    for (int i = 1; i <= top; i++) {
+      lovrGraphicsGetDefaultShader(luaL_checkoption(L, i, NULL, DefaultShaders));
+    }
+  }
+  return 0;
+}
+
 // State
 
 static int l_lovrGraphicsReset(lua_State* L) {
@@ -789,19 +965,56 @@ static int l_lovrGraphicsFlush(lua_State* L) {
   return 0;
 }
 
+// Blobs hold packed vertices in a PointFormat and are drawn without copying them
+static bool luax_drawblob(lua_State* L, DrawMode mode) {
+  Blob* blob = luax_totype(L, 1, Blob);
+  if (!blob) {
+    return false;
+  }
+
+  PointFormat format = luaL_checkoption(L, 2, "xyz", PointFormats);
+  uint32_t start = luaL_optinteger(L, 3, 1) - 1;
+  uint32_t count = luaL_optinteger(L, 4, 0);
+  lovrGraphicsDrawBlob(blob, format, mode, start, count);
+  return true;
+}
+
 static int l_lovrGraphicsPoints(lua_State* L) {
+  if (luax_drawblob(L, DRAW_POINTS)) {
+    return 0;
+  }
+
   float* vertices;
   uint32_t count = luax_getvertexcount(L, 1);
-  lovrGraphicsPoints(count, &vertices);
-  luax_readvertices(L, 1, vertices, count);
+  for (uint32_t i = 0; i < count;) {
+    uint32_t chunk = lovrGraphicsPoints(count - i, &vertices);
+    luax_readvertices(L, 1, vertices, i, chunk);
+    i += chunk;
+  }
   return 0;
 }
 
 static int l_lovrGraphicsLine(lua_State* L) {
+  if (luax_drawblob(L, DRAW_LINE_STRIP)) {
+    return 0;
+  }
+
   float* vertices;
   uint32_t count = luax_getvertexcount(L, 1);
-  lovrGraphicsLine(count, &vertices);
-  luax_readvertices(L, 1, vertices, count);
+  for (uint32_t i = 0; i < count;) {
+    uint32_t chunk = lovrGraphicsLine(count - i, &vertices);
+    luax_readvertices(L, 1, vertices, i, chunk);
+    i += (i + chunk < count) ? chunk - 1 : chunk; // Chunks share a vertex so the line is connected
+  }
+  return 0;
+}
+
+static int l_lovrGraphicsUpdateBlob(lua_State* L) {
+  Blob* blob = luax_checktype(L, 1, Blob);
+  size_t offset = luaL_optinteger(L, 2, 0);
+  lovrAssert(offset <= blob->size, "Tried to update past the end of the Blob");
+  size_t size = luaL_optinteger(L, 3, blob->size - offset);
+  lovrGraphicsUpdateBlob(blob, offset, size);
   return 0;
 }
 
@@ -817,8 +1030,11 @@ static int l_lovrGraphicsTriangle(lua_State* L) {
   float* vertices;
   uint32_t count = luax_getvertexcount(L, 2);
   lovrAssert(count % 3 == 0, "Triangle vertex count must be a multiple of 3");
-  lovrGraphicsTriangle(style, material, count, &vertices);
-  luax_readvertices(L, 2, vertices, count);
+  for (uint32_t i = 0; i < count;) {
+    uint32_t chunk = lovrGraphicsTriangle(style, material, count - i, &vertices);
+    luax_readvertices(L, 2, vertices, i, chunk);
+    i += chunk;
+  }
   return 0;
 }
 
@@ -1064,6 +1280,94 @@ static int l_lovrGraphicsNewShaderBlock(lua_State* L) {
   return 1;
 }
 
+static int l_lovrGraphicsNewAtlas(lua_State* L) {
+  luaL_checktype(L, 1, LUA_TTABLE);
+  uint32_t count = luax_len(L, 1);
+  lovrAssert(count > 0, "An atlas needs at least one image");
+
+  uint32_t padding = 4;
+  uint32_t maxSize = MIN(lovrGraphicsGetLimits()->textureSize, 4096);
+  bool mipmaps = true;
+  bool srgb = true;
+  bool paged = false;
+
+  if (lua_istable(L, 2)) {
+    lua_getfield(L, 2, "padding");
+    padding = lua_isnil(L, -1) ? padding : luaL_checkinteger(L, -1);
+    lua_pop(L, 1);
+
+    lua_getfield(L, 2, "size");
+    maxSize = lua_isnil(L, -1) ? maxSize : luaL_checkinteger(L, -1);
+    lua_pop(L, 1);
+
+    lua_getfield(L, 2, "mipmaps");
+    mipmaps = lua_isnil(L, -1) ? mipmaps : lua_toboolean(L, -1);
+    lua_pop(L, 1);
+
+    lua_getfield(L, 2, "linear");
+    srgb = lua_isnil(L, -1) ? srgb : !lua_toboolean(L, -1);
+    lua_pop(L, 1);
+
+    lua_getfield(L, 2, "array");
+    paged = lua_toboolean(L, -1);
+    lua_pop(L, 1);
+  }
+
+  TextureData** images = malloc(count * sizeof(TextureData*));
+  AtlasRect* rects = malloc(count * sizeof(AtlasRect));
+  lovrAssert(images && rects, "Out of memory");
+  for (uint32_t i = 0; i < count; i++) {
+    lua_rawgeti(L, 1, i + 1);
+    images[i] = luax_checktexturedata(L, -1, true);
+    lua_pop(L, 1);
+  }
+
+  uint32_t pageCount;
+  TextureData** pages = lovrTextureDataPack(images, count, padding, maxSize, paged, rects, &pageCount);
+
+  for (uint32_t i = 0; i < count; i++) {
+    lovrRelease(TextureData, images[i]);
+  }
+  free(images);
+
+  for (uint32_t i = 0; mipmaps && i < pageCount; i++) {
+    lovrTextureDataGenerateMipmaps(pages[i], srgb);
+  }
+
+  TextureType type = paged ? TEXTURE_ARRAY : TEXTURE_2D;
+  Texture* texture = lovrTextureCreate(type, pages, pageCount, srgb, mipmaps, 0);
+  lovrTextureSetFilter(texture, lovrGraphicsGetDefaultFilter());
+  luax_pushtype(L, Texture, texture);
+  lovrRelease(Texture, texture);
+
+  float width = (float) pages[0]->width;
+  float height = (float) pages[0]->height;
+  for (uint32_t i = 0; i < pageCount; i++) {
+    lovrRelease(TextureData, pages[i]);
+  }
+  free(pages);
+
+  // Each rect is { u, v, w, h, layer } in the same order as the images
+  lua_createtable(L, count, 0);
+  for (uint32_t i = 0; i < count; i++) {
+    lua_createtable(L, 5, 0);
+    lua_pushnumber(L, rects[i].x / width);
+    lua_rawseti(L, -2, 1);
+    lua_pushnumber(L, rects[i].y / height);
+    lua_rawseti(L, -2, 2);
+    lua_pushnumber(L, rects[i].width / width);
+    lua_rawseti(L, -2, 3);
+    lua_pushnumber(L, rects[i].height / height);
+    lua_rawseti(L, -2, 4);
+    lua_pushinteger(L, rects[i].page + 1);
+    lua_rawseti(L, -2, 5);
+    lua_rawseti(L, -2, i + 1);
+  }
+
+  free(rects);
+  return 2;
+}
+
 static int l_lovrGraphicsNewCanvas(lua_State* L) {
   Attachment attachments[MAX_CANVAS_ATTACHMENTS];
   int attachmentCount = 0;
@@ -1180,7 +1484,7 @@ static int l_lovrGraphicsNewFont(lua_State* L) {
     lovrRelease(Blob, blob);
   }
 
-  Font* font = lovrFontCreate(rasterizer);
+  Font* font = lovrFontCreate(rasterizer, lovrGraphicsIsGlyphCacheEnabled());
   luax_pushtype(L, Font, font);
   lovrRelease(Rasterizer, rasterizer);
   lovrRelease(Font, font);
@@ -1281,8 +1585,12 @@ static int l_lovrGraphicsNewMesh(lua_State* L) {
 
       switch (attributes[i].type) {
         case I8: case U8: stride += 1 * attributes[i].components; break;
-        case I16: case U16: stride += 2 * attributes[i].components; break;
+        case I16: case U16: case F16: stride += 2 * attributes[i].components; break;
         case I32: case U32: case F32: stride += 4 * attributes[i].components; break;
+        case I10_10_10_2:
+          lovrAssert(attributes[i].components == 4, "Attributes using the int10_10_10_2 type must have 4 components");
+          stride += 4;
+          break;
       }
       lua_pop(L, 4);
     }
@@ -1306,7 +1614,7 @@ static int l_lovrGraphicsNewMesh(lua_State* L) {
       .stride = stride,
       .type = attributes[i].type,
       .components = attributes[i].components,
-      .normalized = attributes[i].type == I8 || attributes[i].type == U8
+      .normalized = attributes[i].type == I8 || attributes[i].type == U8 || attributes[i].type == I10_10_10_2
     });
   }
 
@@ -1341,6 +1649,8 @@ static int l_lovrGraphicsNewMesh(lua_State* L) {
               case I32: *data.i32++ = luaL_optinteger(L, -1, 0); break;
               case U32: *data.u32++ = luaL_optinteger(L, -1, 0); break;
               case F32: *data.f32++ = luaL_optnumber(L, -1, 0.); break;
+              case F16: *data.u16++ = float32to16(luaL_optnumber(L, -1, 0.)); break;
+              case I10_10_10_2: *data.u32 = packInt1010102(*data.u32, k, luaL_optinteger(L, -1, 0)); data.u32 += k == 3; break;
             }
             lua_pop(L, 1);
           }
@@ -1367,9 +1677,38 @@ static int l_lovrGraphicsNewModel(lua_State* L) {
     Blob* blob = luax_readblob(L, 1, "Model");
     modelData = lovrModelDataCreate(blob);
     lovrRelease(Blob, blob);
+
+    if (lua_istable(L, 2)) {
+      lua_getfield(L, 2, "lods");
+      uint32_t levels = luaL_optinteger(L, -1, 0);
+      lua_pop(L, 1);
+
+      lua_getfield(L, 2, "lodRatio");
+      float ratio = luax_optfloat(L, -1, .5f);
+      lua_pop(L, 1);
+
+      if (levels > 0) {
+        lovrModelDataGenerateLods(modelData, levels, ratio);
+      }
+
+      // After the levels of detail are generated, so that they get optimized too
+      lua_getfield(L, 2, "optimize");
+      if (lua_toboolean(L, -1)) {
+        float acmr[2];
+        lovrModelDataOptimize(modelData, acmr);
+      }
+      lua_pop(L, 1);
+    }
   }
 
-  Model* model = lovrModelCreate(modelData);
+  bool quantize = false;
+  if (lua_istable(L, 2)) {
+    lua_getfield(L, 2, "quantize");
+    quantize = lua_toboolean(L, -1);
+    lua_pop(L, 1);
+  }
+
+  Model* model = lovrModelCreate(modelData, quantize);
   luax_pushtype(L, Model, model);
   lovrRelease(ModelData, modelData);
   lovrRelease(Model, model);
@@ -1472,6 +1811,8 @@ static int l_lovrGraphicsNewShader(lua_State* L) {
     luax_readshadersource(L, 2);
     const char* vertexSource = lua_tostring(L, 1);
     const char* fragmentSource = lua_tostring(L, 2);
+    Shader* fallback = NULL;
+    bool async = false;
 
     if (lua_istable(L, 3)) {
       lua_getfield(L, 3, "flags");
@@ -1481,9 +1822,18 @@ static int l_lovrGraphicsNewShader(lua_State* L) {
       lua_getfield(L, 3, "stereo");
       multiview = lua_isnil(L, -1) ? multiview : lua_toboolean(L, -1);
       lua_pop(L, 1);
+
+      lua_getfield(L, 3, "async");
+      async = lua_toboolean(L, -1);
+      lua_pop(L, 1);
+
+      lua_getfield(L, 3, "fallback");
+      fallback = lua_isnil(L, -1) ? NULL : luax_checktype(L, -1, Shader);
+      lua_pop(L, 1);
     }
 
-    shader = lovrShaderCreateGraphics(vertexSource, fragmentSource, flags, flagCount, multiview);
+    shader = lovrShaderCreateGraphics(vertexSource, fragmentSource, flags, flagCount, multiview, async);
+    lovrShaderSetFallback(shader, fallback);
   }
 
   luax_pushtype(L, Shader, shader);
@@ -1509,6 +1859,15 @@ static int l_lovrGraphicsNewComputeShader(lua_State* L) {
   return 1;
 }
 
+static int l_lovrGraphicsNewSpriteBatch(lua_State* L) {
+  uint32_t capacity = luaL_checkinteger(L, 1);
+  Texture* texture = lua_isnoneornil(L, 2) ? NULL : luax_checktype(L, 2, Texture);
+  SpriteBatch* batch = lovrSpriteBatchCreate(texture, capacity);
+  luax_pushtype(L, SpriteBatch, batch);
+  lovrRelease(SpriteBatch, batch);
+  return 1;
+}
+
 static int l_lovrGraphicsNewTexture(lua_State* L) {
   int index = 1;
   int width, height, depth;
@@ -1538,6 +1897,9 @@ static int l_lovrGraphicsNewTexture(lua_State* L) {
   bool mipmaps = true;
   TextureFormat format = FORMAT_RGBA;
   int msaa = 0;
+  bool async = false;
+  bool compress = false;
+  TextureFormat compressFormat = FORMAT_DXT1;
 
   if (hasFlags) {
     lua_getfield(L, index, "linear");
@@ -1559,6 +1921,25 @@ static int l_lovrGraphicsNewTexture(lua_State* L) {
     lua_getfield(L, index, "msaa");
     msaa = lua_isnil(L, -1) ? msaa : luaL_checkinteger(L, -1);
     lua_pop(L, 1);
+
+    lua_getfield(L, index, "async");
+    async = lua_toboolean(L, -1);
+    lua_pop(L, 1);
+
+    lua_getfield(L, index, "compress");
+    if (lua_type(L, -1) == LUA_TSTRING) {
+      compress = true;
+      compressFormat = (TextureFormat) luaL_checkoption(L, -1, NULL, TextureFormats);
+    } else {
+      compress = lua_toboolean(L, -1);
+    }
+    lua_pop(L, 1);
+  }
+
+  // Compression is skipped when the GPU can't sample the requested format
+  if (compress) {
+    const GpuFeatures* features = lovrGraphicsGetFeatures();
+    compress = compressFormat == FORMAT_BC5 ? features->rgtc : features->dxt;
   }
 
   Texture* texture = lovrTextureCreate(type, NULL, 0, srgb, mipmaps, msaa);
@@ -1581,11 +1962,18 @@ static int l_lovrGraphicsNewTexture(lua_State* L) {
 
     for (int i = 0; i < depth; i++) {
       lua_rawgeti(L, 1, i + 1);
+      bool loaded = !luax_totype(L, -1, TextureData);
       TextureData* textureData = luax_checktexturedata(L, -1, type != TEXTURE_CUBE);
+
+      // TextureData objects passed in by the caller are left alone, they can be compressed directly
+      if (compress && loaded && (textureData->format == FORMAT_RGB || textureData->format == FORMAT_RGBA)) {
+        lovrTextureDataCompress(textureData, compressFormat, srgb);
+      }
+
       if (i == 0) {
         lovrTextureAllocate(texture, textureData->width, textureData->height, depth, textureData->format);
       }
-      lovrTextureReplacePixels(texture, textureData, 0, 0, i, 0);
+      lovrTextureReplacePixels(texture, textureData, 0, 0, i, 0, async);
       lovrRelease(TextureData, textureData);
       lua_pop(L, 1);
     }
@@ -1606,11 +1994,19 @@ static const luaL_Reg lovrGraphics[] = {
   { "getDimensions", l_lovrGraphicsGetDimensions },
   { "getPixelDensity", l_lovrGraphicsGetPixelDensity },
   { "hasWindow", l_lovrGraphicsHasWindow },
+  { "newScreenshot", l_lovrGraphicsNewScreenshot },
   { "tick", l_lovrGraphicsTick },
   { "tock", l_lovrGraphicsTock },
+  { "getTimerZones", l_lovrGraphicsGetTimerZones },
+  { "isProfiling", l_lovrGraphicsIsProfiling },
+  { "setProfiling", l_lovrGraphicsSetProfiling },
   { "getFeatures", l_lovrGraphicsGetFeatures },
   { "getLimits", l_lovrGraphicsGetLimits },
   { "getStats", l_lovrGraphicsGetStats },
+  { "getStatsHistory", l_lovrGraphicsGetStatsHistory },
+  { "getTextureStreamBudget", l_lovrGraphicsGetTextureStreamBudget },
+  { "setTextureStreamBudget", l_lovrGraphicsSetTextureStreamBudget },
+  { "prewarmShaders", l_lovrGraphicsPrewarmShaders },
 
   // State
   { "reset", l_lovrGraphicsReset },
@@ -1661,6 +2057,7 @@ static const luaL_Reg lovrGraphics[] = {
   { "flush", l_lovrGraphicsFlush },
   { "points", l_lovrGraphicsPoints },
   { "line", l_lovrGraphicsLine },
+  { "updateBlob", l_lovrGraphicsUpdateBlob },
   { "triangle", l_lovrGraphicsTriangle },
   { "plane", l_lovrGraphicsPlane },
   { "cube", l_lovrGraphicsCube },
@@ -1676,6 +2073,7 @@ static const luaL_Reg lovrGraphics[] = {
   { "compute", l_lovrGraphicsCompute },
 
   // Types
+  { "newAtlas", l_lovrGraphicsNewAtlas },
   { "newCanvas", l_lovrGraphicsNewCanvas },
   { "newFont", l_lovrGraphicsNewFont },
   { "newMaterial", l_lovrGraphicsNewMaterial },
@@ -1684,6 +2082,7 @@ static const luaL_Reg lovrGraphics[] = {
   { "newShader", l_lovrGraphicsNewShader },
   { "newComputeShader", l_lovrGraphicsNewComputeShader },
   { "newShaderBlock", l_lovrGraphicsNewShaderBlock },
+  { "newSpriteBatch", l_lovrGraphicsNewSpriteBatch },
   { "newTexture", l_lovrGraphicsNewTexture },
 
   { NULL, NULL }
@@ -1697,12 +2096,48 @@ int luaopen_lovr_graphics(lua_State* L) {
   luax_registertype(L, Material);
   luax_registertype(L, Mesh);
   luax_registertype(L, Model);
+  luax_registertype(L, Readback);
   luax_registertype(L, Shader);
   luax_registertype(L, ShaderBlock);
+  luax_registertype(L, SpriteBatch);
+  luax_registertype(L, Text);
   luax_registertype(L, Texture);
-  lovrGraphicsInit();
-
   luax_pushconf(L);
+
+  bool shaderCache = true;
+  bool glyphCache = false;
+  uint32_t vertexCount = (1 << 16) - 1;
+  uint32_t indexCount = 1 << 16;
+  lua_getfield(L, -1, "graphics");
+  if (lua_istable(L, -1)) {
+    lua_getfield(L, -1, "shadercache");
+    shaderCache = lua_isnil(L, -1) || lua_toboolean(L, -1);
+    lua_pop(L, 1);
+
+    lua_getfield(L, -1, "glyphcache");
+    glyphCache = lua_toboolean(L, -1);
+    lua_pop(L, 1);
+
+    lua_getfield(L, -1, "streams");
+    if (lua_istable(L, -1)) {
+      lua_getfield(L, -1, "vertices");
+      lua_Integer vertices = luaL_optinteger(L, -1, vertexCount);
+      lovrAssert(vertices > 0 && vertices <= UINT32_MAX, "t.graphics.streams.vertices must be between 1 and %u", UINT32_MAX);
+      vertexCount = (uint32_t) vertices;
+      lua_pop(L, 1);
+
+      lua_getfield(L, -1, "indices");
+      lua_Integer indices = luaL_optinteger(L, -1, indexCount);
+      lovrAssert(indices > 0 && indices <= UINT32_MAX, "t.graphics.streams.indices must be between 1 and %u", UINT32_MAX);
+      indexCount = (uint32_t) indices;
+      lua_pop(L, 1);
+    }
+    lua_pop(L, 1);
+  }
+  lua_pop(L, 1);
+
+  lovrGraphicsInit(shaderCache, glyphCache, vertexCount, indexCount);
+
   lua_pushcfunction(L, l_lovrGraphicsCreateWindow);
   lua_getfield(L, -2, "window");
   lua_call(L, 1, 0);
@@ -79,7 +79,7 @@ static int l_lovrMeshDraw(lua_State* L) {
   float transform[16];
   int index = luax_readmat4(L, 2, transform, 1);
   int instances = luaL_optinteger(L, index, 1);
-  lovrGraphicsDrawMesh(mesh, transform, instances, NULL);
+  lovrGraphicsDrawMesh(mesh, transform, instances, NULL, 0);
   return 0;
 }
 
@@ -148,6 +148,8 @@ static int l_lovrMeshGetVertex(lua_State* L) {
         case I32: lua_pushinteger(L, *data.i32++); break;
         case U32: lua_pushinteger(L, *data.u32++); break;
         case F32: lua_pushnumber(L, *data.f32++); break;
+        case F16: lua_pushnumber(L, float16to32(*data.u16++)); break;
+        case I10_10_10_2: lua_pushinteger(L, unpackInt1010102(*data.u32, j)); data.u32 += j == 3; break;
       }
     }
   }
@@ -188,6 +190,8 @@ static int l_lovrMeshSetVertex(lua_State* L) {
         case I32: *data.i32++ = luaL_optinteger(L, k, 0); break;
         case U32: *data.u32++ = luaL_optinteger(L, k, 0); break;
         case F32: *data.f32++ = luaL_optnumber(L, k, 0.); break;
+        case F16: *data.u16++ = float32to16(luaL_optnumber(L, k, 0.)); break;
+        case I10_10_10_2: *data.u32 = packInt1010102(*data.u32, j, luaL_optinteger(L, k, 0)); data.u32 += j == 3; break;
       }
 
       if (table) {
@@ -219,6 +223,8 @@ static int l_lovrMeshGetVertexAttribute(lua_State* L) {
       case I32: lua_pushinteger(L, *data.i32++); break;
       case U32: lua_pushinteger(L, *data.u32++); break;
       case F32: lua_pushnumber(L, *data.f32++); break;
+      case F16: lua_pushnumber(L, float16to32(*data.u16++)); break;
+      case I10_10_10_2: lua_pushinteger(L, unpackInt1010102(*data.u32, i)); data.u32 += i == 3; break;
     }
   }
   return attribute->components;
@@ -249,6 +255,8 @@ static int l_lovrMeshSetVertexAttribute(lua_State* L) {
       case I32: *data.i32++ = luaL_optinteger(L, index, 0); break;
       case U32: *data.u32++ = luaL_optinteger(L, index, 0); break;
       case F32: *data.f32++ = luaL_optnumber(L, index, 0.); break;
+      case F16: *data.u16++ = float32to16(luaL_optnumber(L, index, 0.)); break;
+      case I10_10_10_2: *data.u32 = packInt1010102(*data.u32, i, luaL_optinteger(L, index, 0)); data.u32 += i == 3; break;
     }
 
     if (table) {
@@ -264,6 +272,8 @@ static int l_lovrMeshSetVertexAttribute(lua_State* L) {
     case I32: attributeSize = attribute->components * sizeof(int32_t); break;
     case U32: attributeSize = attribute->components * sizeof(uint32_t); break;
     case F32: attributeSize = attribute->components * sizeof(float); break;
+    case F16: attributeSize = attribute->components * sizeof(uint16_t); break;
+    case I10_10_10_2: attributeSize = sizeof(uint32_t); break;
   }
   lovrBufferFlush(mesh->vertexBuffer, vertexIndex * attribute->stride + attribute->offset, attributeSize);
   return 0;
@@ -272,6 +282,23 @@ static int l_lovrMeshSetVertexAttribute(lua_State* L) {
 static int l_lovrMeshSetVertices(lua_State* L) {
   Mesh* mesh = luax_checktype(L, 1, Mesh);
   uint32_t capacity = lovrMeshGetVertexCount(mesh);
+
+  if (lua_type(L, 2) == LUA_TUSERDATA) {
+    Blob* blob = luax_checktype(L, 2, Blob);
+    uint32_t start = luaL_optinteger(L, 3, 1) - 1;
+
+    if (!mesh->vertexBuffer || mesh->attributeCount == 0 || mesh->attributes[0].buffer != mesh->vertexBuffer) {
+      lovrThrow("Mesh does not have a vertex buffer");
+    }
+
+    size_t stride = mesh->attributes[0].stride;
+    uint32_t count = (uint32_t) (blob->size / stride);
+    lovrAssert(start + count <= capacity, "Overflow in Mesh:setVertices: Mesh can only hold %d vertices", capacity);
+    memcpy(lovrBufferMap(mesh->vertexBuffer, start * stride), blob->data, count * stride);
+    lovrBufferFlush(mesh->vertexBuffer, start * stride, count * stride);
+    return 0;
+  }
+
   luaL_checktype(L, 2, LUA_TTABLE);
   uint32_t sourceSize = luax_len(L, 2);
   uint32_t start = luaL_optinteger(L, 3, 1) - 1;
@@ -307,6 +334,8 @@ static int l_lovrMeshSetVertices(lua_State* L) {
           case I32: *data.i32++ = luaL_optinteger(L, -1, 0); break;
           case U32: *data.u32++ = luaL_optinteger(L, -1, 0); break;
           case F32: *data.f32++ = luaL_optnumber(L, -1, 0.); break;
+          case F16: *data.u16++ = float32to16(luaL_optnumber(L, -1, 0.)); break;
+          case I10_10_10_2: *data.u32 = packInt1010102(*data.u32, k, luaL_optinteger(L, -1, 0)); data.u32 += k == 3; break;
         }
 
         lua_pop(L, 1);
@@ -319,6 +348,30 @@ static int l_lovrMeshSetVertices(lua_State* L) {
   return 0;
 }
 
+static int l_lovrMeshGetVertexBlob(lua_State* L) {
+  Mesh* mesh = luax_checktype(L, 1, Mesh);
+  Blob* blob = lovrMeshGetVertexBlob(mesh);
+  lovrAssert(blob, "Mesh does not have a vertex buffer");
+  luax_pushtype(L, Blob, blob);
+  return 1;
+}
+
+static int l_lovrMeshMarkDirty(lua_State* L) {
+  Mesh* mesh = luax_checktype(L, 1, Mesh);
+  uint32_t capacity = lovrMeshGetVertexCount(mesh);
+  uint32_t start = luaL_optinteger(L, 2, 1) - 1;
+  uint32_t count = luaL_optinteger(L, 3, capacity - start);
+  lovrAssert(start <= capacity && start + count <= capacity, "Invalid vertex range [%d, %d]", start + 1, start + count);
+
+  if (!mesh->vertexBuffer || mesh->attributeCount == 0 || mesh->attributes[0].buffer != mesh->vertexBuffer) {
+    lovrThrow("Mesh does not have a vertex buffer");
+  }
+
+  size_t stride = mesh->attributes[0].stride;
+  lovrBufferFlush(mesh->vertexBuffer, start * stride, count * stride);
+  return 0;
+}
+
 static int l_lovrMeshGetVertexMap(lua_State* L) {
   Mesh* mesh = luax_checktype(L, 1, Mesh);
   Buffer* buffer = lovrMeshGetIndexBuffer(mesh);
@@ -495,6 +548,8 @@ const luaL_Reg lovrMesh[] = {
   { "getVertexAttribute", l_lovrMeshGetVertexAttribute },
   { "setVertexAttribute", l_lovrMeshSetVertexAttribute },
   { "setVertices", l_lovrMeshSetVertices },
+  { "getVertexBlob", l_lovrMeshGetVertexBlob },
+  { "markDirty", l_lovrMeshMarkDirty },
   { "getVertexMap", l_lovrMeshGetVertexMap },
   { "setVertexMap", l_lovrMeshSetVertexMap },
   { "isAttributeEnabled", l_lovrMeshIsAttributeEnabled },
@@ -197,6 +197,20 @@ static int l_lovrModelGetAnimationDuration(lua_State* L) {
   return 1;
 }
 
+static int l_lovrModelGetLodThreshold(lua_State* L) {
+  Model* model = luax_checktype(L, 1, Model);
+  lua_pushnumber(L, lovrModelGetLodThreshold(model));
+  return 1;
+}
+
+static int l_lovrModelSetLodThreshold(lua_State* L) {
+  Model* model = luax_checktype(L, 1, Model);
+  float threshold = luax_checkfloat(L, 2);
+  lovrAssert(threshold >= 0.f, "LOD threshold can not be negative");
+  lovrModelSetLodThreshold(model, threshold);
+  return 0;
+}
+
 const luaL_Reg lovrModel[] = {
   { "draw", l_lovrModelDraw },
   { "animate", l_lovrModelAnimate },
@@ -211,5 +225,7 @@ const luaL_Reg lovrModel[] = {
   { "getMaterialCount", l_lovrModelGetMaterialCount },
   { "getNodeCount", l_lovrModelGetNodeCount },
   { "getAnimationDuration", l_lovrModelGetAnimationDuration },
+  { "getLodThreshold", l_lovrModelGetLodThreshold },
+  { "setLodThreshold", l_lovrModelSetLodThreshold },
   { NULL, NULL }
 };
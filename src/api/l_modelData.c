@@ -1,6 +1,25 @@
 #include "api.h"
 #include "data/modelData.h"
 
+static int l_lovrModelDataGenerateLods(lua_State* L) {
+  ModelData* modelData = luax_checktype(L, 1, ModelData);
+  uint32_t levels = luaL_optinteger(L, 2, 4);
+  float ratio = luax_optfloat(L, 3, .5f);
+  lovrModelDataGenerateLods(modelData, levels, ratio);
+  return 0;
+}
+
+static int l_lovrModelDataOptimize(lua_State* L) {
+  ModelData* modelData = luax_checktype(L, 1, ModelData);
+  float acmr[2];
+  lovrModelDataOptimize(modelData, acmr);
+  lua_pushnumber(L, acmr[0]);
+  lua_pushnumber(L, acmr[1]);
+  return 2;
+}
+
 const luaL_Reg lovrModelData[] = {
+  { "generateLods", l_lovrModelDataGenerateLods },
+  { "optimize", l_lovrModelDataOptimize },
   { NULL, NULL }
 };
@@ -0,0 +1,22 @@
+#include "api.h"
+#include "graphics/canvas.h"
+#include "data/textureData.h"
+
+static int l_lovrReadbackIsComplete(lua_State* L) {
+  Readback* readback = luax_checktype(L, 1, Readback);
+  lua_pushboolean(L, lovrReadbackIsComplete(readback));
+  return 1;
+}
+
+static int l_lovrReadbackGetTextureData(lua_State* L) {
+  Readback* readback = luax_checktype(L, 1, Readback);
+  TextureData* textureData = lovrReadbackGetTextureData(readback);
+  luax_pushtype(L, TextureData, textureData);
+  return 1;
+}
+
+const luaL_Reg lovrReadback[] = {
+  { "isComplete", l_lovrReadbackIsComplete },
+  { "getTextureData", l_lovrReadbackGetTextureData },
+  { NULL, NULL }
+};
@@ -189,6 +189,43 @@ static int l_lovrShaderGetType(lua_State* L) {
   return 1;
 }
 
+// Failed compiles raise their log here, so they don't go unnoticed while the Shader is skipped
+static int l_lovrShaderIsReady(lua_State* L) {
+  Shader* shader = luax_checktype(L, 1, Shader);
+  bool ready = lovrShaderIsReady(shader);
+  const char* error = lovrShaderGetError(shader);
+  if (error) {
+    return luaL_error(L, "%s", error);
+  }
+  lua_pushboolean(L, ready);
+  return 1;
+}
+
+static int l_lovrShaderGetError(lua_State* L) {
+  Shader* shader = luax_checktype(L, 1, Shader);
+  lovrShaderIsReady(shader);
+  const char* error = lovrShaderGetError(shader);
+  if (error) {
+    lua_pushstring(L, error);
+  } else {
+    lua_pushnil(L);
+  }
+  return 1;
+}
+
+static int l_lovrShaderGetFallback(lua_State* L) {
+  Shader* shader = luax_checktype(L, 1, Shader);
+  luax_pushtype(L, Shader, lovrShaderGetFallback(shader));
+  return 1;
+}
+
+static int l_lovrShaderSetFallback(lua_State* L) {
+  Shader* shader = luax_checktype(L, 1, Shader);
+  Shader* fallback = lua_isnoneornil(L, 2) ? NULL : luax_checktype(L, 2, Shader);
+  lovrShaderSetFallback(shader, fallback);
+  return 0;
+}
+
 static int l_lovrShaderHasUniform(lua_State* L) {
   Shader* shader = luax_checktype(L, 1, Shader);
   const char* name = luaL_checkstring(L, 2);
@@ -249,6 +286,10 @@ static int l_lovrShaderSendImage(lua_State* L) {
 
 const luaL_Reg lovrShader[] = {
   { "getType", l_lovrShaderGetType },
+  { "isReady", l_lovrShaderIsReady },
+  { "getError", l_lovrShaderGetError },
+  { "getFallback", l_lovrShaderGetFallback },
+  { "setFallback", l_lovrShaderSetFallback },
   { "hasUniform", l_lovrShaderHasUniform },
   { "send", l_lovrShaderSend },
   { "sendBlock", l_lovrShaderSendBlock },
@@ -0,0 +1,187 @@
+#include "api.h"
+#include "graphics/graphics.h"
+#include "graphics/spriteBatch.h"
+#include "graphics/texture.h"
+#include "core/maf.h"
+#include <string.h>
+
+static uint32_t luax_checkspriteindex(lua_State* L, int index, SpriteBatch* batch) {
+  lua_Integer i = luaL_checkinteger(L, index);
+  if (i < 1 || i > lovrSpriteBatchGetCount(batch)) {
+    luaL_error(L, "Invalid sprite index '%d'", (int) i);
+  }
+  return (uint32_t) i - 1;
+}
+
+// Reads the position, scale, and rotation of a sprite, leaving its rect and color alone
+static int luax_readsprite(lua_State* L, int index, Sprite* sprite) {
+  float position[4], scale[4], rotation[4];
+  index = luax_readvec3(L, index, position, NULL);
+  index = luax_readscale(L, index, scale, 2, NULL);
+  index = luax_readquat(L, index, rotation, NULL);
+  if (rotation[0] == 0.f && rotation[1] == 0.f && rotation[2] == 0.f) {
+    rotation[3] = 1.f;
+  }
+  memcpy(sprite->position, position, 3 * sizeof(float));
+  memcpy(sprite->scale, scale, 2 * sizeof(float));
+  memcpy(sprite->rotation, rotation, 4 * sizeof(float));
+  return index;
+}
+
+static int l_lovrSpriteBatchDraw(lua_State* L) {
+  SpriteBatch* batch = luax_checktype(L, 1, SpriteBatch);
+  float transform[16];
+  luax_readmat4(L, 2, transform, 1);
+  lovrGraphicsDrawSpriteBatch(batch, transform);
+  return 0;
+}
+
+static int l_lovrSpriteBatchAdd(lua_State* L) {
+  SpriteBatch* batch = luax_checktype(L, 1, SpriteBatch);
+  Sprite sprite = { .rect = { 0.f, 0.f, 1.f, 1.f }, .color = { 0xff, 0xff, 0xff, 0xff } };
+  luax_readsprite(L, 2, &sprite);
+  uint32_t index = lovrSpriteBatchGetCount(batch);
+  lovrSpriteBatchSetSprite(batch, index, &sprite);
+  lua_pushinteger(L, index + 1);
+  return 1;
+}
+
+static int l_lovrSpriteBatchGet(lua_State* L) {
+  SpriteBatch* batch = luax_checktype(L, 1, SpriteBatch);
+  uint32_t index = luax_checkspriteindex(L, 2, batch);
+  const Sprite* sprite = lovrSpriteBatchGetSprite(batch, index);
+  float rotation[4], angle, ax, ay, az;
+  memcpy(rotation, sprite->rotation, 4 * sizeof(float));
+  quat_getAngleAxis(rotation, &angle, &ax, &ay, &az);
+  lua_pushnumber(L, sprite->position[0]);
+  lua_pushnumber(L, sprite->position[1]);
+  lua_pushnumber(L, sprite->position[2]);
+  lua_pushnumber(L, sprite->scale[0]);
+  lua_pushnumber(L, sprite->scale[1]);
+  lua_pushnumber(L, angle);
+  lua_pushnumber(L, ax);
+  lua_pushnumber(L, ay);
+  lua_pushnumber(L, az);
+  return 9;
+}
+
+static int l_lovrSpriteBatchSet(lua_State* L) {
+  SpriteBatch* batch = luax_checktype(L, 1, SpriteBatch);
+  uint32_t index = luax_checkspriteindex(L, 2, batch);
+  Sprite sprite = *lovrSpriteBatchGetSprite(batch, index);
+  luax_readsprite(L, 3, &sprite);
+  lovrSpriteBatchSetSprite(batch, index, &sprite);
+  return 0;
+}
+
+static int l_lovrSpriteBatchGetColor(lua_State* L) {
+  SpriteBatch* batch = luax_checktype(L, 1, SpriteBatch);
+  uint32_t index = luax_checkspriteindex(L, 2, batch);
+  const Sprite* sprite = lovrSpriteBatchGetSprite(batch, index);
+  for (int i = 0; i < 4; i++) {
+    lua_pushnumber(L, sprite->color[i] / 255.);
+  }
+  return 4;
+}
+
+static int l_lovrSpriteBatchSetColor(lua_State* L) {
+  SpriteBatch* batch = luax_checktype(L, 1, SpriteBatch);
+  uint32_t index = luax_checkspriteindex(L, 2, batch);
+  Sprite sprite = *lovrSpriteBatchGetSprite(batch, index);
+  Color color;
+  luax_readcolor(L, 3, &color);
+  float channels[4] = { color.r, color.g, color.b, color.a };
+  for (int i = 0; i < 4; i++) {
+    float x = channels[i];
+    sprite.color[i] = (uint8_t) (CLAMP(x, 0.f, 1.f) * 255.f + .5f);
+  }
+  lovrSpriteBatchSetSprite(batch, index, &sprite);
+  return 0;
+}
+
+static int l_lovrSpriteBatchGetRect(lua_State* L) {
+  SpriteBatch* batch = luax_checktype(L, 1, SpriteBatch);
+  uint32_t index = luax_checkspriteindex(L, 2, batch);
+  const Sprite* sprite = lovrSpriteBatchGetSprite(batch, index);
+  for (int i = 0; i < 4; i++) {
+    lua_pushnumber(L, sprite->rect[i]);
+  }
+  return 4;
+}
+
+// Also accepts the rect tables returned by lovr.graphics.newAtlas
+static int l_lovrSpriteBatchSetRect(lua_State* L) {
+  SpriteBatch* batch = luax_checktype(L, 1, SpriteBatch);
+  uint32_t index = luax_checkspriteindex(L, 2, batch);
+  Sprite sprite = *lovrSpriteBatchGetSprite(batch, index);
+  if (lua_istable(L, 3)) {
+    for (int i = 0; i < 4; i++) {
+      lua_rawgeti(L, 3, i + 1);
+      sprite.rect[i] = luax_checkfloat(L, -1);
+      lua_pop(L, 1);
+    }
+  } else {
+    sprite.rect[0] = luax_optfloat(L, 3, 0.f);
+    sprite.rect[1] = luax_optfloat(L, 4, 0.f);
+    sprite.rect[2] = luax_optfloat(L, 5, 1.f);
+    sprite.rect[3] = luax_optfloat(L, 6, 1.f);
+  }
+  lovrSpriteBatchSetSprite(batch, index, &sprite);
+  return 0;
+}
+
+static int l_lovrSpriteBatchRemove(lua_State* L) {
+  SpriteBatch* batch = luax_checktype(L, 1, SpriteBatch);
+  uint32_t index = luax_checkspriteindex(L, 2, batch);
+  lovrSpriteBatchRemove(batch, index);
+  return 0;
+}
+
+static int l_lovrSpriteBatchClear(lua_State* L) {
+  SpriteBatch* batch = luax_checktype(L, 1, SpriteBatch);
+  lovrSpriteBatchClear(batch);
+  return 0;
+}
+
+static int l_lovrSpriteBatchGetCount(lua_State* L) {
+  SpriteBatch* batch = luax_checktype(L, 1, SpriteBatch);
+  lua_pushinteger(L, lovrSpriteBatchGetCount(batch));
+  return 1;
+}
+
+static int l_lovrSpriteBatchGetCapacity(lua_State* L) {
+  SpriteBatch* batch = luax_checktype(L, 1, SpriteBatch);
+  lua_pushinteger(L, lovrSpriteBatchGetCapacity(batch));
+  return 1;
+}
+
+static int l_lovrSpriteBatchGetTexture(lua_State* L) {
+  SpriteBatch* batch = luax_checktype(L, 1, SpriteBatch);
+  luax_pushtype(L, Texture, lovrSpriteBatchGetTexture(batch));
+  return 1;
+}
+
+static int l_lovrSpriteBatchSetTexture(lua_State* L) {
+  SpriteBatch* batch = luax_checktype(L, 1, SpriteBatch);
+  Texture* texture = lua_isnoneornil(L, 2) ? NULL : luax_checktype(L, 2, Texture);
+  lovrSpriteBatchSetTexture(batch, texture);
+  return 0;
+}
+
+const luaL_Reg lovrSpriteBatch[] = {
+  { "draw", l_lovrSpriteBatchDraw },
+  { "add", l_lovrSpriteBatchAdd },
+  { "get", l_lovrSpriteBatchGet },
+  { "set", l_lovrSpriteBatchSet },
+  { "getColor", l_lovrSpriteBatchGetColor },
+  { "setColor", l_lovrSpriteBatchSetColor },
+  { "getRect", l_lovrSpriteBatchGetRect },
+  { "setRect", l_lovrSpriteBatchSetRect },
+  { "remove", l_lovrSpriteBatchRemove },
+  { "clear", l_lovrSpriteBatchClear },
+  { "getCount", l_lovrSpriteBatchGetCount },
+  { "getCapacity", l_lovrSpriteBatchGetCapacity },
+  { "getTexture", l_lovrSpriteBatchGetTexture },
+  { "setTexture", l_lovrSpriteBatchSetTexture },
+  { NULL, NULL }
+};
@@ -0,0 +1,98 @@
+#include "api.h"
+#include "graphics/graphics.h"
+#include "graphics/text.h"
+
+static int l_lovrTextDraw(lua_State* L) {
+  Text* text = luax_checktype(L, 1, Text);
+  float transform[16];
+  luax_readmat4(L, 2, transform, 1);
+  lovrGraphicsDrawText(text, transform);
+  return 0;
+}
+
+static int l_lovrTextGetFont(lua_State* L) {
+  Text* text = luax_checktype(L, 1, Text);
+  luax_pushtype(L, Font, lovrTextGetFont(text));
+  return 1;
+}
+
+static int l_lovrTextGetString(lua_State* L) {
+  Text* text = luax_checktype(L, 1, Text);
+  size_t length;
+  const char* string = lovrTextGetString(text, &length);
+  lua_pushlstring(L, string, length);
+  return 1;
+}
+
+static int l_lovrTextSetString(lua_State* L) {
+  Text* text = luax_checktype(L, 1, Text);
+  size_t length;
+  const char* string = luaL_checklstring(L, 2, &length);
+  lovrTextSetString(text, string, length);
+  return 0;
+}
+
+static int l_lovrTextGetWrap(lua_State* L) {
+  Text* text = luax_checktype(L, 1, Text);
+  lua_pushnumber(L, lovrTextGetWrap(text));
+  return 1;
+}
+
+static int l_lovrTextSetWrap(lua_State* L) {
+  Text* text = luax_checktype(L, 1, Text);
+  lovrTextSetWrap(text, luax_optfloat(L, 2, 0.f));
+  return 0;
+}
+
+static int l_lovrTextGetAlign(lua_State* L) {
+  Text* text = luax_checktype(L, 1, Text);
+  HorizontalAlign halign;
+  VerticalAlign valign;
+  lovrTextGetAlign(text, &halign, &valign);
+  lua_pushstring(L, HorizontalAligns[halign]);
+  lua_pushstring(L, VerticalAligns[valign]);
+  return 2;
+}
+
+static int l_lovrTextSetAlign(lua_State* L) {
+  Text* text = luax_checktype(L, 1, Text);
+  HorizontalAlign halign = luaL_checkoption(L, 2, "center", HorizontalAligns);
+  VerticalAlign valign = luaL_checkoption(L, 3, "middle", VerticalAligns);
+  lovrTextSetAlign(text, halign, valign);
+  return 0;
+}
+
+static int l_lovrTextGetWidth(lua_State* L) {
+  Text* text = luax_checktype(L, 1, Text);
+  float width;
+  uint32_t lineCount;
+  uint32_t glyphCount;
+  lovrTextMeasure(text, &width, &lineCount, &glyphCount);
+  lua_pushnumber(L, width);
+  lua_pushnumber(L, lineCount + 1);
+  return 2;
+}
+
+static int l_lovrTextGetGlyphCount(lua_State* L) {
+  Text* text = luax_checktype(L, 1, Text);
+  float width;
+  uint32_t lineCount;
+  uint32_t glyphCount;
+  lovrTextMeasure(text, &width, &lineCount, &glyphCount);
+  lua_pushinteger(L, glyphCount);
+  return 1;
+}
+
+const luaL_Reg lovrText[] = {
+  { "draw", l_lovrTextDraw },
+  { "getFont", l_lovrTextGetFont },
+  { "getString", l_lovrTextGetString },
+  { "setString", l_lovrTextSetString },
+  { "getWrap", l_lovrTextGetWrap },
+  { "setWrap", l_lovrTextSetWrap },
+  { "getAlign", l_lovrTextGetAlign },
+  { "setAlign", l_lovrTextSetAlign },
+  { "getWidth", l_lovrTextGetWidth },
+  { "getGlyphCount", l_lovrTextGetGlyphCount },
+  { NULL, NULL }
+};
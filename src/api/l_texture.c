@@ -85,10 +85,17 @@ static int l_lovrTextureReplacePixels(lua_State* L) {
   int y = luaL_optinteger(L, 4, 0);
   int slice = luaL_optinteger(L, 5, 1) - 1;
   int mipmap = luaL_optinteger(L, 6, 1) - 1;
-  lovrTextureReplacePixels(texture, textureData, x, y, slice, mipmap);
+  bool async = lua_toboolean(L, 7);
+  lovrTextureReplacePixels(texture, textureData, x, y, slice, mipmap, async);
   return 0;
 }
 
+static int l_lovrTextureIsReady(lua_State* L) {
+  Texture* texture = luax_checktype(L, 1, Texture);
+  lua_pushboolean(L, lovrTextureIsReady(texture));
+  return 1;
+}
+
 static int l_lovrTextureSetFilter(lua_State* L) {
   Texture* texture = luax_checktype(L, 1, Texture);
   FilterMode mode = luaL_checkoption(L, 2, NULL, FilterModes);
@@ -118,6 +125,7 @@ const luaL_Reg lovrTexture[] = {
   { "getType", l_lovrTextureGetType },
   { "getWidth", l_lovrTextureGetWidth },
   { "getWrap", l_lovrTextureGetWrap },
+  { "isReady", l_lovrTextureIsReady },
   { "replacePixels", l_lovrTextureReplacePixels },
   { "setFilter", l_lovrTextureSetFilter },
   { "setWrap", l_lovrTextureSetWrap },
@@ -47,6 +47,27 @@ static int l_lovrTextureDataPaste(lua_State* L) {
   return 0;
 }
 
+static int l_lovrTextureDataGenerateMipmaps(lua_State* L) {
+  TextureData* textureData = luax_checktype(L, 1, TextureData);
+  bool srgb = !lua_toboolean(L, 2);
+  lovrTextureDataGenerateMipmaps(textureData, srgb);
+  return 0;
+}
+
+static int l_lovrTextureDataCompress(lua_State* L) {
+  TextureData* textureData = luax_checktype(L, 1, TextureData);
+  TextureFormat format = luaL_checkoption(L, 2, "dxt1", TextureFormats);
+  bool srgb = !lua_toboolean(L, 3);
+  lovrTextureDataCompress(textureData, format, srgb);
+  return 0;
+}
+
+static int l_lovrTextureDataGetMipmapCount(lua_State* L) {
+  TextureData* textureData = luax_checktype(L, 1, TextureData);
+  lua_pushinteger(L, MAX(textureData->mipmapCount, 1));
+  return 1;
+}
+
 static int l_lovrTextureDataGetPixel(lua_State* L) {
   TextureData* textureData = luax_checktype(L, 1, TextureData);
   int x = luaL_checkinteger(L, 2);
@@ -86,6 +107,9 @@ const luaL_Reg lovrTextureData[] = {
   { "getDimensions", l_lovrTextureDataGetDimensions },
   { "getFormat", l_lovrTextureDataGetFormat },
   { "paste", l_lovrTextureDataPaste },
+  { "generateMipmaps", l_lovrTextureDataGenerateMipmaps },
+  { "compress", l_lovrTextureDataCompress },
+  { "getMipmapCount", l_lovrTextureDataGetMipmapCount },
   { "getPixel", l_lovrTextureDataGetPixel },
   { "setPixel", l_lovrTextureDataSetPixel },
   { "getPointer", l_lovrTextureDataGetPointer },
@@ -8,6 +8,7 @@ typedef struct {
   uint32_t height;
   bool fullscreen;
   bool resizable;
+  bool headless;
   int vsync;
   int msaa;
   const char* title;
@@ -15,6 +15,7 @@
 getProcAddressProc lovrGetProcAddress = glfwGetProcAddress;
 
 static struct {
+  bool initialized;
   GLFWwindow* window;
   windowCloseCallback onWindowClose;
   windowResizeCallback onWindowResize;
@@ -97,31 +98,67 @@ static void onGlfwError(int code, const char* description) {
 }
 
 bool lovrPlatformInit() {
+#ifdef LOVR_PLATFORM_HEADLESS
+  // Without a display glfw can't initialize, but a headless context can still be used
+  state.initialized = glfwInit();
   glfwSetErrorCallback(onGlfwError);
-  return glfwInit();
+  headless.epoch = lovrPlatformGetHeadlessTime();
+  return true;
+#else
+  glfwSetErrorCallback(onGlfwError);
+  return state.initialized = glfwInit();
+#endif
 }
 
 void lovrPlatformDestroy() {
-  glfwTerminate();
+#ifdef LOVR_PLATFORM_HEADLESS
+  lovrPlatformDestroyHeadlessContext();
+#endif
+  if (state.initialized) {
+    glfwTerminate();
+  }
 }
 
 void lovrPlatformPollEvents() {
-  glfwPollEvents();
+  if (state.initialized) {
+    glfwPollEvents();
+  }
 }
 
 double lovrPlatformGetTime() {
+#ifdef LOVR_PLATFORM_HEADLESS
+  if (!state.initialized) {
+    return lovrPlatformGetHeadlessTime() - headless.epoch;
+  }
+#endif
   return glfwGetTime();
 }
 
 void lovrPlatformSetTime(double t) {
+#ifdef LOVR_PLATFORM_HEADLESS
+  if (!state.initialized) {
+    headless.epoch = lovrPlatformGetHeadlessTime() - t;
+    return;
+  }
+#endif
   glfwSetTime(t);
 }
 
 bool lovrPlatformCreateWindow(WindowFlags* flags) {
+#ifdef LOVR_PLATFORM_HEADLESS
+  if (flags->headless) {
+    return lovrPlatformCreateHeadlessContext(flags);
+  }
+#else
+  lovrAssert(!flags->headless, "Headless mode is not supported on this platform");
+#endif
+
   if (state.window) {
     return true;
   }
 
+  lovrAssert(state.initialized, "Could not create a window because there is no display");
+
   glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
   glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
   glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
@@ -166,10 +203,22 @@ bool lovrPlatformCreateWindow(WindowFlags* flags) {
 }
 
 bool lovrPlatformHasWindow() {
+#ifdef LOVR_PLATFORM_HEADLESS
+  if (headless.active) {
+    return true;
+  }
+#endif
   return state.window;
 }
 
 void lovrPlatformGetWindowSize(int* width, int* height) {
+#ifdef LOVR_PLATFORM_HEADLESS
+  if (headless.active) {
+    if (width) *width = headless.width;
+    if (height) *height = headless.height;
+    return;
+  }
+#endif
   if (state.window) {
     glfwGetWindowSize(state.window, width, height);
   } else {
@@ -179,6 +228,13 @@ void lovrPlatformGetWindowSize(int* width, int* height) {
 }
 
 void lovrPlatformGetFramebufferSize(int* width, int* height) {
+#ifdef LOVR_PLATFORM_HEADLESS
+  if (headless.active) {
+    if (width) *width = headless.width;
+    if (height) *height = headless.height;
+    return;
+  }
+#endif
   if (state.window) {
     glfwGetFramebufferSize(state.window, width, height);
   } else {
@@ -188,6 +244,10 @@ void lovrPlatformGetFramebufferSize(int* width, int* height) {
 }
 
 void lovrPlatformSetSwapInterval(int interval) {
+  if (!state.window) {
+    return;
+  }
+
 #if EMSCRIPTEN
   glfwSwapInterval(1);
 #else
@@ -196,7 +256,9 @@ void lovrPlatformSetSwapInterval(int interval) {
 }
 
 void lovrPlatformSwapBuffers() {
-  glfwSwapBuffers(state.window);
+  if (state.window) {
+    glfwSwapBuffers(state.window);
+  }
 }
 
 void lovrPlatformOnWindowClose(windowCloseCallback callback) {
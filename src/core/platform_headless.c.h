@@ -0,0 +1,218 @@
+#include "util.h"
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <dlfcn.h>
+#include <string.h>
+#include <time.h>
+
+// Include this in ONE translation unit, before platform_glfw.c.h
+
+// A context without a window, for rendering on servers and in CI.  EGL is tried first, using a
+// surfaceless display if the driver has one.  OSMesa is the fallback.  Both libraries are loaded at
+// runtime so they aren't required to run lovr normally.  Rendering goes to an offscreen Canvas
+// created by the graphics module, so nothing is ever presented.
+
+#define LOVR_PLATFORM_HEADLESS
+
+#define OSMESA_FORMAT 0x22
+#define OSMESA_RGBA 0x1908
+#define OSMESA_DEPTH_BITS 0x30
+#define OSMESA_STENCIL_BITS 0x31
+#define OSMESA_PROFILE 0x33
+#define OSMESA_CORE_PROFILE 0x34
+#define OSMESA_CONTEXT_MAJOR_VERSION 0x36
+#define OSMESA_CONTEXT_MINOR_VERSION 0x37
+#define OSMESA_UNSIGNED_BYTE 0x1401
+
+typedef void* (*OSMesaCreateContextAttribsProc)(const int* attributes, void* share);
+typedef unsigned char (*OSMesaMakeCurrentProc)(void* context, void* buffer, uint32_t type, int width, int height);
+typedef void (*OSMesaDestroyContextProc)(void* context);
+typedef gpuProc (*OSMesaGetProcAddressProc)(const char* name);
+
+static struct {
+  bool active;
+  uint32_t width;
+  uint32_t height;
+  double epoch;
+  void* library;
+  EGLDisplay display;
+  EGLContext context;
+  PFNEGLGETPROCADDRESSPROC eglGetProcAddress;
+  PFNEGLTERMINATEPROC eglTerminate;
+  PFNEGLDESTROYCONTEXTPROC eglDestroyContext;
+  PFNEGLMAKECURRENTPROC eglMakeCurrent;
+  void* osmesa;
+  uint32_t osmesaPixel;
+  OSMesaGetProcAddressProc OSMesaGetProcAddress;
+  OSMesaDestroyContextProc OSMesaDestroyContext;
+} headless;
+
+static double lovrPlatformGetHeadlessTime() {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+static gpuProc lovrPlatformGetHeadlessProcAddress(const char* name) {
+  if (headless.context) {
+    return (gpuProc) headless.eglGetProcAddress(name);
+  } else {
+    return headless.OSMesaGetProcAddress(name);
+  }
+}
+
+#define LOAD(type, name) type name = (type) dlsym(library, #name); if (!name) { dlclose(library); return false; }
+
+static bool lovrPlatformCreateEGLContext() {
+  void* library = dlopen("libEGL.so.1", RTLD_NOW | RTLD_LOCAL);
+  if (!library) {
+    return false;
+  }
+
+  LOAD(PFNEGLGETPROCADDRESSPROC, eglGetProcAddress);
+  LOAD(PFNEGLGETDISPLAYPROC, eglGetDisplay);
+  LOAD(PFNEGLQUERYSTRINGPROC, eglQueryString);
+  LOAD(PFNEGLINITIALIZEPROC, eglInitialize);
+  LOAD(PFNEGLTERMINATEPROC, eglTerminate);
+  LOAD(PFNEGLBINDAPIPROC, eglBindAPI);
+  LOAD(PFNEGLCHOOSECONFIGPROC, eglChooseConfig);
+  LOAD(PFNEGLCREATECONTEXTPROC, eglCreateContext);
+  LOAD(PFNEGLDESTROYCONTEXTPROC, eglDestroyContext);
+  LOAD(PFNEGLMAKECURRENTPROC, eglMakeCurrent);
+
+  // Prefer Mesa's surfaceless platform, which works without any display server
+  EGLDisplay display = EGL_NO_DISPLAY;
+  const char* extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+  if (extensions && strstr(extensions, "EGL_MESA_platform_surfaceless")) {
+    PFNEGLGETPLATFORMDISPLAYEXTPROC eglGetPlatformDisplayEXT = (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (eglGetPlatformDisplayEXT) {
+      display = eglGetPlatformDisplayEXT(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+    }
+  }
+
+  if (display == EGL_NO_DISPLAY) {
+    display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+  }
+
+  if (display == EGL_NO_DISPLAY || !eglInitialize(display, NULL, NULL)) {
+    dlclose(library);
+    return false;
+  }
+
+  EGLint configAttributes[] = {
+    EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+    EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+    EGL_NONE
+  };
+
+  EGLint contextAttributes[] = {
+    EGL_CONTEXT_MAJOR_VERSION, 3,
+    EGL_CONTEXT_MINOR_VERSION, 3,
+    EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+    EGL_NONE
+  };
+
+  // Surfaceless displays may not advertise any pbuffer configs, and don't need one anyway
+  EGLConfig config = NULL;
+  EGLint configCount = 0;
+  if (!eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0) {
+    config = NULL;
+  }
+
+  EGLContext context = EGL_NO_CONTEXT;
+  if (eglBindAPI(EGL_OPENGL_API)) {
+    context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+  }
+
+  if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+    if (context != EGL_NO_CONTEXT) eglDestroyContext(display, context);
+    eglTerminate(display);
+    dlclose(library);
+    return false;
+  }
+
+  headless.library = library;
+  headless.display = display;
+  headless.context = context;
+  headless.eglGetProcAddress = eglGetProcAddress;
+  headless.eglTerminate = eglTerminate;
+  headless.eglDestroyContext = eglDestroyContext;
+  headless.eglMakeCurrent = eglMakeCurrent;
+  return true;
+}
+
+static bool lovrPlatformCreateOSMesaContext() {
+  void* library = dlopen("libOSMesa.so.8", RTLD_NOW | RTLD_LOCAL);
+  if (!library) library = dlopen("libOSMesa.so", RTLD_NOW | RTLD_LOCAL);
+  if (!library) {
+    return false;
+  }
+
+  LOAD(OSMesaCreateContextAttribsProc, OSMesaCreateContextAttribs);
+  LOAD(OSMesaMakeCurrentProc, OSMesaMakeCurrent);
+  LOAD(OSMesaDestroyContextProc, OSMesaDestroyContext);
+  LOAD(OSMesaGetProcAddressProc, OSMesaGetProcAddress);
+
+  int attributes[] = {
+    OSMESA_FORMAT, OSMESA_RGBA,
+    OSMESA_DEPTH_BITS, 0,
+    OSMESA_STENCIL_BITS, 0,
+    OSMESA_PROFILE, OSMESA_CORE_PROFILE,
+    OSMESA_CONTEXT_MAJOR_VERSION, 3,
+    OSMESA_CONTEXT_MINOR_VERSION, 3,
+    0
+  };
+
+  void* context = OSMesaCreateContextAttribs(attributes, NULL);
+  if (!context) {
+    dlclose(library);
+    return false;
+  }
+
+  // OSMesa needs a buffer to use as the default framebuffer, but it's never drawn to
+  if (!OSMesaMakeCurrent(context, &headless.osmesaPixel, OSMESA_UNSIGNED_BYTE, 1, 1)) {
+    OSMesaDestroyContext(context);
+    dlclose(library);
+    return false;
+  }
+
+  headless.library = library;
+  headless.osmesa = context;
+  headless.OSMesaGetProcAddress = OSMesaGetProcAddress;
+  headless.OSMesaDestroyContext = OSMesaDestroyContext;
+  return true;
+}
+
+#undef LOAD
+
+static bool lovrPlatformCreateHeadlessContext(WindowFlags* flags) {
+  if (headless.active) {
+    return true;
+  }
+
+  if (!lovrPlatformCreateEGLContext() && !lovrPlatformCreateOSMesaContext()) {
+    return false;
+  }
+
+  headless.active = true;
+  headless.width = flags->width ? flags->width : 1080;
+  headless.height = flags->height ? flags->height : 600;
+  lovrGetProcAddress = lovrPlatformGetHeadlessProcAddress;
+  return true;
+}
+
+static void lovrPlatformDestroyHeadlessContext() {
+  if (headless.context) {
+    headless.eglMakeCurrent(headless.display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    headless.eglDestroyContext(headless.display, headless.context);
+    headless.eglTerminate(headless.display);
+  } else if (headless.osmesa) {
+    headless.OSMesaDestroyContext(headless.osmesa);
+  }
+
+  if (headless.library) {
+    dlclose(headless.library);
+  }
+
+  memset(&headless, 0, sizeof(headless));
+}
@@ -2,6 +2,7 @@
 #include <unistd.h>
 #include <string.h>
 
+#include "platform_headless.c.h"
 #include "platform_glfw.c.h"
 
 const char* lovrPlatformGetName() {
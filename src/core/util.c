@@ -23,3 +23,70 @@ void lovrThrow(const char* format, ...) {
   va_end(args);
   exit(EXIT_FAILURE);
 }
+
+uint64_t hash64(uint64_t hash, const void* data, size_t length) {
+  const uint8_t* bytes = data;
+  for (size_t i = 0; i < length; i++) {
+    hash = (hash ^ bytes[i]) * 0x100000001b3;
+  }
+  return hash;
+}
+
+// Rounds to nearest even, values too big for a half become infinity
+uint16_t float32to16(float x) {
+  union { float f; uint32_t u; } bits = { x };
+  uint32_t sign = (bits.u >> 16) & 0x8000;
+  uint32_t mantissa = bits.u & 0x7fffff;
+  int32_t exponent = (int32_t) ((bits.u >> 23) & 0xff) - 127 + 15;
+
+  if (((bits.u >> 23) & 0xff) == 0xff) {
+    return sign | 0x7c00 | (mantissa ? 0x200 : 0);
+  } else if (exponent >= 31) {
+    return sign | 0x7c00;
+  } else if (exponent <= 0) {
+    if (exponent < -10) {
+      return sign;
+    }
+
+    uint32_t shift = 14 - exponent;
+    mantissa |= 0x800000;
+    uint32_t half = mantissa >> shift;
+    uint32_t rest = mantissa & ((1u << shift) - 1);
+    uint32_t middle = 1u << (shift - 1);
+    half += rest > middle || (rest == middle && (half & 1));
+    return sign | half;
+  }
+
+  uint32_t half = ((uint32_t) exponent << 10) | (mantissa >> 13);
+  uint32_t rest = mantissa & 0x1fff;
+  half += rest > 0x1000 || (rest == 0x1000 && (half & 1));
+  return sign | half;
+}
+
+float float16to32(uint16_t x) {
+  union { uint32_t u; float f; } bits;
+  uint32_t sign = (uint32_t) (x & 0x8000) << 16;
+  uint32_t exponent = (x >> 10) & 0x1f;
+  uint32_t mantissa = x & 0x3ff;
+
+  if (exponent == 0) {
+    return (sign ? -1.f : 1.f) * mantissa / 16777216.f;
+  } else if (exponent == 0x1f) {
+    bits.u = sign | 0x7f800000 | (mantissa << 13);
+  } else {
+    bits.u = sign | ((exponent + 112) << 23) | (mantissa << 13);
+  }
+
+  return bits.f;
+}
+
+int32_t unpackInt1010102(uint32_t packed, uint32_t component) {
+  uint32_t width = component < 3 ? 10 : 2;
+  return (int32_t) (packed << (32 - 10 * component - width)) >> (32 - width);
+}
+
+uint32_t packInt1010102(uint32_t packed, uint32_t component, int32_t value) {
+  uint32_t width = component < 3 ? 10 : 2;
+  uint32_t mask = ((1u << width) - 1) << (10 * component);
+  return (packed & ~mask) | (((uint32_t) value << (10 * component)) & mask);
+}
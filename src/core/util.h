@@ -1,5 +1,6 @@
 #include <stdarg.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #pragma once
 
@@ -43,3 +44,15 @@ void lovrSetErrorCallback(errorFn* callback, void* context);
 void LOVR_NORETURN lovrThrow(const char* format, ...);
 
 #define lovrAssert(c, ...) if (!(c)) { lovrThrow(__VA_ARGS__); }
+
+// FNV-1a, pass HASH_SEED to start a new hash or a previous result to continue one
+#define HASH_SEED 0xcbf29ce484222325ull
+uint64_t hash64(uint64_t hash, const void* data, size_t length);
+
+// Half precision floats
+uint16_t float32to16(float x);
+float float16to32(uint16_t x);
+
+// Components of the packed signed 10_10_10_2 vertex format, the last one only has 2 bits
+int32_t unpackInt1010102(uint32_t packed, uint32_t component);
+uint32_t packInt1010102(uint32_t packed, uint32_t component, int32_t value);
@@ -11,15 +11,18 @@
         GL_ARB_buffer_storage,
         GL_ARB_compute_shader,
         GL_ARB_fragment_layer_viewport,
+        GL_ARB_get_program_binary,
         GL_ARB_program_interface_query,
         GL_ARB_shader_image_load_store,
         GL_ARB_shader_storage_buffer_object,
         GL_ARB_texture_storage,
         GL_ARB_viewport_array,
         GL_EXT_disjoint_timer_query,
+        GL_EXT_texture_compression_rgtc,
         GL_EXT_texture_compression_s3tc,
         GL_EXT_texture_filter_anisotropic,
         GL_EXT_texture_sRGB,
+        GL_KHR_parallel_shader_compile,
         GL_OVR_multiview,
         GL_OVR_multiview2,
         GL_OVR_multiview_multisampled_render_to_texture
@@ -29,9 +32,9 @@
     Reproducible: False
 
     Commandline:
-        --profile="core" --api="gl=3.3,gles2=3.2" --generator="c" --spec="gl" --no-loader --local-files --extensions="GL_AMD_vertex_shader_viewport_index,GL_ARB_buffer_storage,GL_ARB_compute_shader,GL_ARB_fragment_layer_viewport,GL_ARB_program_interface_query,GL_ARB_shader_image_load_store,GL_ARB_shader_storage_buffer_object,GL_ARB_texture_storage,GL_ARB_viewport_array,GL_EXT_disjoint_timer_query,GL_EXT_texture_compression_s3tc,GL_EXT_texture_filter_anisotropic,GL_EXT_texture_sRGB,GL_OVR_multiview,GL_OVR_multiview2,GL_OVR_multiview_multisampled_render_to_texture"
+        --profile="core" --api="gl=3.3,gles2=3.2" --generator="c" --spec="gl" --no-loader --local-files --extensions="GL_AMD_vertex_shader_viewport_index,GL_ARB_buffer_storage,GL_ARB_compute_shader,GL_ARB_fragment_layer_viewport,GL_ARB_get_program_binary,GL_ARB_program_interface_query,GL_ARB_shader_image_load_store,GL_ARB_shader_storage_buffer_object,GL_ARB_texture_storage,GL_ARB_viewport_array,GL_EXT_disjoint_timer_query,GL_EXT_texture_compression_rgtc,GL_EXT_texture_compression_s3tc,GL_EXT_texture_filter_anisotropic,GL_EXT_texture_sRGB,GL_KHR_parallel_shader_compile,GL_OVR_multiview,GL_OVR_multiview2,GL_OVR_multiview_multisampled_render_to_texture"
     Online:
-        https://glad.dav1d.de/#profile=core&language=c&specification=gl&api=gl%3D3.3&api=gles2%3D3.2&extensions=GL_AMD_vertex_shader_viewport_index&extensions=GL_ARB_buffer_storage&extensions=GL_ARB_compute_shader&extensions=GL_ARB_fragment_layer_viewport&extensions=GL_ARB_program_interface_query&extensions=GL_ARB_shader_image_load_store&extensions=GL_ARB_shader_storage_buffer_object&extensions=GL_ARB_texture_storage&extensions=GL_ARB_viewport_array&extensions=GL_EXT_disjoint_timer_query&extensions=GL_EXT_texture_compression_s3tc&extensions=GL_EXT_texture_filter_anisotropic&extensions=GL_EXT_texture_sRGB&extensions=GL_OVR_multiview&extensions=GL_OVR_multiview2&extensions=GL_OVR_multiview_multisampled_render_to_texture
+        https://glad.dav1d.de/#profile=core&language=c&specification=gl&api=gl%3D3.3&api=gles2%3D3.2&extensions=GL_AMD_vertex_shader_viewport_index&extensions=GL_ARB_buffer_storage&extensions=GL_ARB_compute_shader&extensions=GL_ARB_fragment_layer_viewport&extensions=GL_ARB_get_program_binary&extensions=GL_ARB_program_interface_query&extensions=GL_ARB_shader_image_load_store&extensions=GL_ARB_shader_storage_buffer_object&extensions=GL_ARB_texture_storage&extensions=GL_ARB_viewport_array&extensions=GL_EXT_disjoint_timer_query&extensions=GL_EXT_texture_compression_rgtc&extensions=GL_EXT_texture_compression_s3tc&extensions=GL_EXT_texture_filter_anisotropic&extensions=GL_EXT_texture_sRGB&extensions=GL_KHR_parallel_shader_compile&extensions=GL_OVR_multiview&extensions=GL_OVR_multiview2&extensions=GL_OVR_multiview_multisampled_render_to_texture
 */
 
 #include <stdio.h>
@@ -641,15 +644,18 @@ int GLAD_GL_AMD_vertex_shader_viewport_index = 0;
 int GLAD_GL_ARB_buffer_storage = 0;
 int GLAD_GL_ARB_compute_shader = 0;
 int GLAD_GL_ARB_fragment_layer_viewport = 0;
+int GLAD_GL_ARB_get_program_binary = 0;
 int GLAD_GL_ARB_program_interface_query = 0;
 int GLAD_GL_ARB_shader_image_load_store = 0;
 int GLAD_GL_ARB_shader_storage_buffer_object = 0;
 int GLAD_GL_ARB_texture_storage = 0;
 int GLAD_GL_ARB_viewport_array = 0;
 int GLAD_GL_EXT_disjoint_timer_query = 0;
+int GLAD_GL_EXT_texture_compression_rgtc = 0;
 int GLAD_GL_EXT_texture_compression_s3tc = 0;
 int GLAD_GL_EXT_texture_filter_anisotropic = 0;
 int GLAD_GL_EXT_texture_sRGB = 0;
+int GLAD_GL_KHR_parallel_shader_compile = 0;
 int GLAD_GL_OVR_multiview = 0;
 int GLAD_GL_OVR_multiview2 = 0;
 int GLAD_GL_OVR_multiview_multisampled_render_to_texture = 0;
@@ -680,6 +686,7 @@ PFNGLGETQUERYOBJECTUIVEXTPROC glad_glGetQueryObjectuivEXT = NULL;
 PFNGLGETQUERYOBJECTI64VEXTPROC glad_glGetQueryObjecti64vEXT = NULL;
 PFNGLGETQUERYOBJECTUI64VEXTPROC glad_glGetQueryObjectui64vEXT = NULL;
 PFNGLFRAMEBUFFERTEXTUREMULTISAMPLEMULTIVIEWOVRPROC glad_glFramebufferTextureMultisampleMultiviewOVR = NULL;
+PFNGLMAXSHADERCOMPILERTHREADSKHRPROC glad_glMaxShaderCompilerThreadsKHR = NULL;
 static void load_GL_VERSION_1_0(GLADloadproc load) {
 	if(!GLAD_GL_VERSION_1_0) return;
 	glad_glCullFace = (PFNGLCULLFACEPROC)load("glCullFace");
@@ -1102,6 +1109,12 @@ static void load_GL_ARB_compute_shader(GLADloadproc load) {
 	glad_glDispatchCompute = (PFNGLDISPATCHCOMPUTEPROC)load("glDispatchCompute");
 	glad_glDispatchComputeIndirect = (PFNGLDISPATCHCOMPUTEINDIRECTPROC)load("glDispatchComputeIndirect");
 }
+static void load_GL_ARB_get_program_binary(GLADloadproc load) {
+	if(!GLAD_GL_ARB_get_program_binary) return;
+	glad_glGetProgramBinary = (PFNGLGETPROGRAMBINARYPROC)load("glGetProgramBinary");
+	glad_glProgramBinary = (PFNGLPROGRAMBINARYPROC)load("glProgramBinary");
+	glad_glProgramParameteri = (PFNGLPROGRAMPARAMETERIPROC)load("glProgramParameteri");
+}
 static void load_GL_ARB_program_interface_query(GLADloadproc load) {
 	if(!GLAD_GL_ARB_program_interface_query) return;
 	glad_glGetProgramInterfaceiv = (PFNGLGETPROGRAMINTERFACEIVPROC)load("glGetProgramInterfaceiv");
@@ -1139,6 +1152,10 @@ static void load_GL_ARB_viewport_array(GLADloadproc load) {
 	glad_glGetFloati_v = (PFNGLGETFLOATI_VPROC)load("glGetFloati_v");
 	glad_glGetDoublei_v = (PFNGLGETDOUBLEI_VPROC)load("glGetDoublei_v");
 }
+static void load_GL_KHR_parallel_shader_compile(GLADloadproc load) {
+	if(!GLAD_GL_KHR_parallel_shader_compile) return;
+	glad_glMaxShaderCompilerThreadsKHR = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)load("glMaxShaderCompilerThreadsKHR");
+}
 static void load_GL_OVR_multiview(GLADloadproc load) {
 	if(!GLAD_GL_OVR_multiview) return;
 	glad_glFramebufferTextureMultiviewOVR = (PFNGLFRAMEBUFFERTEXTUREMULTIVIEWOVRPROC)load("glFramebufferTextureMultiviewOVR");
@@ -1149,14 +1166,17 @@ static int find_extensionsGL(void) {
 	GLAD_GL_ARB_buffer_storage = has_ext("GL_ARB_buffer_storage");
 	GLAD_GL_ARB_compute_shader = has_ext("GL_ARB_compute_shader");
 	GLAD_GL_ARB_fragment_layer_viewport = has_ext("GL_ARB_fragment_layer_viewport");
+	GLAD_GL_ARB_get_program_binary = has_ext("GL_ARB_get_program_binary");
 	GLAD_GL_ARB_program_interface_query = has_ext("GL_ARB_program_interface_query");
 	GLAD_GL_ARB_shader_image_load_store = has_ext("GL_ARB_shader_image_load_store");
 	GLAD_GL_ARB_shader_storage_buffer_object = has_ext("GL_ARB_shader_storage_buffer_object");
 	GLAD_GL_ARB_texture_storage = has_ext("GL_ARB_texture_storage");
 	GLAD_GL_ARB_viewport_array = has_ext("GL_ARB_viewport_array");
+	GLAD_GL_EXT_texture_compression_rgtc = has_ext("GL_EXT_texture_compression_rgtc");
 	GLAD_GL_EXT_texture_compression_s3tc = has_ext("GL_EXT_texture_compression_s3tc");
 	GLAD_GL_EXT_texture_filter_anisotropic = has_ext("GL_EXT_texture_filter_anisotropic");
 	GLAD_GL_EXT_texture_sRGB = has_ext("GL_EXT_texture_sRGB");
+	GLAD_GL_KHR_parallel_shader_compile = has_ext("GL_KHR_parallel_shader_compile");
 	GLAD_GL_OVR_multiview = has_ext("GL_OVR_multiview");
 	GLAD_GL_OVR_multiview2 = has_ext("GL_OVR_multiview2");
 	free_exts();
@@ -1239,11 +1259,13 @@ int gladLoadGLLoader(GLADloadproc load) {
 	if (!find_extensionsGL()) return 0;
 	load_GL_ARB_buffer_storage(load);
 	load_GL_ARB_compute_shader(load);
+	load_GL_ARB_get_program_binary(load);
 	load_GL_ARB_program_interface_query(load);
 	load_GL_ARB_shader_image_load_store(load);
 	load_GL_ARB_shader_storage_buffer_object(load);
 	load_GL_ARB_texture_storage(load);
 	load_GL_ARB_viewport_array(load);
+	load_GL_KHR_parallel_shader_compile(load);
 	load_GL_OVR_multiview(load);
 	return GLVersion.major != 0 || GLVersion.minor != 0;
 }
@@ -1639,8 +1661,10 @@ static void load_GL_OVR_multiview_multisampled_render_to_texture(GLADloadproc lo
 static int find_extensionsGLES2(void) {
 	if (!get_exts()) return 0;
 	GLAD_GL_EXT_disjoint_timer_query = has_ext("GL_EXT_disjoint_timer_query");
+	GLAD_GL_EXT_texture_compression_rgtc = has_ext("GL_EXT_texture_compression_rgtc");
 	GLAD_GL_EXT_texture_compression_s3tc = has_ext("GL_EXT_texture_compression_s3tc");
 	GLAD_GL_EXT_texture_filter_anisotropic = has_ext("GL_EXT_texture_filter_anisotropic");
+	GLAD_GL_KHR_parallel_shader_compile = has_ext("GL_KHR_parallel_shader_compile");
 	GLAD_GL_OVR_multiview = has_ext("GL_OVR_multiview");
 	GLAD_GL_OVR_multiview2 = has_ext("GL_OVR_multiview2");
 	GLAD_GL_OVR_multiview_multisampled_render_to_texture = has_ext("GL_OVR_multiview_multisampled_render_to_texture");
@@ -1707,6 +1731,7 @@ int gladLoadGLES2Loader(GLADloadproc load) {
 
 	if (!find_extensionsGLES2()) return 0;
 	load_GL_EXT_disjoint_timer_query(load);
+	load_GL_KHR_parallel_shader_compile(load);
 	load_GL_OVR_multiview(load);
 	load_GL_OVR_multiview_multisampled_render_to_texture(load);
 	return GLVersion.major != 0 || GLVersion.minor != 0;
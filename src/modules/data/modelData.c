@@ -2,7 +2,10 @@
 #include "data/blob.h"
 #include "data/textureData.h"
 #include "core/ref.h"
+#include <float.h>
+#include <math.h>
 #include <stdlib.h>
+#include <string.h>
 
 ModelData* lovrModelDataInit(ModelData* model, Blob* source) {
   if (lovrModelDataInitGltf(model, source)) {
@@ -23,9 +26,16 @@ void lovrModelDataDestroy(void* ref) {
   for (uint32_t i = 0; i < model->textureCount; i++) {
     lovrRelease(TextureData, model->textures[i]);
   }
+  for (uint32_t i = 0; i < model->bufferCount; i++) {
+    if (model->buffers[i].owned) {
+      free(model->buffers[i].data);
+    }
+  }
   map_deinit(&model->animationMap);
   map_deinit(&model->materialMap);
   map_deinit(&model->nodeMap);
+  free(model->lods);
+  free(model->lodIndices);
   free(model->data);
 }
 
@@ -66,3 +76,1165 @@ void lovrModelDataAllocate(ModelData* model) {
   map_init(&model->materialMap);
   map_init(&model->nodeMap);
 }
+
+// Simplification
+// Edges are collapsed in order of their quadric error, always onto an existing vertex so the
+// vertex buffers can be shared by every level of detail.  Vertices with the same position but
+// different attributes ("wedges") move together, and open borders and attribute seams are only
+// allowed to slide along themselves.
+
+typedef enum {
+  KIND_MANIFOLD,
+  KIND_BORDER,
+  KIND_SEAM,
+  KIND_LOCKED
+} VertexKind;
+
+static const bool canCollapse[4][4] = {
+  { 1, 1, 1, 1 },
+  { 0, 1, 0, 0 },
+  { 0, 0, 1, 0 },
+  { 0, 0, 0, 0 }
+};
+
+// Whether an edge between the two kinds shows up in both directions, used to skip duplicates
+static const bool hasOpposite[4][4] = {
+  { 1, 1, 1, 1 },
+  { 1, 0, 1, 0 },
+  { 1, 1, 1, 1 },
+  { 1, 0, 1, 0 }
+};
+
+typedef struct {
+  float a00, a11, a22, a01, a02, a12;
+  float b0, b1, b2, c, w;
+} Quadric;
+
+typedef struct {
+  uint32_t v0;
+  uint32_t v1;
+  bool bidirectional;
+  float error;
+} Collapse;
+
+typedef struct {
+  uint32_t* offsets;
+  uint32_t* next;
+  uint32_t* prev;
+} Adjacency;
+
+static void quadricFromPlane(Quadric* q, float a, float b, float c, float d, float w) {
+  q->a00 = a * a * w;
+  q->a11 = b * b * w;
+  q->a22 = c * c * w;
+  q->a01 = a * b * w;
+  q->a02 = a * c * w;
+  q->a12 = b * c * w;
+  q->b0 = a * d * w;
+  q->b1 = b * d * w;
+  q->b2 = c * d * w;
+  q->c = d * d * w;
+  q->w = w;
+}
+
+static void quadricAdd(Quadric* q, Quadric* r) {
+  q->a00 += r->a00;
+  q->a11 += r->a11;
+  q->a22 += r->a22;
+  q->a01 += r->a01;
+  q->a02 += r->a02;
+  q->a12 += r->a12;
+  q->b0 += r->b0;
+  q->b1 += r->b1;
+  q->b2 += r->b2;
+  q->c += r->c;
+  q->w += r->w;
+}
+
+// Squared distance, averaged over the planes in the quadric
+static float quadricError(Quadric* q, float* v) {
+  float x = v[0], y = v[1], z = v[2];
+  float rx = q->a00 * x + q->a01 * y + q->a02 * z + 2.f * q->b0;
+  float ry = q->a01 * x + q->a11 * y + q->a12 * z + 2.f * q->b1;
+  float rz = q->a02 * x + q->a12 * y + q->a22 * z + 2.f * q->b2;
+  float r = rx * x + ry * y + rz * z + q->c;
+  return q->w > 0.f ? fabsf(r) / q->w : 0.f;
+}
+
+static float normalize3(float* v) {
+  float length = sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+  if (length > 0.f) {
+    v[0] /= length;
+    v[1] /= length;
+    v[2] /= length;
+  }
+  return length;
+}
+
+static void quadricFromTriangle(Quadric* q, float* p0, float* p1, float* p2) {
+  float u[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+  float v[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+  float n[3] = { u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0] };
+  float area = normalize3(n) * .5f;
+  float d = n[0] * p0[0] + n[1] * p0[1] + n[2] * p0[2];
+  quadricFromPlane(q, n[0], n[1], n[2], -d, area);
+}
+
+// A plane through the edge p0-p1 that is perpendicular to the triangle, which keeps borders in place
+static void quadricFromEdge(Quadric* q, float* p0, float* p1, float* p2, float weight) {
+  float e[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+  float length = normalize3(e);
+  float v[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+  float t = v[0] * e[0] + v[1] * e[1] + v[2] * e[2];
+  float n[3] = { v[0] - e[0] * t, v[1] - e[1] * t, v[2] - e[2] * t };
+  normalize3(n);
+  float d = n[0] * p0[0] + n[1] * p0[1] + n[2] * p0[2];
+  quadricFromPlane(q, n[0], n[1], n[2], -d, length * weight);
+}
+
+static uint32_t hashPosition(float* p) {
+  uint32_t h[3];
+  memcpy(h, p, sizeof(h));
+  return (h[0] * 73856093) ^ (h[1] * 19349663) ^ (h[2] * 83492791);
+}
+
+// Builds the half edges leaving each vertex, after applying an optional remap
+static void buildAdjacency(Adjacency* adjacency, uint32_t* indices, uint32_t indexCount, uint32_t vertexCount, uint32_t* remap) {
+  memset(adjacency->offsets, 0, (vertexCount + 1) * sizeof(uint32_t));
+  for (uint32_t i = 0; i < indexCount; i++) {
+    adjacency->offsets[(remap ? remap[indices[i]] : indices[i]) + 1]++;
+  }
+
+  for (uint32_t i = 0; i < vertexCount; i++) {
+    adjacency->offsets[i + 1] += adjacency->offsets[i];
+  }
+
+  for (uint32_t i = 0; i < indexCount; i += 3) {
+    for (uint32_t j = 0; j < 3; j++) {
+      uint32_t a = indices[i + j];
+      uint32_t b = indices[i + (j + 1) % 3];
+      uint32_t c = indices[i + (j + 2) % 3];
+      if (remap) {
+        a = remap[a], b = remap[b], c = remap[c];
+      }
+      uint32_t slot = adjacency->offsets[a]++;
+      adjacency->next[slot] = b;
+      adjacency->prev[slot] = c;
+    }
+  }
+
+  // Filling in the edges moved every offset to the start of the next vertex
+  memmove(adjacency->offsets + 1, adjacency->offsets, vertexCount * sizeof(uint32_t));
+  adjacency->offsets[0] = 0;
+}
+
+static bool hasEdge(Adjacency* adjacency, uint32_t a, uint32_t b) {
+  for (uint32_t i = adjacency->offsets[a]; i < adjacency->offsets[a + 1]; i++) {
+    if (adjacency->next[i] == b) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool hasTriangleFlip(float* a, float* b, float* c, float* d) {
+  float eb[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+  float ec[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+  float ed[3] = { d[0] - a[0], d[1] - a[1], d[2] - a[2] };
+  float nc[3] = { eb[1] * ec[2] - eb[2] * ec[1], eb[2] * ec[0] - eb[0] * ec[2], eb[0] * ec[1] - eb[1] * ec[0] };
+  float nd[3] = { eb[1] * ed[2] - eb[2] * ed[1], eb[2] * ed[0] - eb[0] * ed[2], eb[0] * ed[1] - eb[1] * ed[0] };
+  return nc[0] * nd[0] + nc[1] * nd[1] + nc[2] * nd[2] <= 0.f;
+}
+
+// Whether moving vertex i0 onto i1 would turn any of the remaining triangles around i0 inside out
+static bool hasTriangleFlips(Adjacency* adjacency, float* positions, uint32_t* collapseRemap, uint32_t i0, uint32_t i1) {
+  for (uint32_t i = adjacency->offsets[i0]; i < adjacency->offsets[i0 + 1]; i++) {
+    uint32_t a = collapseRemap[adjacency->next[i]];
+    uint32_t b = collapseRemap[adjacency->prev[i]];
+    if (a == i1 || b == i1) {
+      continue;
+    }
+
+    if (hasTriangleFlip(positions + 3 * a, positions + 3 * b, positions + 3 * i0, positions + 3 * i1)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static int compareCollapses(const void* a, const void* b) {
+  float x = ((const Collapse*) a)->error;
+  float y = ((const Collapse*) b)->error;
+  return (x > y) - (x < y);
+}
+
+// Simplifies a triangle list of packed positions into result until it has at most targetCount
+// indices or nothing else can collapse.  Returns the new index count and writes the largest
+// collapse error, as a distance.
+static uint32_t simplify(uint32_t* result, uint32_t* indices, uint32_t indexCount, float* vertices, uint32_t vertexCount, uint32_t targetCount, float* error) {
+  memcpy(result, indices, indexCount * sizeof(uint32_t));
+  *error = 0.f;
+
+  uint32_t* remap = malloc(vertexCount * sizeof(uint32_t));
+  uint32_t* wedge = malloc(vertexCount * sizeof(uint32_t));
+  uint32_t* loop = malloc(vertexCount * sizeof(uint32_t));
+  uint32_t* loopback = malloc(vertexCount * sizeof(uint32_t));
+  uint32_t* collapseRemap = malloc(vertexCount * sizeof(uint32_t));
+  bool* collapseLocked = malloc(vertexCount * sizeof(bool));
+  uint8_t* kinds = malloc(vertexCount * sizeof(uint8_t));
+  float* positions = malloc(3 * vertexCount * sizeof(float));
+  Quadric* quadrics = calloc(vertexCount, sizeof(Quadric));
+  Collapse* collapses = malloc(indexCount * sizeof(Collapse));
+  Adjacency adjacency = {
+    .offsets = malloc((vertexCount + 1) * sizeof(uint32_t)),
+    .next = malloc(indexCount * sizeof(uint32_t)),
+    .prev = malloc(indexCount * sizeof(uint32_t))
+  };
+  lovrAssert(remap && wedge && loop && loopback && collapseRemap && collapseLocked && kinds && positions && quadrics && collapses, "Out of memory");
+  lovrAssert(adjacency.offsets && adjacency.next && adjacency.prev, "Out of memory");
+
+  // Positions are scaled into a unit cube so the error math works the same at any scale
+  float min[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+  float max[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+  for (uint32_t i = 0; i < vertexCount; i++) {
+    for (uint32_t j = 0; j < 3; j++) {
+      min[j] = MIN(min[j], vertices[3 * i + j]);
+      max[j] = MAX(max[j], vertices[3 * i + j]);
+    }
+  }
+
+  float extent = MAX(max[0] - min[0], max[1] - min[1]);
+  extent = MAX(extent, max[2] - min[2]);
+  float scale = extent > 0.f ? 1.f / extent : 0.f;
+  for (uint32_t i = 0; i < vertexCount; i++) {
+    for (uint32_t j = 0; j < 3; j++) {
+      positions[3 * i + j] = (vertices[3 * i + j] - min[j]) * scale;
+    }
+  }
+
+  // Wedges of the same position form a circular list, the first one is the canonical vertex
+  uint32_t tableSize = 1;
+  while (tableSize < vertexCount * 2) tableSize <<= 1;
+  uint32_t* table = malloc(tableSize * sizeof(uint32_t));
+  lovrAssert(table, "Out of memory");
+  memset(table, 0xff, tableSize * sizeof(uint32_t));
+  for (uint32_t i = 0; i < vertexCount; i++) {
+    uint32_t h = hashPosition(vertices + 3 * i) & (tableSize - 1);
+    while (table[h] != ~0u && memcmp(vertices + 3 * table[h], vertices + 3 * i, 3 * sizeof(float))) {
+      h = (h + 1) & (tableSize - 1);
+    }
+
+    if (table[h] == ~0u) {
+      table[h] = i;
+    }
+
+    remap[i] = table[h];
+    wedge[i] = i;
+    if (remap[i] != i) {
+      wedge[i] = wedge[remap[i]];
+      wedge[remap[i]] = i;
+    }
+  }
+  free(table);
+
+  // Classify vertices using the open half edges around them.  loop and loopback hold the single
+  // open edge leaving and entering each vertex, ~0 if there isn't one, or the vertex itself if
+  // there are several.
+  buildAdjacency(&adjacency, result, indexCount, vertexCount, NULL);
+  memset(loop, 0xff, vertexCount * sizeof(uint32_t));
+  memset(loopback, 0xff, vertexCount * sizeof(uint32_t));
+  for (uint32_t i = 0; i < vertexCount; i++) {
+    for (uint32_t j = adjacency.offsets[i]; j < adjacency.offsets[i + 1]; j++) {
+      uint32_t target = adjacency.next[j];
+      if (target == i) {
+        loop[i] = loopback[i] = i;
+      } else if (!hasEdge(&adjacency, target, i)) {
+        loopback[target] = loopback[target] == ~0u ? i : target;
+        loop[i] = loop[i] == ~0u ? target : i;
+      }
+    }
+  }
+
+  for (uint32_t i = 0; i < vertexCount; i++) {
+    if (remap[i] != i) {
+      kinds[i] = kinds[remap[i]];
+    } else if (wedge[i] == i) {
+      if (loop[i] == ~0u && loopback[i] == ~0u) {
+        kinds[i] = KIND_MANIFOLD;
+      } else if (loop[i] != i && loopback[i] != i && loop[i] != ~0u && loopback[i] != ~0u) {
+        kinds[i] = KIND_BORDER;
+      } else {
+        kinds[i] = KIND_LOCKED;
+      }
+    } else if (wedge[wedge[i]] == i) {
+      uint32_t w = wedge[i];
+      bool open =
+        loop[i] != ~0u && loop[i] != i && loopback[i] != ~0u && loopback[i] != i &&
+        loop[w] != ~0u && loop[w] != w && loopback[w] != ~0u && loopback[w] != w;
+      bool connected = open && remap[loopback[i]] == remap[loop[w]] && remap[loop[i]] == remap[loopback[w]];
+      kinds[i] = connected ? KIND_SEAM : KIND_LOCKED;
+    } else {
+      kinds[i] = KIND_LOCKED;
+    }
+  }
+
+  // Quadrics from the faces, plus planes along borders and seams so they resist moving inwards
+  for (uint32_t i = 0; i < indexCount; i += 3) {
+    Quadric q;
+    uint32_t* t = result + i;
+    quadricFromTriangle(&q, positions + 3 * t[0], positions + 3 * t[1], positions + 3 * t[2]);
+    quadricAdd(&quadrics[remap[t[0]]], &q);
+    quadricAdd(&quadrics[remap[t[1]]], &q);
+    quadricAdd(&quadrics[remap[t[2]]], &q);
+
+    for (uint32_t j = 0; j < 3; j++) {
+      uint32_t i0 = t[j];
+      uint32_t i1 = t[(j + 1) % 3];
+      uint32_t i2 = t[(j + 2) % 3];
+      uint8_t k0 = kinds[i0];
+      uint8_t k1 = kinds[i1];
+      bool edge0 = k0 == KIND_BORDER || k0 == KIND_SEAM;
+      bool edge1 = k1 == KIND_BORDER || k1 == KIND_SEAM;
+      if ((!edge0 && !edge1) || (edge0 && loop[i0] != i1) || (edge1 && loopback[i1] != i0)) continue;
+      if (hasOpposite[k0][k1] && remap[i1] > remap[i0]) continue;
+      float weight = (k0 == KIND_BORDER || k1 == KIND_BORDER) ? 10.f : 1.f;
+      quadricFromEdge(&q, positions + 3 * i0, positions + 3 * i1, positions + 3 * i2, weight);
+      quadricAdd(&quadrics[remap[i0]], &q);
+      quadricAdd(&quadrics[remap[i1]], &q);
+    }
+  }
+
+  float maxError = 0.f;
+  while (indexCount > targetCount) {
+    buildAdjacency(&adjacency, result, indexCount, vertexCount, remap);
+
+    // Pick the edges that are allowed to collapse, and the direction with the lower error
+    uint32_t collapseCount = 0;
+    for (uint32_t i = 0; i < indexCount; i += 3) {
+      for (uint32_t j = 0; j < 3; j++) {
+        uint32_t i0 = result[i + j];
+        uint32_t i1 = result[i + (j + 1) % 3];
+        uint8_t k0 = kinds[i0];
+        uint8_t k1 = kinds[i1];
+        if (!canCollapse[k0][k1] && !canCollapse[k1][k0]) continue;
+        if (hasOpposite[k0][k1] && remap[i1] > remap[i0]) continue;
+        if (k0 == k1 && (k0 == KIND_BORDER || k0 == KIND_SEAM) && loop[i0] != i1) continue;
+
+        Collapse* c = &collapses[collapseCount++];
+        c->bidirectional = canCollapse[k0][k1] && canCollapse[k1][k0];
+        c->v0 = canCollapse[k0][k1] ? i0 : i1;
+        c->v1 = canCollapse[k0][k1] ? i1 : i0;
+        c->error = quadricError(&quadrics[remap[c->v0]], positions + 3 * c->v1);
+
+        if (c->bidirectional) {
+          float reverse = quadricError(&quadrics[remap[c->v1]], positions + 3 * c->v0);
+          if (reverse < c->error) {
+            uint32_t v = c->v0;
+            c->v0 = c->v1;
+            c->v1 = v;
+            c->error = reverse;
+          }
+        }
+      }
+    }
+
+    if (collapseCount == 0) {
+      break;
+    }
+
+    qsort(collapses, collapseCount, sizeof(Collapse), compareCollapses);
+
+    // Each collapse locks its two vertices for the rest of the pass, so later collapses are
+    // measured against geometry that hasn't moved.  The error bound keeps a pass from running
+    // too far ahead of the cheapest collapses once the easy ones are used up.
+    uint32_t triangleGoal = (indexCount - targetCount) / 3;
+    uint32_t edgeGoal = triangleGoal / 2;
+    float errorGoal = edgeGoal < collapseCount ? collapses[edgeGoal].error * 1.5f : FLT_MAX;
+    uint32_t triangleCollapses = 0;
+    uint32_t edgeCollapses = 0;
+
+    for (uint32_t i = 0; i < vertexCount; i++) {
+      collapseRemap[i] = i;
+    }
+    memset(collapseLocked, 0, vertexCount * sizeof(bool));
+
+    for (uint32_t i = 0; i < collapseCount; i++) {
+      Collapse* c = &collapses[i];
+      uint32_t i0 = c->v0;
+      uint32_t i1 = c->v1;
+      uint32_t r0 = remap[i0];
+      uint32_t r1 = remap[i1];
+
+      if (c->error > errorGoal && triangleCollapses > triangleGoal / 10) {
+        break;
+      }
+
+      if (collapseLocked[r0] || collapseLocked[r1]) {
+        continue;
+      }
+
+      if (hasTriangleFlips(&adjacency, positions, collapseRemap, r0, r1)) {
+        continue;
+      }
+
+      if (kinds[i0] == KIND_SEAM) {
+        // Both sides of the seam move, each onto the wedge of i1 on its own side
+        uint32_t s0 = wedge[i0];
+        uint32_t s1 = loop[i0] == i1 ? loopback[s0] : loop[s0];
+        if (s1 == ~0u || remap[s1] != r1) {
+          continue;
+        }
+        collapseRemap[i0] = i1;
+        collapseRemap[s0] = s1;
+      } else {
+        uint32_t v = i0;
+        do {
+          collapseRemap[v] = i1;
+          v = wedge[v];
+        } while (v != i0);
+      }
+
+      quadricAdd(&quadrics[r1], &quadrics[r0]);
+      collapseLocked[r0] = collapseLocked[r1] = true;
+      triangleCollapses += kinds[i0] == KIND_BORDER ? 1 : 2;
+      edgeCollapses++;
+      maxError = MAX(maxError, c->error);
+
+      if (triangleCollapses >= triangleGoal) {
+        break;
+      }
+    }
+
+    if (edgeCollapses == 0) {
+      break;
+    }
+
+    // Edge loops skip over vertices that collapsed onto them
+    for (uint32_t i = 0; i < vertexCount; i++) {
+      if (loop[i] != ~0u) {
+        uint32_t r = collapseRemap[loop[i]];
+        loop[i] = r == i ? loop[loop[i]] : r;
+      }
+      if (loopback[i] != ~0u) {
+        uint32_t r = collapseRemap[loopback[i]];
+        loopback[i] = r == i ? loopback[loopback[i]] : r;
+      }
+    }
+
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < indexCount; i += 3) {
+      uint32_t a = collapseRemap[result[i + 0]];
+      uint32_t b = collapseRemap[result[i + 1]];
+      uint32_t c = collapseRemap[result[i + 2]];
+      if (a != b && a != c && b != c) {
+        result[count++] = a;
+        result[count++] = b;
+        result[count++] = c;
+      }
+    }
+    indexCount = count;
+  }
+
+  *error = sqrtf(maxError) * extent;
+
+  free(remap);
+  free(wedge);
+  free(loop);
+  free(loopback);
+  free(collapseRemap);
+  free(collapseLocked);
+  free(kinds);
+  free(positions);
+  free(quadrics);
+  free(collapses);
+  free(adjacency.offsets);
+  free(adjacency.next);
+  free(adjacency.prev);
+  return indexCount;
+}
+
+static uint32_t readIndex(AttributeData data, AttributeType type, uint32_t i) {
+  switch (type) {
+    case U8: return data.u8[i];
+    case U16: return data.u16[i];
+    default: return data.u32[i];
+  }
+}
+
+// Builds up to `levels` simplified versions of each triangle primitive, each one aiming for `ratio`
+// times the triangles of the previous one.  The first level of every primitive is a copy of its
+// original indices, so all of a primitive's levels are ranges of the same index array.
+void lovrModelDataGenerateLods(ModelData* model, uint32_t levels, float ratio) {
+  lovrAssert(levels <= MAX_LODS, "Too many levels of detail (the max is %d)", MAX_LODS);
+  lovrAssert(ratio > 0.f && ratio < 1.f, "LOD ratio must be between 0 and 1");
+
+  free(model->lods);
+  free(model->lodIndices);
+  model->lods = malloc(model->primitiveCount * (levels + 1) * sizeof(ModelLod));
+  model->lodIndices = NULL;
+  model->lodCount = 0;
+  model->lodIndexCount = 0;
+  lovrAssert(model->lods, "Out of memory");
+
+  size_t capacity = 0;
+  uint32_t maxVertices = 0;
+  for (uint32_t i = 0; i < model->attributeCount; i++) {
+    maxVertices = MAX(maxVertices, model->attributes[i].count);
+  }
+
+  // Primitives often share one vertex buffer, so their vertices are packed down to the ones they use
+  uint32_t* local = malloc(maxVertices * sizeof(uint32_t));
+  lovrAssert(local, "Out of memory");
+  memset(local, 0xff, maxVertices * sizeof(uint32_t));
+
+  for (uint32_t i = 0; i < model->primitiveCount; i++) {
+    ModelPrimitive* primitive = &model->primitives[i];
+    ModelAttribute* position = primitive->attributes[ATTR_POSITION];
+    primitive->lodIndex = model->lodCount;
+    primitive->lodCount = 0;
+
+    if (levels == 0 || primitive->mode != DRAW_TRIANGLES || !position || position->type != F32 || position->components < 3) {
+      continue;
+    }
+
+    ModelAttribute* index = primitive->indices;
+    uint32_t indexCount = index ? index->count : position->count;
+    if (indexCount < 3) {
+      continue;
+    }
+
+    ModelBuffer* buffer = &model->buffers[position->buffer];
+    size_t stride = buffer->stride ? buffer->stride : position->components * sizeof(float);
+    AttributeData indexData = { .raw = index ? model->buffers[index->buffer].data + index->offset : NULL };
+
+    uint32_t* original = malloc(indexCount * sizeof(uint32_t));
+    uint32_t* indices = malloc(indexCount * sizeof(uint32_t));
+    uint32_t* result = malloc(indexCount * sizeof(uint32_t));
+    uint32_t* global = malloc(indexCount * sizeof(uint32_t));
+    float* vertices = malloc(3 * indexCount * sizeof(float));
+    lovrAssert(original && indices && result && global && vertices, "Out of memory");
+
+    uint32_t vertexCount = 0;
+    float min[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+    float max[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (uint32_t j = 0; j < indexCount; j++) {
+      uint32_t v = original[j] = index ? readIndex(indexData, index->type, j) : j;
+      lovrAssert(v < position->count, "Invalid vertex index %d", v);
+      if (local[v] == ~0u) {
+        float* p = (float*) (buffer->data + position->offset + v * stride);
+        memcpy(vertices + 3 * vertexCount, p, 3 * sizeof(float));
+        for (uint32_t k = 0; k < 3; k++) {
+          min[k] = MIN(min[k], p[k]);
+          max[k] = MAX(max[k], p[k]);
+        }
+        global[vertexCount] = v;
+        local[v] = vertexCount++;
+      }
+      indices[j] = local[v];
+    }
+
+    // LOD selection needs bounds, which OBJ files don't provide
+    if (!position->hasMin || !position->hasMax) {
+      memcpy(position->min, min, sizeof(min));
+      memcpy(position->max, max, sizeof(max));
+      position->hasMin = position->hasMax = true;
+    }
+
+    uint32_t count = indexCount - indexCount % 3;
+    float error = 0.f;
+    for (uint32_t level = 0; level <= levels; level++) {
+      if (level > 0) {
+        float levelError;
+        uint32_t target = (uint32_t) (count * ratio) / 3 * 3;
+        uint32_t newCount = simplify(result, indices, count, vertices, vertexCount, target, &levelError);
+
+        // Stop once the mesh stops getting meaningfully simpler
+        if (newCount == 0 || newCount > count * .95f) {
+          break;
+        }
+
+        memcpy(indices, result, newCount * sizeof(uint32_t));
+        count = newCount;
+        error += levelError;
+      }
+
+      if (model->lodIndexCount + count > capacity) {
+        capacity = MAX(capacity * 2, model->lodIndexCount + count);
+        model->lodIndices = realloc(model->lodIndices, capacity * sizeof(uint32_t));
+        lovrAssert(model->lodIndices, "Out of memory");
+      }
+
+      uint32_t* dst = model->lodIndices + model->lodIndexCount;
+      for (uint32_t j = 0; j < count; j++) {
+        dst[j] = level == 0 ? original[j] : global[indices[j]];
+      }
+
+      model->lods[model->lodCount++] = (ModelLod) {
+        .start = model->lodIndexCount,
+        .count = count,
+        .error = error
+      };
+
+      model->lodIndexCount += count;
+      primitive->lodCount++;
+    }
+
+    // A single level has nothing to choose from
+    if (primitive->lodCount == 1) {
+      model->lodCount--;
+      model->lodIndexCount -= model->lods[model->lodCount].count;
+      primitive->lodCount = 0;
+    }
+
+    for (uint32_t j = 0; j < vertexCount; j++) {
+      local[global[j]] = ~0u;
+    }
+
+    free(original);
+    free(indices);
+    free(result);
+    free(global);
+    free(vertices);
+  }
+
+  free(local);
+}
+
+// Optimization
+// Triangles are reordered for the post-transform vertex cache with Forsyth's algorithm (using the
+// score tables from meshoptimizer), then split into clusters that get sorted so outward facing
+// ones draw first, which cuts overdraw.  Finally vertices are renumbered in the order they are
+// first used so vertex fetches stay sequential.
+
+#define CACHE_SIZE 16
+#define VALENCE_MAX 8
+
+static const float cacheScores[1 + CACHE_SIZE] = {
+  0.f, .779f, .791f, .789f, .981f, .843f, .726f, .847f, .882f, .867f, .799f, .642f, .613f, .600f, .568f, .372f, .234f
+};
+
+static const float liveScores[1 + VALENCE_MAX] = {
+  0.f, .995f, .713f, .450f, .404f, .059f, .005f, .147f, .006f
+};
+
+static float vertexScore(int cachePosition, uint32_t liveTriangles) {
+  return cacheScores[1 + cachePosition] + liveScores[liveTriangles < VALENCE_MAX ? liveTriangles : VALENCE_MAX];
+}
+
+// Simulates a FIFO cache, a vertex is a hit if it was added less than CACHE_SIZE misses ago
+static uint32_t updateCache(uint32_t* triangle, uint32_t* timestamps, uint32_t* timestamp) {
+  uint32_t misses = 0;
+  for (uint32_t i = 0; i < 3; i++) {
+    if (*timestamp - timestamps[triangle[i]] > CACHE_SIZE) {
+      timestamps[triangle[i]] = (*timestamp)++;
+      misses++;
+    }
+  }
+  return misses;
+}
+
+// Average cache misses per triangle
+static float getACMR(uint32_t* indices, uint32_t indexCount, uint32_t vertexCount) {
+  uint32_t* timestamps = calloc(vertexCount, sizeof(uint32_t));
+  lovrAssert(timestamps, "Out of memory");
+  uint32_t timestamp = CACHE_SIZE + 1;
+  uint32_t misses = 0;
+  for (uint32_t i = 0; i < indexCount; i += 3) {
+    misses += updateCache(indices + i, timestamps, &timestamp);
+  }
+  free(timestamps);
+  return indexCount > 0 ? misses / (indexCount / 3.f) : 0.f;
+}
+
+static void optimizeVertexCache(uint32_t* result, uint32_t* indices, uint32_t indexCount, uint32_t vertexCount) {
+  uint32_t faceCount = indexCount / 3;
+  if (faceCount == 0) {
+    return;
+  }
+
+  uint32_t* live = calloc(vertexCount, sizeof(uint32_t));
+  uint32_t* offsets = malloc(vertexCount * sizeof(uint32_t));
+  uint32_t* faces = malloc(indexCount * sizeof(uint32_t));
+  float* vertexScores = malloc(vertexCount * sizeof(float));
+  float* faceScores = malloc(faceCount * sizeof(float));
+  bool* emitted = calloc(faceCount, sizeof(bool));
+  lovrAssert(live && offsets && faces && vertexScores && faceScores && emitted, "Out of memory");
+
+  for (uint32_t i = 0; i < indexCount; i++) {
+    live[indices[i]]++;
+  }
+
+  uint32_t offset = 0;
+  for (uint32_t i = 0; i < vertexCount; i++) {
+    offsets[i] = offset;
+    offset += live[i];
+    vertexScores[i] = vertexScore(-1, live[i]);
+  }
+
+  // live is rebuilt while filling in the faces of each vertex
+  memset(live, 0, vertexCount * sizeof(uint32_t));
+  for (uint32_t i = 0; i < indexCount; i++) {
+    faces[offsets[indices[i]] + live[indices[i]]++] = i / 3;
+  }
+
+  for (uint32_t i = 0; i < faceCount; i++) {
+    uint32_t* t = indices + 3 * i;
+    faceScores[i] = vertexScores[t[0]] + vertexScores[t[1]] + vertexScores[t[2]];
+  }
+
+  uint32_t cache[CACHE_SIZE + 3];
+  uint32_t newCache[CACHE_SIZE + 3];
+  uint32_t cacheCount = 0;
+  uint32_t current = 0;
+  uint32_t cursor = 1;
+  uint32_t count = 0;
+
+  while (current != ~0u) {
+    uint32_t* t = indices + 3 * current;
+    memcpy(result + count, t, 3 * sizeof(uint32_t));
+    count += 3;
+    emitted[current] = true;
+    faceScores[current] = 0.f;
+
+    // The emitted vertices go to the front of the cache, pushing the others back
+    uint32_t cacheWrite = 0;
+    newCache[cacheWrite++] = t[0];
+    newCache[cacheWrite++] = t[1];
+    newCache[cacheWrite++] = t[2];
+    for (uint32_t i = 0; i < cacheCount; i++) {
+      if (cache[i] != t[0] && cache[i] != t[1] && cache[i] != t[2]) {
+        newCache[cacheWrite++] = cache[i];
+      }
+    }
+    memcpy(cache, newCache, cacheWrite * sizeof(uint32_t));
+    cacheCount = MIN(cacheWrite, CACHE_SIZE);
+
+    for (uint32_t i = 0; i < 3; i++) {
+      uint32_t* list = faces + offsets[t[i]];
+      for (uint32_t j = 0; j < live[t[i]]; j++) {
+        if (list[j] == current) {
+          list[j] = list[--live[t[i]]];
+          break;
+        }
+      }
+    }
+
+    // Rescore the vertices that moved in the cache, including the ones that just fell out of it,
+    // and pick the best triangle that touches any of them
+    uint32_t best = ~0u;
+    float bestScore = 0.f;
+    for (uint32_t i = 0; i < cacheWrite; i++) {
+      uint32_t v = cache[i];
+      if (live[v] == 0) {
+        continue;
+      }
+
+      float score = vertexScore(i < CACHE_SIZE ? (int) i : -1, live[v]);
+      float delta = score - vertexScores[v];
+      vertexScores[v] = score;
+
+      for (uint32_t j = 0; j < live[v]; j++) {
+        uint32_t face = faces[offsets[v] + j];
+        faceScores[face] += delta;
+        if (faceScores[face] > bestScore) {
+          bestScore = faceScores[face];
+          best = face;
+        }
+      }
+    }
+
+    // At a dead end, continue with the next triangle in the original order
+    if (best == ~0u) {
+      while (cursor < faceCount && emitted[cursor]) {
+        cursor++;
+      }
+      best = cursor < faceCount ? cursor : ~0u;
+    }
+
+    current = best;
+  }
+
+  free(live);
+  free(offsets);
+  free(faces);
+  free(vertexScores);
+  free(faceScores);
+  free(emitted);
+}
+
+typedef struct {
+  uint32_t start;
+  uint32_t count;
+  float sort;
+} Cluster;
+
+static int compareClusters(const void* a, const void* b) {
+  float x = ((const Cluster*) a)->sort;
+  float y = ((const Cluster*) b)->sort;
+  return (x < y) - (x > y);
+}
+
+// Clusters start wherever the cache has to restart (a triangle with three misses), and are then
+// split further as long as the pieces stay within `threshold` of the cluster's cache efficiency
+static void optimizeOverdraw(uint32_t* result, uint32_t* indices, uint32_t indexCount, float* positions, uint32_t vertexCount, float threshold) {
+  uint32_t faceCount = indexCount / 3;
+  uint32_t* timestamps = calloc(vertexCount, sizeof(uint32_t));
+  uint32_t* hard = malloc((faceCount + 1) * sizeof(uint32_t));
+  uint32_t* soft = malloc((faceCount + 1) * sizeof(uint32_t));
+  lovrAssert(timestamps && hard && soft, "Out of memory");
+
+  uint32_t timestamp = CACHE_SIZE + 1;
+  uint32_t hardCount = 0;
+  for (uint32_t i = 0; i < faceCount; i++) {
+    if (updateCache(indices + 3 * i, timestamps, &timestamp) == 3 || i == 0) {
+      hard[hardCount++] = i;
+    }
+  }
+
+  uint32_t softCount = 0;
+  for (uint32_t c = 0; c < hardCount; c++) {
+    uint32_t start = hard[c];
+    uint32_t end = c + 1 < hardCount ? hard[c + 1] : faceCount;
+
+    timestamp += CACHE_SIZE + 1;
+    uint32_t misses = 0;
+    for (uint32_t i = start; i < end; i++) {
+      misses += updateCache(indices + 3 * i, timestamps, &timestamp);
+    }
+
+    float clusterThreshold = threshold * misses / (float) (end - start);
+    soft[softCount++] = start;
+    timestamp += CACHE_SIZE + 1;
+    uint32_t runningMisses = 0;
+    uint32_t runningFaces = 0;
+    for (uint32_t i = start; i < end; i++) {
+      runningMisses += updateCache(indices + 3 * i, timestamps, &timestamp);
+      runningFaces++;
+      if (runningMisses / (float) runningFaces <= clusterThreshold) {
+        soft[softCount++] = i + 1;
+        timestamp += CACHE_SIZE + 1;
+        runningMisses = 0;
+        runningFaces = 0;
+      }
+    }
+
+    // The last piece is usually a few leftover triangles, so it gets merged into the one before it
+    if (soft[softCount - 1] != start) {
+      softCount--;
+    }
+  }
+
+  float center[3] = { 0.f };
+  for (uint32_t i = 0; i < indexCount; i++) {
+    for (uint32_t j = 0; j < 3; j++) {
+      center[j] += positions[3 * indices[i] + j] / indexCount;
+    }
+  }
+
+  Cluster* clusters = malloc(softCount * sizeof(Cluster));
+  lovrAssert(clusters, "Out of memory");
+  for (uint32_t c = 0; c < softCount; c++) {
+    uint32_t start = soft[c];
+    uint32_t end = c + 1 < softCount ? soft[c + 1] : faceCount;
+    float centroid[3] = { 0.f };
+    float normal[3] = { 0.f };
+    float area = 0.f;
+
+    for (uint32_t i = start; i < end; i++) {
+      float* p0 = positions + 3 * indices[3 * i + 0];
+      float* p1 = positions + 3 * indices[3 * i + 1];
+      float* p2 = positions + 3 * indices[3 * i + 2];
+      float u[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+      float v[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+      float n[3] = { u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0] };
+      float a = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+      for (uint32_t j = 0; j < 3; j++) {
+        centroid[j] += (p0[j] + p1[j] + p2[j]) * (a / 3.f);
+        normal[j] += n[j];
+      }
+      area += a;
+    }
+
+    for (uint32_t j = 0; j < 3; j++) {
+      centroid[j] = area > 0.f ? centroid[j] / area : 0.f;
+    }
+    normalize3(normal);
+
+    clusters[c] = (Cluster) {
+      .start = start,
+      .count = end - start,
+      .sort =
+        (centroid[0] - center[0]) * normal[0] +
+        (centroid[1] - center[1]) * normal[1] +
+        (centroid[2] - center[2]) * normal[2]
+    };
+  }
+
+  qsort(clusters, softCount, sizeof(Cluster), compareClusters);
+
+  uint32_t count = 0;
+  for (uint32_t c = 0; c < softCount; c++) {
+    memcpy(result + count, indices + 3 * clusters[c].start, 3 * clusters[c].count * sizeof(uint32_t));
+    count += 3 * clusters[c].count;
+  }
+
+  free(timestamps);
+  free(hard);
+  free(soft);
+  free(clusters);
+}
+
+static void writeIndex(AttributeData data, AttributeType type, uint32_t i, uint32_t value) {
+  switch (type) {
+    case U8: data.u8[i] = (uint8_t) value; break;
+    case U16: data.u16[i] = (uint16_t) value; break;
+    default: data.u32[i] = value; break;
+  }
+}
+
+static size_t getAttributeSize(ModelAttribute* attribute) {
+  switch (attribute->type) {
+    case I8: case U8: return attribute->components;
+    case I16: case U16: case F16: return 2 * attribute->components;
+    case I10_10_10_2: return 4;
+    default: return 4 * attribute->components;
+  }
+}
+
+// Buffers can point into the Blob the model was loaded from, which other objects may share, so
+// they're copied before being rewritten
+static char* getWritableBuffer(ModelData* model, uint32_t index) {
+  ModelBuffer* buffer = &model->buffers[index];
+  if (!buffer->owned) {
+    char* data = malloc(buffer->size);
+    lovrAssert(data, "Out of memory");
+    memcpy(data, buffer->data, buffer->size);
+    buffer->data = data;
+    buffer->owned = true;
+  }
+  return buffer->data;
+}
+
+static bool isOptimizable(ModelPrimitive* primitive) {
+  return primitive->mode == DRAW_TRIANGLES && primitive->indices && primitive->attributes[ATTR_POSITION];
+}
+
+// Reorders the indexed triangle primitives (and their levels of detail) for the vertex cache and
+// overdraw, then renumbers their vertices by first use.  Vertices are only renumbered for sets of
+// primitives that are the only users of their vertex attributes.  acmr receives the cache misses
+// per triangle before and after.
+void lovrModelDataOptimize(ModelData* model, float acmr[2]) {
+  uint32_t triangles = 0;
+  float missesBefore = 0.f;
+  float missesAfter = 0.f;
+
+  for (uint32_t i = 0; i < model->primitiveCount; i++) {
+    ModelPrimitive* primitive = &model->primitives[i];
+    if (!isOptimizable(primitive)) {
+      continue;
+    }
+
+    ModelAttribute* index = primitive->indices;
+    ModelAttribute* position = primitive->attributes[ATTR_POSITION];
+    uint32_t vertexCount = position->count;
+    uint32_t indexCount = index->count - index->count % 3;
+    AttributeData data = { .raw = getWritableBuffer(model, index->buffer) + index->offset };
+
+    uint32_t* indices = malloc(indexCount * sizeof(uint32_t));
+    uint32_t* result = malloc(indexCount * sizeof(uint32_t));
+    lovrAssert(indices && result, "Out of memory");
+    for (uint32_t j = 0; j < indexCount; j++) {
+      indices[j] = readIndex(data, index->type, j);
+      lovrAssert(indices[j] < vertexCount, "Invalid vertex index %d", indices[j]);
+    }
+
+    float* positions = NULL;
+    if (position->type == F32 && position->components >= 3) {
+      ModelBuffer* buffer = &model->buffers[position->buffer];
+      size_t stride = buffer->stride ? buffer->stride : getAttributeSize(position);
+      positions = malloc(3 * vertexCount * sizeof(float));
+      lovrAssert(positions, "Out of memory");
+      for (uint32_t j = 0; j < vertexCount; j++) {
+        memcpy(positions + 3 * j, buffer->data + position->offset + j * stride, 3 * sizeof(float));
+      }
+    }
+
+    missesBefore += getACMR(indices, indexCount, vertexCount) * indexCount / 3;
+    optimizeVertexCache(result, indices, indexCount, vertexCount);
+    if (positions) {
+      optimizeOverdraw(indices, result, indexCount, positions, vertexCount, 1.05f);
+    } else {
+      memcpy(indices, result, indexCount * sizeof(uint32_t));
+    }
+    missesAfter += getACMR(indices, indexCount, vertexCount) * indexCount / 3;
+    triangles += indexCount / 3;
+
+    for (uint32_t j = 0; j < indexCount; j++) {
+      writeIndex(data, index->type, j, indices[j]);
+    }
+
+    // The full detail level is a copy of the original indices, the rest only need the cache order
+    for (uint32_t j = 0; j < primitive->lodCount; j++) {
+      ModelLod* lod = &model->lods[primitive->lodIndex + j];
+      uint32_t* lodIndices = model->lodIndices + lod->start;
+      if (j == 0 && lod->count == indexCount) {
+        memcpy(lodIndices, indices, indexCount * sizeof(uint32_t));
+      } else {
+        optimizeVertexCache(result, lodIndices, lod->count, vertexCount);
+        memcpy(lodIndices, result, lod->count * sizeof(uint32_t));
+      }
+    }
+
+    free(indices);
+    free(result);
+    free(positions);
+  }
+
+  acmr[0] = triangles > 0 ? missesBefore / triangles : 0.f;
+  acmr[1] = triangles > 0 ? missesAfter / triangles : 0.f;
+
+  // Vertex fetch: primitives sharing the exact same attributes are renumbered together
+  bool* done = calloc(model->primitiveCount, sizeof(bool));
+  lovrAssert(done, "Out of memory");
+  for (uint32_t i = 0; i < model->primitiveCount; i++) {
+    ModelPrimitive* primitive = &model->primitives[i];
+    if (done[i] || !isOptimizable(primitive)) {
+      continue;
+    }
+
+    bool valid = true;
+    uint32_t vertexCount = primitive->attributes[ATTR_POSITION]->count;
+    for (uint32_t j = 0; j < MAX_DEFAULT_ATTRIBUTES; j++) {
+      valid &= !primitive->attributes[j] || primitive->attributes[j]->count == vertexCount;
+    }
+
+    for (uint32_t j = i; j < model->primitiveCount; j++) {
+      ModelPrimitive* other = &model->primitives[j];
+      bool same = !memcmp(other->attributes, primitive->attributes, sizeof(primitive->attributes));
+      if (same) {
+        done[j] = true;
+        valid &= isOptimizable(other);
+      } else {
+        for (uint32_t k = 0; k < MAX_DEFAULT_ATTRIBUTES; k++) {
+          for (uint32_t l = 0; l < MAX_DEFAULT_ATTRIBUTES; l++) {
+            valid &= !other->attributes[k] || other->attributes[k] != primitive->attributes[l];
+          }
+        }
+      }
+    }
+
+    // Earlier primitives were checked against this one when they were visited
+    for (uint32_t j = 0; j < i && valid; j++) {
+      for (uint32_t k = 0; k < MAX_DEFAULT_ATTRIBUTES; k++) {
+        for (uint32_t l = 0; l < MAX_DEFAULT_ATTRIBUTES; l++) {
+          valid &= !model->primitives[j].attributes[k] || model->primitives[j].attributes[k] != primitive->attributes[l];
+        }
+      }
+    }
+
+    // An index buffer shared with a primitive outside the group would get renumbered for it too
+    for (uint32_t j = 0; j < model->primitiveCount && valid; j++) {
+      ModelPrimitive* other = &model->primitives[j];
+      if (!other->indices || !memcmp(other->attributes, primitive->attributes, sizeof(primitive->attributes))) {
+        continue;
+      }
+
+      for (uint32_t k = i; k < model->primitiveCount; k++) {
+        ModelPrimitive* member = &model->primitives[k];
+        valid &= member->indices != other->indices || memcmp(member->attributes, primitive->attributes, sizeof(primitive->attributes));
+      }
+    }
+
+    if (!valid) {
+      continue;
+    }
+
+    uint32_t* remap = malloc(vertexCount * sizeof(uint32_t));
+    lovrAssert(remap, "Out of memory");
+    memset(remap, 0xff, vertexCount * sizeof(uint32_t));
+    uint32_t next = 0;
+
+    for (uint32_t j = i; j < model->primitiveCount; j++) {
+      ModelPrimitive* other = &model->primitives[j];
+      if (memcmp(other->attributes, primitive->attributes, sizeof(primitive->attributes))) {
+        continue;
+      }
+
+      AttributeData data = { .raw = model->buffers[other->indices->buffer].data + other->indices->offset };
+      for (uint32_t k = 0; k < other->indices->count; k++) {
+        uint32_t v = readIndex(data, other->indices->type, k);
+        if (remap[v] == ~0u) {
+          remap[v] = next++;
+        }
+      }
+    }
+
+    // Unused vertices keep their relative order at the end
+    for (uint32_t v = 0; v < vertexCount; v++) {
+      if (remap[v] == ~0u) {
+        remap[v] = next++;
+      }
+    }
+
+    // Index buffers can be shared too, so each one is only rewritten once
+    for (uint32_t j = i; j < model->primitiveCount; j++) {
+      ModelPrimitive* other = &model->primitives[j];
+      if (memcmp(other->attributes, primitive->attributes, sizeof(primitive->attributes))) {
+        continue;
+      }
+
+      bool seen = false;
+      for (uint32_t k = i; k < j && !seen; k++) {
+        seen = model->primitives[k].indices == other->indices && !memcmp(model->primitives[k].attributes, primitive->attributes, sizeof(primitive->attributes));
+      }
+
+      if (!seen) {
+        AttributeData data = { .raw = getWritableBuffer(model, other->indices->buffer) + other->indices->offset };
+        for (uint32_t k = 0; k < other->indices->count; k++) {
+          writeIndex(data, other->indices->type, k, remap[readIndex(data, other->indices->type, k)]);
+        }
+      }
+
+      for (uint32_t k = 0; k < other->lodCount; k++) {
+        ModelLod* lod = &model->lods[other->lodIndex + k];
+        for (uint32_t l = lod->start; l < lod->start + lod->count; l++) {
+          model->lodIndices[l] = remap[model->lodIndices[l]];
+        }
+      }
+    }
+
+    for (uint32_t j = 0; j < MAX_DEFAULT_ATTRIBUTES; j++) {
+      ModelAttribute* attribute = primitive->attributes[j];
+      if (!attribute) {
+        continue;
+      }
+
+      // Attributes can share an accessor, which must only be moved once
+      bool seen = false;
+      for (uint32_t k = 0; k < j && !seen; k++) {
+        seen = primitive->attributes[k] == attribute;
+      }
+
+      if (seen) {
+        continue;
+      }
+
+      size_t size = getAttributeSize(attribute);
+      size_t stride = model->buffers[attribute->buffer].stride ? model->buffers[attribute->buffer].stride : size;
+      char* base = getWritableBuffer(model, attribute->buffer) + attribute->offset;
+      char* copy = malloc(vertexCount * size);
+      lovrAssert(copy, "Out of memory");
+      for (uint32_t v = 0; v < vertexCount; v++) {
+        memcpy(copy + remap[v] * size, base + v * stride, size);
+      }
+      for (uint32_t v = 0; v < vertexCount; v++) {
+        memcpy(base + v * stride, copy + v * size, size);
+      }
+      free(copy);
+    }
+
+    free(remap);
+  }
+
+  free(done);
+}
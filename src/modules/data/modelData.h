@@ -6,7 +6,8 @@
 
 #pragma once
 
-#define MAX_BONES 48
+#define MAX_BONES 256
+#define MAX_LODS 8
 
 struct TextureData;
 struct Blob;
@@ -90,7 +91,7 @@ typedef enum {
   PROP_SCALE,
 } AnimationProperty;
 
-typedef enum { I8, U8, I16, U16, I32, U32, F32 } AttributeType;
+typedef enum { I8, U8, I16, U16, I32, U32, F32, F16, I10_10_10_2 } AttributeType;
 
 typedef union {
   void* raw;
@@ -107,6 +108,7 @@ typedef struct {
   char* data;
   size_t size;
   size_t stride;
+  bool owned;
 } ModelBuffer;
 
 typedef struct {
@@ -146,11 +148,21 @@ typedef struct {
   TextureWrap wraps[MAX_MATERIAL_TEXTURES];
 } ModelMaterial;
 
+// A range of ModelData's lodIndices, with the distance the simplified surface can be from the
+// original one (in the units of the primitive's positions)
+typedef struct {
+  uint32_t start;
+  uint32_t count;
+  float error;
+} ModelLod;
+
 typedef struct {
   ModelAttribute* attributes[MAX_DEFAULT_ATTRIBUTES];
   ModelAttribute* indices;
   DrawMode mode;
   uint32_t material;
+  uint32_t lodIndex;
+  uint32_t lodCount;
 } ModelPrimitive;
 
 typedef struct {
@@ -197,6 +209,11 @@ typedef struct ModelData {
   uint32_t skinCount;
   uint32_t nodeCount;
 
+  ModelLod* lods;
+  uint32_t* lodIndices;
+  uint32_t lodCount;
+  uint32_t lodIndexCount;
+
   ModelAnimationChannel* channels;
   uint32_t* children;
   uint32_t* joints;
@@ -215,3 +232,5 @@ ModelData* lovrModelDataInitGltf(ModelData* model, struct Blob* blob);
 ModelData* lovrModelDataInitObj(ModelData* model, struct Blob* blob);
 void lovrModelDataDestroy(void* ref);
 void lovrModelDataAllocate(ModelData* model);
+void lovrModelDataGenerateLods(ModelData* model, uint32_t levels, float ratio);
+void lovrModelDataOptimize(ModelData* model, float acmr[2]);
@@ -3,6 +3,7 @@
 #include "data/textureData.h"
 #include "resources/VarelaRound.ttf.h"
 #include "core/ref.h"
+#include "core/util.h"
 #include "core/utf.h"
 #include "lib/stb/stb_truetype.h"
 #include <msdfgen-c.h>
@@ -137,3 +138,22 @@ void lovrRasterizerLoadGlyph(Rasterizer* rasterizer, uint32_t character, Glyph*
 int32_t lovrRasterizerGetKerning(Rasterizer* rasterizer, uint32_t left, uint32_t right) {
   return stbtt_GetCodepointKernAdvance(&rasterizer->font, left, right) * rasterizer->scale;
 }
+
+int32_t lovrRasterizerGetAdvance(Rasterizer* rasterizer, uint32_t character) {
+  int advance, bearing;
+  stbtt_GetCodepointHMetrics(&rasterizer->font, character, &advance, &bearing);
+  return roundf(advance * rasterizer->scale);
+}
+
+// Identifies the glyphs this Rasterizer creates, which depend on the font file, size, and padding
+uint64_t lovrRasterizerGetHash(Rasterizer* rasterizer) {
+  uint64_t hash = HASH_SEED;
+  if (rasterizer->blob) {
+    hash = hash64(hash, rasterizer->blob->data, rasterizer->blob->size);
+  } else {
+    hash = hash64(hash, VarelaRound_ttf, VarelaRound_ttf_len);
+  }
+  hash = hash64(hash, &rasterizer->size, sizeof(rasterizer->size));
+  uint32_t padding = GLYPH_PADDING;
+  return hash64(hash, &padding, sizeof(padding));
+}
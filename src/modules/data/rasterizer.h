@@ -41,3 +41,5 @@ bool lovrRasterizerHasGlyph(Rasterizer* fontData, uint32_t character);
 bool lovrRasterizerHasGlyphs(Rasterizer* fontData, const char* str);
 void lovrRasterizerLoadGlyph(Rasterizer* fontData, uint32_t character, Glyph* glyph);
 int32_t lovrRasterizerGetKerning(Rasterizer* fontData, uint32_t left, uint32_t right);
+int32_t lovrRasterizerGetAdvance(Rasterizer* fontData, uint32_t character);
+uint64_t lovrRasterizerGetHash(Rasterizer* fontData);
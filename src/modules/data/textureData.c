@@ -1,13 +1,19 @@
 #include "data/textureData.h"
 #include "filesystem/file.h"
+#include "core/arr.h"
 #include "core/ref.h"
 #include "lib/stb/stb_image.h"
 #include "lib/stb/stb_image_write.h"
+#ifdef LOVR_ENABLE_THREAD
+#include "lib/tinycthread/tinycthread.h"
+#endif
 #include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
+#include <math.h>
 
 #define FOUR_CC(a, b, c, d) ((uint32_t) (((d)<<24) | ((c)<<16) | ((b)<<8) | (a)))
+#define MAX_COMPRESS_WORKERS 4
 
 static size_t getPixelSize(TextureFormat format) {
   switch (format) {
@@ -249,7 +255,7 @@ static bool parseDDS(uint8_t* data, size_t size, TextureData* textureData) {
       return false;
     }
 
-    // Ensure DXT 1/3/5
+    // Ensure DXT 1/3/5 or BC5
     switch (header10->dxgiFormat) {
       case DXGI_FORMAT_BC1_TYPELESS:
       case DXGI_FORMAT_BC1_UNORM:
@@ -266,6 +272,10 @@ static bool parseDDS(uint8_t* data, size_t size, TextureData* textureData) {
       case DXGI_FORMAT_BC3_UNORM_SRGB:
         textureData->format = FORMAT_DXT5;
         break;
+      case DXGI_FORMAT_BC5_TYPELESS:
+      case DXGI_FORMAT_BC5_UNORM:
+        textureData->format = FORMAT_BC5;
+        break;
       default:
         return 1;
     }
@@ -274,11 +284,13 @@ static bool parseDDS(uint8_t* data, size_t size, TextureData* textureData) {
       return false;
     }
 
-    // Ensure DXT 1/3/5
+    // Ensure DXT 1/3/5 or BC5
     switch (header->format.fourCC) {
       case FOUR_CC('D', 'X', 'T', '1'): textureData->format = FORMAT_DXT1; break;
       case FOUR_CC('D', 'X', 'T', '3'): textureData->format = FORMAT_DXT3; break;
       case FOUR_CC('D', 'X', 'T', '5'): textureData->format = FORMAT_DXT5; break;
+      case FOUR_CC('A', 'T', 'I', '2'): textureData->format = FORMAT_BC5; break;
+      case FOUR_CC('B', 'C', '5', 'U'): textureData->format = FORMAT_BC5; break;
       default: return false;
     }
   }
@@ -293,6 +305,7 @@ static bool parseDDS(uint8_t* data, size_t size, TextureData* textureData) {
     case FORMAT_DXT1: blockBytes = 8; break;
     case FORMAT_DXT3: blockBytes = 16; break;
     case FORMAT_DXT5: blockBytes = 16; break;
+    case FORMAT_BC5: blockBytes = 16; break;
     default: break;
   }
 
@@ -358,6 +371,7 @@ static bool parseKTX(uint8_t* bytes, size_t size, TextureData* textureData) {
     case 0x83F0: textureData->format = FORMAT_DXT1; break;
     case 0x83F2: textureData->format = FORMAT_DXT3; break;
     case 0x83F3: textureData->format = FORMAT_DXT5; break;
+    case 0x8DBD: textureData->format = FORMAT_BC5; break;
     default: return false;
   }
 
@@ -430,6 +444,79 @@ static bool parseASTC(uint8_t* bytes, size_t size, TextureData* textureData) {
   return true;
 }
 
+static float srgbToLinear(float x) {
+  return x <= .04045f ? x / 12.92f : powf((x + .055f) / 1.055f, 2.4f);
+}
+
+static float linearToSrgb(float x) {
+  return x <= .0031308f ? x * 12.92f : 1.055f * powf(x, 1.f / 2.4f) - .055f;
+}
+
+// 2x2 box filter, clamping at the edges of odd-sized levels.  8 bit color channels are averaged in
+// linear space when srgb is set, alpha is always linear.
+static void downsample(const Mipmap* src, Mipmap* dst, TextureFormat format, bool srgb) {
+  uint32_t channels;
+  switch (format) {
+    case FORMAT_RGB: channels = 3; break;
+    case FORMAT_RGBA: channels = 4; break;
+    case FORMAT_RGBA32F: channels = 4; break;
+    case FORMAT_RG32F: channels = 2; break;
+    case FORMAT_R32F: channels = 1; break;
+    default: lovrThrow("Unreachable"); return;
+  }
+
+  if (format == FORMAT_RGB || format == FORMAT_RGBA) {
+    float decode[256];
+    for (uint32_t i = 0; i < 256; i++) {
+      decode[i] = srgb ? srgbToLinear(i / 255.f) : i / 255.f;
+    }
+
+    const uint8_t* s = src->data;
+    uint8_t* d = dst->data;
+    for (uint32_t y = 0; y < dst->height; y++) {
+      const uint8_t* row0 = s + MIN(2 * y, src->height - 1) * src->width * channels;
+      const uint8_t* row1 = s + MIN(2 * y + 1, src->height - 1) * src->width * channels;
+      for (uint32_t x = 0; x < dst->width; x++) {
+        uint32_t x0 = MIN(2 * x, src->width - 1) * channels;
+        uint32_t x1 = MIN(2 * x + 1, src->width - 1) * channels;
+        for (uint32_t c = 0; c < channels; c++) {
+          float value;
+          if (c < 3) {
+            value = .25f * (decode[row0[x0 + c]] + decode[row0[x1 + c]] + decode[row1[x0 + c]] + decode[row1[x1 + c]]);
+            value = srgb ? linearToSrgb(value) : value;
+          } else {
+            value = (row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c]) / (4.f * 255.f);
+          }
+          *d++ = (uint8_t) (CLAMP(value, 0.f, 1.f) * 255.f + .5f);
+        }
+      }
+    }
+  } else {
+    const float* s = src->data;
+    float* d = dst->data;
+    for (uint32_t y = 0; y < dst->height; y++) {
+      const float* row0 = s + MIN(2 * y, src->height - 1) * src->width * channels;
+      const float* row1 = s + MIN(2 * y + 1, src->height - 1) * src->width * channels;
+      for (uint32_t x = 0; x < dst->width; x++) {
+        uint32_t x0 = MIN(2 * x, src->width - 1) * channels;
+        uint32_t x1 = MIN(2 * x + 1, src->width - 1) * channels;
+        for (uint32_t c = 0; c < channels; c++) {
+          *d++ = .25f * (row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c]);
+        }
+      }
+    }
+  }
+}
+
+// Generated mipmaps are derived from the base level, so they get dropped when it changes
+static void discardMipmaps(TextureData* textureData) {
+  if (textureData->format < FORMAT_DXT1) {
+    free(textureData->mipmaps);
+    textureData->mipmaps = NULL;
+    textureData->mipmapCount = 0;
+  }
+}
+
 TextureData* lovrTextureDataInit(TextureData* textureData, uint32_t width, uint32_t height, uint8_t value, TextureFormat format) {
   lovrAssert(width > 0 && height > 0, "TextureData dimensions must be positive");
   lovrAssert(format < FORMAT_DXT1, "Blank TextureData cannot be compressed");
@@ -507,6 +594,7 @@ void lovrTextureDataSetPixel(TextureData* textureData, uint32_t x, uint32_t y, C
   size_t pixelSize = getPixelSize(textureData->format);
   uint8_t* u8 = (uint8_t*) textureData->blob.data + pixelSize * index;
   float* f32 = (float*) u8;
+  discardMipmaps(textureData);
   switch (textureData->format) {
     case FORMAT_RGB:
       u8[0] = (uint8_t) (color.r * 255.f + .5f);
@@ -546,12 +634,55 @@ static void writeCallback(void* context, void* data, int size) {
   lovrFileWrite(file, data, size);
 }
 
+// Writes a DDS with a legacy header, which is enough to load DXT/BC5 TextureData back in later
+static bool writeDDS(TextureData* textureData, File* file) {
+  uint32_t fourCC;
+  switch (textureData->format) {
+    case FORMAT_DXT1: fourCC = FOUR_CC('D', 'X', 'T', '1'); break;
+    case FORMAT_DXT3: fourCC = FOUR_CC('D', 'X', 'T', '3'); break;
+    case FORMAT_DXT5: fourCC = FOUR_CC('D', 'X', 'T', '5'); break;
+    case FORMAT_BC5: fourCC = FOUR_CC('A', 'T', 'I', '2'); break;
+    default: return false;
+  }
+
+  uint32_t header[32] = { 0 };
+  header[0] = FOUR_CC('D', 'D', 'S', ' ');
+  header[1] = 124; // Header size
+  header[2] = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000; // Caps, height, width, format, mipmaps, linear size
+  header[3] = textureData->height;
+  header[4] = textureData->width;
+  header[5] = (uint32_t) textureData->mipmaps[0].size;
+  header[7] = textureData->mipmapCount;
+  header[19] = 32; // Pixel format size
+  header[20] = 0x4; // DDPF_FOURCC
+  header[21] = fourCC;
+  header[27] = 0x1000 | (textureData->mipmapCount > 1 ? 0x400008 : 0); // Texture, mipmap, complex
+
+  if (lovrFileWrite(file, header, sizeof(header)) != sizeof(header)) {
+    return false;
+  }
+
+  for (uint32_t i = 0; i < textureData->mipmapCount; i++) {
+    Mipmap* mipmap = &textureData->mipmaps[i];
+    if (lovrFileWrite(file, mipmap->data, mipmap->size) != mipmap->size) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
 bool lovrTextureDataEncode(TextureData* textureData, const char* filename) {
   File file;
   lovrFileInit(memset(&file, 0, sizeof(File)), filename);
   if (!lovrFileOpen(&file, OPEN_WRITE)) {
     return false;
   }
+  if (textureData->format >= FORMAT_DXT1 && textureData->format <= FORMAT_BC5) {
+    bool success = writeDDS(textureData, &file);
+    lovrFileDestroy(&file);
+    return success;
+  }
   lovrAssert(textureData->format == FORMAT_RGB || textureData->format == FORMAT_RGBA, "Only RGB and RGBA TextureData can be encoded");
   int components = textureData->format == FORMAT_RGB ? 3 : 4;
   int width = textureData->width;
@@ -576,6 +707,586 @@ void lovrTextureDataPaste(TextureData* textureData, TextureData* source, uint32_
     src -= source->width * pixelSize;
     dst -= textureData->width * pixelSize;
   }
+  discardMipmaps(textureData);
+}
+
+void lovrTextureDataGenerateMipmaps(TextureData* textureData, bool srgb) {
+  TextureFormat format = textureData->format;
+  bool supported = format == FORMAT_RGB || format == FORMAT_RGBA || format == FORMAT_RGBA32F || format == FORMAT_RG32F || format == FORMAT_R32F;
+  lovrAssert(supported, "Unsupported format for TextureData:generateMipmaps");
+  lovrAssert(textureData->blob.data, "TextureData does not have any pixel data");
+
+  size_t pixelSize = getPixelSize(format);
+  uint32_t count = 1;
+  size_t size = 0;
+  for (uint32_t w = textureData->width, h = textureData->height; w > 1 || h > 1; count++) {
+    w = MAX(w >> 1, 1);
+    h = MAX(h >> 1, 1);
+    size += w * h * pixelSize;
+  }
+
+  // The Mipmap array and the pixels of every level after the first share a single allocation
+  Mipmap* mipmaps = malloc(count * sizeof(Mipmap) + size);
+  lovrAssert(mipmaps, "Out of memory");
+  uint8_t* data = (uint8_t*) (mipmaps + count);
+
+  mipmaps[0] = (Mipmap) {
+    .width = textureData->width,
+    .height = textureData->height,
+    .size = textureData->blob.size,
+    .data = textureData->blob.data
+  };
+
+  for (uint32_t i = 1; i < count; i++) {
+    uint32_t width = MAX(mipmaps[i - 1].width >> 1, 1);
+    uint32_t height = MAX(mipmaps[i - 1].height >> 1, 1);
+    mipmaps[i] = (Mipmap) {
+      .width = width,
+      .height = height,
+      .size = width * height * pixelSize,
+      .data = data
+    };
+    downsample(&mipmaps[i - 1], &mipmaps[i], format, srgb);
+    data += mipmaps[i].size;
+  }
+
+  free(textureData->mipmaps);
+  textureData->mipmaps = mipmaps;
+  textureData->mipmapCount = count;
+}
+
+// Block compression
+
+typedef struct {
+  const Mipmap* levels;
+  Mipmap* blocks;
+  uint32_t channels;
+  TextureFormat format;
+  uint32_t rowCount;
+  Ref cursor;
+} CompressJob;
+
+static void unpackColor(uint16_t color, float rgb[3]) {
+  uint32_t r = (color >> 11) & 0x1f;
+  uint32_t g = (color >> 5) & 0x3f;
+  uint32_t b = color & 0x1f;
+  rgb[0] = (float) ((r << 3) | (r >> 2));
+  rgb[1] = (float) ((g << 2) | (g >> 4));
+  rgb[2] = (float) ((b << 3) | (b >> 2));
+}
+
+static uint16_t packColor(const float rgb[3]) {
+  uint32_t r = (uint32_t) (CLAMP(rgb[0], 0.f, 255.f) * 31.f / 255.f + .5f);
+  uint32_t g = (uint32_t) (CLAMP(rgb[1], 0.f, 255.f) * 63.f / 255.f + .5f);
+  uint32_t b = (uint32_t) (CLAMP(rgb[2], 0.f, 255.f) * 31.f / 255.f + .5f);
+  return (uint16_t) ((r << 11) | (g << 5) | b);
+}
+
+// Picks the closest of the 4 palette colors for each pixel, returning the total squared error
+static float fitColorIndices(const uint8_t pixels[16][4], uint16_t c0, uint16_t c1, uint32_t* indices) {
+  float palette[4][3];
+  unpackColor(c0, palette[0]);
+  unpackColor(c1, palette[1]);
+  for (uint32_t c = 0; c < 3; c++) {
+    palette[2][c] = (2.f * palette[0][c] + palette[1][c]) / 3.f;
+    palette[3][c] = (palette[0][c] + 2.f * palette[1][c]) / 3.f;
+  }
+
+  float error = 0.f;
+  *indices = 0;
+  for (uint32_t i = 0; i < 16; i++) {
+    uint32_t best = 0;
+    float bestDistance = INFINITY;
+    for (uint32_t j = 0; j < 4; j++) {
+      float dr = pixels[i][0] - palette[j][0];
+      float dg = pixels[i][1] - palette[j][1];
+      float db = pixels[i][2] - palette[j][2];
+      float distance = dr * dr + dg * dg + db * db;
+      if (distance < bestDistance) {
+        bestDistance = distance;
+        best = j;
+      }
+    }
+    *indices |= best << (2 * i);
+    error += bestDistance;
+  }
+
+  return error;
+}
+
+// Endpoints start at the extremes of the block along its principal axis, then get one least
+// squares refinement using the chosen indices.  Only the 4 color mode is used (c0 > c1).
+static void encodeColorBlock(const uint8_t pixels[16][4], uint8_t* out) {
+  float mean[3] = { 0.f };
+  for (uint32_t i = 0; i < 16; i++) {
+    for (uint32_t c = 0; c < 3; c++) {
+      mean[c] += pixels[i][c] / 16.f;
+    }
+  }
+
+  float covariance[6] = { 0.f };
+  for (uint32_t i = 0; i < 16; i++) {
+    float r = pixels[i][0] - mean[0];
+    float g = pixels[i][1] - mean[1];
+    float b = pixels[i][2] - mean[2];
+    covariance[0] += r * r;
+    covariance[1] += r * g;
+    covariance[2] += r * b;
+    covariance[3] += g * g;
+    covariance[4] += g * b;
+    covariance[5] += b * b;
+  }
+
+  float axis[3] = { 1.f, 1.f, 1.f };
+  for (uint32_t iteration = 0; iteration < 4; iteration++) {
+    float x = covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2];
+    float y = covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2];
+    float z = covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2];
+    float length = MAX(fabsf(x), MAX(fabsf(y), fabsf(z)));
+    if (length < 1e-6f) {
+      break;
+    }
+    axis[0] = x / length;
+    axis[1] = y / length;
+    axis[2] = z / length;
+  }
+
+  uint32_t minIndex = 0, maxIndex = 0;
+  float minDot = INFINITY, maxDot = -INFINITY;
+  for (uint32_t i = 0; i < 16; i++) {
+    float dot = pixels[i][0] * axis[0] + pixels[i][1] * axis[1] + pixels[i][2] * axis[2];
+    if (dot < minDot) { minDot = dot; minIndex = i; }
+    if (dot > maxDot) { maxDot = dot; maxIndex = i; }
+  }
+
+  // Inset the endpoints a little, which reduces the error of the interpolated colors
+  float e0[3], e1[3];
+  for (uint32_t c = 0; c < 3; c++) {
+    float inset = (pixels[maxIndex][c] - pixels[minIndex][c]) / 16.f;
+    e0[c] = pixels[maxIndex][c] - inset;
+    e1[c] = pixels[minIndex][c] + inset;
+  }
+
+  uint16_t c0 = packColor(e0);
+  uint16_t c1 = packColor(e1);
+  if (c0 < c1) { uint16_t t = c0; c0 = c1; c1 = t; }
+
+  uint32_t indices = 0;
+  if (c0 != c1) {
+    float error = fitColorIndices(pixels, c0, c1, &indices);
+
+    float weights[4] = { 1.f, 0.f, 2.f / 3.f, 1.f / 3.f };
+    float aa = 0.f, bb = 0.f, ab = 0.f;
+    float ax[3] = { 0.f }, bx[3] = { 0.f };
+    for (uint32_t i = 0; i < 16; i++) {
+      float a = weights[(indices >> (2 * i)) & 0x3];
+      float b = 1.f - a;
+      aa += a * a;
+      bb += b * b;
+      ab += a * b;
+      for (uint32_t c = 0; c < 3; c++) {
+        ax[c] += a * pixels[i][c];
+        bx[c] += b * pixels[i][c];
+      }
+    }
+
+    float determinant = aa * bb - ab * ab;
+    if (fabsf(determinant) > 1e-6f) {
+      for (uint32_t c = 0; c < 3; c++) {
+        e0[c] = (bb * ax[c] - ab * bx[c]) / determinant;
+        e1[c] = (aa * bx[c] - ab * ax[c]) / determinant;
+      }
+
+      uint16_t r0 = packColor(e0);
+      uint16_t r1 = packColor(e1);
+      if (r0 < r1) { uint16_t t = r0; r0 = r1; r1 = t; }
+
+      uint32_t refined;
+      if (r0 != r1 && fitColorIndices(pixels, r0, r1, &refined) < error) {
+        c0 = r0;
+        c1 = r1;
+        indices = refined;
+      }
+    }
+  }
+
+  out[0] = c0 & 0xff;
+  out[1] = c0 >> 8;
+  out[2] = c1 & 0xff;
+  out[3] = c1 >> 8;
+  out[4] = indices & 0xff;
+  out[5] = (indices >> 8) & 0xff;
+  out[6] = (indices >> 16) & 0xff;
+  out[7] = indices >> 24;
+}
+
+// BC4 style block (DXT5 alpha and both BC5 channels), using the 8 value mode
+static void encodeChannelBlock(const uint8_t pixels[16][4], uint32_t channel, uint8_t* out) {
+  uint8_t lo = 255, hi = 0;
+  for (uint32_t i = 0; i < 16; i++) {
+    lo = MIN(lo, pixels[i][channel]);
+    hi = MAX(hi, pixels[i][channel]);
+  }
+
+  uint64_t indices = 0;
+  if (hi > lo) {
+    for (uint32_t i = 0; i < 16; i++) {
+      uint32_t step = (uint32_t) ((pixels[i][channel] - lo) * 7.f / (hi - lo) + .5f);
+      uint64_t index = step == 7 ? 0 : (step == 0 ? 1 : 8 - step);
+      indices |= index << (3 * i);
+    }
+  }
+
+  out[0] = hi;
+  out[1] = lo;
+  for (uint32_t i = 0; i < 6; i++) {
+    out[2 + i] = (indices >> (8 * i)) & 0xff;
+  }
+}
+
+static void compressRow(CompressJob* job, uint32_t level, uint32_t row) {
+  const Mipmap* src = &job->levels[level];
+  const uint8_t* data = src->data;
+  uint32_t channels = job->channels;
+  uint32_t blocksWide = (src->width + 3) / 4;
+  size_t blockBytes = job->format == FORMAT_DXT1 ? 8 : 16;
+  uint8_t* out = (uint8_t*) job->blocks[level].data + row * blocksWide * blockBytes;
+
+  // Pixels past the edge of the level repeat the last row/column
+  for (uint32_t bx = 0; bx < blocksWide; bx++, out += blockBytes) {
+    uint8_t pixels[16][4];
+    for (uint32_t y = 0; y < 4; y++) {
+      uint32_t py = MIN(row * 4 + y, src->height - 1);
+      for (uint32_t x = 0; x < 4; x++) {
+        uint32_t px = MIN(bx * 4 + x, src->width - 1);
+        const uint8_t* pixel = data + ((size_t) py * src->width + px) * channels;
+        uint8_t* p = pixels[y * 4 + x];
+        p[0] = pixel[0];
+        p[1] = pixel[1];
+        p[2] = pixel[2];
+        p[3] = channels == 4 ? pixel[3] : 255;
+      }
+    }
+
+    switch (job->format) {
+      case FORMAT_DXT1:
+        encodeColorBlock(pixels, out);
+        break;
+      case FORMAT_DXT5:
+        encodeChannelBlock(pixels, 3, out);
+        encodeColorBlock(pixels, out + 8);
+        break;
+      case FORMAT_BC5:
+        encodeChannelBlock(pixels, 0, out);
+        encodeChannelBlock(pixels, 1, out + 8);
+        break;
+      default: break;
+    }
+  }
+}
+
+static int compressRows(void* userdata) {
+  CompressJob* job = userdata;
+  uint32_t i;
+  while ((i = ref_inc(&job->cursor) - 1) < job->rowCount) {
+    uint32_t level = 0;
+    uint32_t rows;
+    while (i >= (rows = (job->levels[level].height + 3) / 4)) {
+      i -= rows;
+      level++;
+    }
+    compressRow(job, level, i);
+  }
+  return 0;
+}
+
+// Generates the mipmap chain first if it doesn't exist, then compresses every level.  The pixel
+// data is replaced by the compressed blocks.
+void lovrTextureDataCompress(TextureData* textureData, TextureFormat format, bool srgb) {
+  lovrAssert(format == FORMAT_DXT1 || format == FORMAT_DXT5 || format == FORMAT_BC5, "TextureData can only be compressed to dxt1, dxt5, or bc5");
+  lovrAssert(textureData->format == FORMAT_RGB || textureData->format == FORMAT_RGBA, "Only RGB and RGBA TextureData can be compressed");
+  lovrAssert(textureData->blob.data, "TextureData does not have any pixel data");
+
+  if (!textureData->mipmaps) {
+    lovrTextureDataGenerateMipmaps(textureData, srgb);
+  }
+
+  uint32_t levelCount = textureData->mipmapCount;
+  size_t blockBytes = format == FORMAT_DXT1 ? 8 : 16;
+  uint32_t rowCount = 0;
+  size_t size = 0;
+  for (uint32_t i = 0; i < levelCount; i++) {
+    uint32_t blocksWide = (textureData->mipmaps[i].width + 3) / 4;
+    uint32_t blocksHigh = (textureData->mipmaps[i].height + 3) / 4;
+    size += (size_t) blocksWide * blocksHigh * blockBytes;
+    rowCount += blocksHigh;
+  }
+
+  Mipmap* blocks = malloc(levelCount * sizeof(Mipmap) + size);
+  lovrAssert(blocks, "Out of memory");
+  uint8_t* data = (uint8_t*) (blocks + levelCount);
+  for (uint32_t i = 0; i < levelCount; i++) {
+    uint32_t width = textureData->mipmaps[i].width;
+    uint32_t height = textureData->mipmaps[i].height;
+    size_t levelSize = (size_t) ((width + 3) / 4) * ((height + 3) / 4) * blockBytes;
+    blocks[i] = (Mipmap) { .width = width, .height = height, .size = levelSize, .data = data };
+    data += levelSize;
+  }
+
+  CompressJob job = {
+    .levels = textureData->mipmaps,
+    .blocks = blocks,
+    .channels = textureData->format == FORMAT_RGBA ? 4 : 3,
+    .format = format,
+    .rowCount = rowCount
+  };
+
+#ifdef LOVR_ENABLE_THREAD
+  // The calling thread helps out too, so small images don't bother starting any threads
+  thrd_t workers[MAX_COMPRESS_WORKERS];
+  uint32_t workerCount = MIN(rowCount / 64, MAX_COMPRESS_WORKERS);
+  uint32_t started = 0;
+  while (started < workerCount && thrd_create(&workers[started], compressRows, &job) == thrd_success) {
+    started++;
+  }
+  compressRows(&job);
+  for (uint32_t i = 0; i < started; i++) {
+    thrd_join(workers[i], NULL);
+  }
+#else
+  compressRows(&job);
+#endif
+
+  free(textureData->mipmaps);
+  free(textureData->blob.data);
+  textureData->blob.data = NULL;
+  textureData->blob.size = 0;
+  textureData->mipmaps = blocks;
+  textureData->mipmapCount = levelCount;
+  textureData->format = format;
+}
+
+// Atlas packing (MaxRects with the best short side fit heuristic)
+
+typedef struct {
+  uint32_t x;
+  uint32_t y;
+  uint32_t width;
+  uint32_t height;
+} PackRect;
+
+typedef struct {
+  uint32_t index;
+  uint32_t width;
+  uint32_t height;
+} PackItem;
+
+typedef arr_t(PackRect) arr_packrect_t;
+
+static bool packContains(const PackRect* a, const PackRect* b) {
+  return b->x >= a->x && b->y >= a->y && b->x + b->width <= a->x + a->width && b->y + b->height <= a->y + a->height;
+}
+
+// Splits every free rectangle that overlaps the used one, then removes free rectangles that are
+// inside of other ones
+static void packSplit(arr_packrect_t* rects, arr_packrect_t* scratch, PackRect used) {
+  arr_clear(scratch);
+  for (size_t i = 0; i < rects->length; i++) {
+    PackRect f = rects->data[i];
+    if (used.x >= f.x + f.width || used.x + used.width <= f.x || used.y >= f.y + f.height || used.y + used.height <= f.y) {
+      arr_push(scratch, f);
+      continue;
+    }
+
+    if (used.x > f.x) {
+      arr_push(scratch, ((PackRect) { f.x, f.y, used.x - f.x, f.height }));
+    }
+    if (used.x + used.width < f.x + f.width) {
+      arr_push(scratch, ((PackRect) { used.x + used.width, f.y, f.x + f.width - used.x - used.width, f.height }));
+    }
+    if (used.y > f.y) {
+      arr_push(scratch, ((PackRect) { f.x, f.y, f.width, used.y - f.y }));
+    }
+    if (used.y + used.height < f.y + f.height) {
+      arr_push(scratch, ((PackRect) { f.x, used.y + used.height, f.width, f.y + f.height - used.y - used.height }));
+    }
+  }
+
+  arr_clear(rects);
+  for (size_t i = 0; i < scratch->length; i++) {
+    bool contained = false;
+    for (size_t j = 0; j < scratch->length && !contained; j++) {
+      PackRect* a = &scratch->data[j];
+      PackRect* b = &scratch->data[i];
+      contained = i != j && packContains(a, b) && (!packContains(b, a) || j < i);
+    }
+
+    if (!contained) {
+      arr_push(rects, scratch->data[i]);
+    }
+  }
+}
+
+static bool packInsert(arr_packrect_t* rects, arr_packrect_t* scratch, uint32_t width, uint32_t height, PackRect* result) {
+  uint32_t bestShort = UINT32_MAX;
+  uint32_t bestLong = UINT32_MAX;
+  for (size_t i = 0; i < rects->length; i++) {
+    PackRect* f = &rects->data[i];
+    if (f->width >= width && f->height >= height) {
+      uint32_t dx = f->width - width;
+      uint32_t dy = f->height - height;
+      uint32_t shortSide = MIN(dx, dy);
+      uint32_t longSide = MAX(dx, dy);
+      if (shortSide < bestShort || (shortSide == bestShort && longSide < bestLong)) {
+        bestShort = shortSide;
+        bestLong = longSide;
+        *result = (PackRect) { f->x, f->y, width, height };
+      }
+    }
+  }
+
+  if (bestShort == UINT32_MAX) {
+    return false;
+  }
+
+  packSplit(rects, scratch, *result);
+  return true;
+}
+
+static int packCompare(const void* a, const void* b) {
+  const PackItem* x = a;
+  const PackItem* y = b;
+  uint32_t sx = MAX(x->width, x->height);
+  uint32_t sy = MAX(y->width, y->height);
+  if (sx != sy) return sx > sy ? -1 : 1;
+  uint32_t ax = x->width * x->height;
+  uint32_t ay = y->width * y->height;
+  if (ax != ay) return ax > ay ? -1 : 1;
+  return x->index < y->index ? -1 : 1;
+}
+
+// Returns the number of pages used, or 0 if everything didn't fit on one page and paging is off
+static uint32_t packPages(PackItem* items, uint32_t count, uint32_t width, uint32_t height, uint32_t padding, bool paged, AtlasRect* rects) {
+  arr_packrect_t freeRects, scratch;
+  arr_init(&freeRects);
+  arr_init(&scratch);
+  uint32_t remaining = count;
+  uint32_t pages = 0;
+
+  for (uint32_t i = 0; i < count; i++) {
+    rects[items[i].index].width = 0;
+  }
+
+  while (remaining > 0) {
+    arr_clear(&freeRects);
+    arr_push(&freeRects, ((PackRect) { 0, 0, width, height }));
+    uint32_t placed = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+      PackItem* item = &items[i];
+      PackRect rect = { 0, 0, 0, 0 };
+      if (rects[item->index].width == 0 && packInsert(&freeRects, &scratch, item->width, item->height, &rect)) {
+        rects[item->index] = (AtlasRect) {
+          .x = rect.x + padding,
+          .y = rect.y + padding,
+          .width = item->width - 2 * padding,
+          .height = item->height - 2 * padding,
+          .page = pages
+        };
+        placed++;
+      }
+    }
+
+    pages++;
+    remaining -= placed;
+
+    if (placed == 0 || (remaining > 0 && !paged)) {
+      pages = 0;
+      break;
+    }
+  }
+
+  arr_free(&freeRects);
+  arr_free(&scratch);
+  return pages;
+}
+
+// Packs RGB/RGBA images into RGBA pages.  Each image gets its edge pixels repeated into the padding
+// around it, so filtering and the first few mipmap levels don't pull in neighboring images.  Pages
+// start small and grow in powers of two up to maxSize, and only once a maxSize page is full does
+// packing spill onto more pages (when paged is set).
+TextureData** lovrTextureDataPack(TextureData** images, uint32_t count, uint32_t padding, uint32_t maxSize, bool paged, AtlasRect* rects, uint32_t* pageCount) {
+  PackItem* items = malloc(count * sizeof(PackItem));
+  lovrAssert(items, "Out of memory");
+  uint64_t area = 0;
+  uint32_t maxSide = 1;
+
+  for (uint32_t i = 0; i < count; i++) {
+    TextureData* image = images[i];
+    lovrAssert(image->format == FORMAT_RGB || image->format == FORMAT_RGBA, "Only RGB and RGBA images can be packed into an atlas");
+    lovrAssert(image->blob.data, "TextureData does not have any pixel data");
+    items[i] = (PackItem) { i, image->width + 2 * padding, image->height + 2 * padding };
+    lovrAssert(items[i].width <= maxSize && items[i].height <= maxSize, "Atlas image #%d (%dx%d) is too big for a %dx%d page", i + 1, image->width, image->height, maxSize, maxSize);
+    area += (uint64_t) items[i].width * items[i].height;
+    maxSide = MAX(maxSide, MAX(items[i].width, items[i].height));
+  }
+
+  qsort(items, count, sizeof(PackItem), packCompare);
+
+  uint32_t side = 1;
+  while ((uint64_t) side * side < area || side < maxSide) {
+    side <<= 1;
+  }
+
+  uint32_t width = MIN(side, maxSize);
+  uint32_t height = (uint64_t) width * (width / 2) >= area && width / 2 >= maxSide ? width / 2 : width;
+  uint32_t pages;
+  while ((pages = packPages(items, count, width, height, padding, false, rects)) == 0) {
+    if (width >= maxSize && height >= maxSize) {
+      lovrAssert(paged, "Atlas images don't fit on a single %dx%d page", maxSize, maxSize);
+      pages = packPages(items, count, maxSize, maxSize, padding, true, rects);
+      break;
+    } else if (width <= height && width < maxSize) {
+      width = MIN(width * 2, maxSize);
+    } else {
+      height = MIN(height * 2, maxSize);
+    }
+  }
+
+  free(items);
+
+  TextureData** result = malloc(pages * sizeof(TextureData*));
+  lovrAssert(result, "Out of memory");
+  for (uint32_t i = 0; i < pages; i++) {
+    result[i] = lovrTextureDataCreate(width, height, 0, FORMAT_RGBA);
+  }
+
+  for (uint32_t i = 0; i < count; i++) {
+    TextureData* image = images[i];
+    AtlasRect* rect = &rects[i];
+    uint8_t* page = result[rect->page]->blob.data;
+    const uint8_t* pixels = image->blob.data;
+    uint32_t channels = image->format == FORMAT_RGBA ? 4 : 3;
+    int32_t w = (int32_t) image->width;
+    int32_t h = (int32_t) image->height;
+    int32_t p = (int32_t) padding;
+
+    for (int32_t y = -p; y < h + p; y++) {
+      int32_t sy = CLAMP(y, 0, h - 1);
+      uint8_t* dst = page + ((size_t) (rect->y + y) * width + rect->x - p) * 4;
+      for (int32_t x = -p; x < w + p; x++, dst += 4) {
+        int32_t sx = CLAMP(x, 0, w - 1);
+        const uint8_t* src = pixels + ((size_t) sy * w + sx) * channels;
+        dst[0] = src[0];
+        dst[1] = src[1];
+        dst[2] = src[2];
+        dst[3] = channels == 4 ? src[3] : 255;
+      }
+    }
+  }
+
+  *pageCount = pages;
+  return result;
 }
 
 void lovrTextureDataDestroy(void* ref) {
@@ -24,6 +24,7 @@ typedef enum {
   FORMAT_DXT1,
   FORMAT_DXT3,
   FORMAT_DXT5,
+  FORMAT_BC5,
   FORMAT_ASTC_4x4,
   FORMAT_ASTC_5x4,
   FORMAT_ASTC_5x5,
@@ -47,6 +48,14 @@ typedef struct {
   void* data;
 } Mipmap;
 
+typedef struct {
+  uint32_t x;
+  uint32_t y;
+  uint32_t width;
+  uint32_t height;
+  uint32_t page;
+} AtlasRect;
+
 typedef struct TextureData {
   Blob blob;
   uint32_t width;
@@ -65,4 +74,7 @@ Color lovrTextureDataGetPixel(TextureData* textureData, uint32_t x, uint32_t y);
 void lovrTextureDataSetPixel(TextureData* textureData, uint32_t x, uint32_t y, Color color);
 bool lovrTextureDataEncode(TextureData* textureData, const char* filename);
 void lovrTextureDataPaste(TextureData* textureData, TextureData* source, uint32_t dx, uint32_t dy, uint32_t sx, uint32_t sy, uint32_t w, uint32_t h);
+void lovrTextureDataGenerateMipmaps(TextureData* textureData, bool srgb);
+void lovrTextureDataCompress(TextureData* textureData, TextureFormat format, bool srgb);
+TextureData** lovrTextureDataPack(TextureData** images, uint32_t count, uint32_t padding, uint32_t maxSize, bool paged, AtlasRect* rects, uint32_t* pageCount);
 void lovrTextureDataDestroy(void* ref);
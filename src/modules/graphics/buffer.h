@@ -4,12 +4,15 @@
 
 #pragma once
 
+#define MAX_BUFFER_RANGES 16
+
 typedef enum {
   BUFFER_VERTEX,
   BUFFER_INDEX,
   BUFFER_UNIFORM,
   BUFFER_SHADER_STORAGE,
   BUFFER_GENERIC,
+  BUFFER_UPLOAD,
   MAX_BUFFER_TYPES
 } BufferType;
 
@@ -19,11 +22,16 @@ typedef enum {
   USAGE_STREAM
 } BufferUsage;
 
+typedef struct {
+  size_t start;
+  size_t end;
+} BufferRange;
+
 typedef struct Buffer {
   void* data;
   size_t size;
-  size_t flushFrom;
-  size_t flushTo;
+  BufferRange flushes[MAX_BUFFER_RANGES];
+  uint32_t flushCount;
   BufferType type;
   BufferUsage usage;
   bool mapped;
@@ -38,6 +46,7 @@ size_t lovrBufferGetSize(Buffer* buffer);
 bool lovrBufferIsReadable(Buffer* buffer);
 BufferUsage lovrBufferGetUsage(Buffer* buffer);
 void* lovrBufferMap(Buffer* buffer, size_t offset);
+void* lovrBufferGetPointer(Buffer* buffer);
 void lovrBufferFlush(Buffer* buffer, size_t offset, size_t size);
 void lovrBufferUnmap(Buffer* buffer);
 void lovrBufferDiscard(Buffer* buffer);
@@ -37,6 +37,11 @@ typedef struct Canvas {
   GPU_CANVAS_FIELDS
 } Canvas;
 
+typedef struct Readback {
+  struct TextureData* textureData;
+  GPU_READBACK_FIELDS
+} Readback;
+
 Canvas* lovrCanvasInit(Canvas* canvas, uint32_t width, uint32_t height, CanvasFlags flags);
 Canvas* lovrCanvasInitFromHandle(Canvas* canvas, uint32_t width, uint32_t height, CanvasFlags flags, uint32_t framebuffer, uint32_t depthBuffer, uint32_t resolveBuffer, uint32_t attachmentCount, bool immortal);
 #define lovrCanvasCreate(...) lovrCanvasInit(lovrAlloc(Canvas), __VA_ARGS__)
@@ -50,4 +55,10 @@ uint32_t lovrCanvasGetWidth(Canvas* canvas);
 uint32_t lovrCanvasGetHeight(Canvas* canvas);
 uint32_t lovrCanvasGetMSAA(Canvas* canvas);
 struct Texture* lovrCanvasGetDepthTexture(Canvas* canvas);
-struct TextureData* lovrCanvasNewTextureData(Canvas* canvas, uint32_t index);
+struct TextureData* lovrCanvasNewTextureData(Canvas* canvas, uint32_t index, uint32_t x, uint32_t y, uint32_t width, uint32_t height, TextureFormat format);
+
+Readback* lovrReadbackInit(Readback* readback, Canvas* canvas, uint32_t index, uint32_t x, uint32_t y, uint32_t width, uint32_t height, TextureFormat format);
+#define lovrReadbackCreate(...) lovrReadbackInit(lovrAlloc(Readback), __VA_ARGS__)
+void lovrReadbackDestroy(void* ref);
+bool lovrReadbackIsComplete(Readback* readback);
+struct TextureData* lovrReadbackGetTextureData(Readback* readback);
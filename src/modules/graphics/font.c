@@ -3,10 +3,41 @@
 #include "data/textureData.h"
 #include "core/ref.h"
 #include "core/utf.h"
+#ifdef LOVR_ENABLE_FILESYSTEM
+#include "filesystem/filesystem.h"
+#endif
+#include <inttypes.h>
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
 
+#define MAX_FONT_WORKERS 4
+#define GLYPH_CACHE_DIRECTORY "glyphcache"
+#define GLYPH_CACHE_MAGIC 0x4c47564c // LVGL
+#define GLYPH_CACHE_VERSION 1
+
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t key;
+} GlyphCacheHeader;
+
+// Followed by the glyph's (w + 2 * GLYPH_PADDING) x (h + 2 * GLYPH_PADDING) RGB pixels
+typedef struct {
+  uint32_t codepoint;
+  uint16_t w;
+  uint16_t h;
+  int16_t dx;
+  int16_t dy;
+  int16_t advance;
+  uint16_t reserved;
+} GlyphCacheEntry;
+
+static void lovrFontAddGlyphs(Font* font, PendingGlyph* pending, uint32_t count);
+static void lovrFontLoadCache(Font* font);
+static void lovrFontSaveCache(Font* font, PendingGlyph* glyphs, uint32_t count);
+static void lovrFontFlushCache(Font* font);
+
 static float* lovrFontAlignLine(float* x, float* lineEnd, float width, HorizontalAlign halign) {
   while (x < lineEnd) {
     if (halign == ALIGN_CENTER) {
@@ -21,20 +52,22 @@ static float* lovrFontAlignLine(float* x, float* lineEnd, float width, Horizonta
   return x;
 }
 
-Font* lovrFontInit(Font* font, Rasterizer* rasterizer) {
+Font* lovrFontInit(Font* font, Rasterizer* rasterizer, bool cache) {
   lovrRetain(rasterizer);
   font->rasterizer = rasterizer;
   font->lineHeight = 1.f;
   font->pixelDensity = (float) font->rasterizer->height;
   map_init(&font->kerning);
+  map_init(&font->pending);
+  arr_init(&font->cacheWrites);
 
   // Atlas
   uint32_t padding = 1;
-  font->atlas.x = padding;
-  font->atlas.y = padding;
   font->atlas.width = 128;
   font->atlas.height = 128;
   font->atlas.padding = padding;
+  arr_init(&font->atlas.skyline);
+  arr_push(&font->atlas.skyline, ((SkylineNode) { padding, padding, font->atlas.width - 2 * padding }));
   map_init(&font->atlas.glyphs);
 
   // Set initial atlas size
@@ -45,13 +78,41 @@ Font* lovrFontInit(Font* font, Rasterizer* rasterizer) {
   // Create the texture
   lovrFontCreateTexture(font);
 
+#ifdef LOVR_ENABLE_FILESYSTEM
+  // Start with any glyphs that were rasterized by a previous run
+  if (cache) {
+    font->cache = true;
+    font->cacheKey = lovrRasterizerGetHash(rasterizer);
+    lovrFontLoadCache(font);
+  }
+#endif
+
   return font;
 }
 
 void lovrFontDestroy(void* ref) {
   Font* font = ref;
+#ifdef LOVR_ENABLE_THREAD
+  if (font->workerRunning) {
+    mtx_lock(&font->lock);
+    font->stopping = true;
+    cnd_signal(&font->cond);
+    mtx_unlock(&font->lock);
+    thrd_join(font->worker, NULL);
+    for (size_t i = 0; i < font->finished.length; i++) {
+      lovrRelease(TextureData, font->finished.data[i].glyph.data);
+    }
+    arr_free(&font->queue);
+    arr_free(&font->finished);
+    cnd_destroy(&font->cond);
+    mtx_destroy(&font->lock);
+  }
+#endif
+  lovrFontFlushCache(font);
+  arr_free(&font->cacheWrites);
   lovrRelease(Rasterizer, font->rasterizer);
   lovrRelease(Texture, font->texture);
+  lovrRelease(TextureData, font->pixels);
   const char* key;
   map_iter_t iter = map_iter(&font->atlas.glyphs);
   while ((key = map_next(&font->atlas.glyphs, &iter)) != NULL) {
@@ -59,14 +120,16 @@ void lovrFontDestroy(void* ref) {
     lovrRelease(TextureData, glyph->data);
   }
   map_deinit(&font->atlas.glyphs);
+  arr_free(&font->atlas.skyline);
   map_deinit(&font->kerning);
+  map_deinit(&font->pending);
 }
 
 Rasterizer* lovrFontGetRasterizer(Font* font) {
   return font->rasterizer;
 }
 
-void lovrFontRender(Font* font, const char* str, size_t length, float wrap, HorizontalAlign halign, float* vertices, uint16_t* indices, uint16_t baseVertex) {
+void lovrFontRender(Font* font, const char* str, size_t length, float wrap, HorizontalAlign halign, float* vertices, uint32_t* indices, uint32_t baseVertex) {
   FontAtlas* atlas = &font->atlas;
   bool flip = font->flip;
 
@@ -83,9 +146,9 @@ void lovrFontRender(Font* font, const char* str, size_t length, float wrap, Hori
   size_t bytes;
 
   float* vertexCursor = vertices;
-  uint16_t* indexCursor = indices;
+  uint32_t* indexCursor = indices;
   float* lineStart = vertices;
-  uint16_t I = baseVertex;
+  uint32_t I = baseVertex;
 
   while ((bytes = utf8_decode(str, end, &codepoint)) > 0) {
 
@@ -114,7 +177,7 @@ void lovrFontRender(Font* font, const char* str, size_t length, float wrap, Hori
     // Get glyph
     Glyph* glyph = lovrFontGetGlyph(font, codepoint);
 
-    // Start over if texture was repacked
+    // Start over if the atlas grew, since the texture coordinates changed
     if (u != atlas->width || v != atlas->height) {
       lovrFontRender(font, start, length, wrap, halign, vertices, indices, baseVertex);
       return;
@@ -138,7 +201,7 @@ void lovrFontRender(Font* font, const char* str, size_t length, float wrap, Hori
         x2, y2, 0.f, 0.f, 0.f, 0.f, s2, t2
       }, 32 * sizeof(float));
 
-      memcpy(indexCursor, (uint16_t[6]) { I + 0, I + 1, I + 2, I + 2, I + 1, I + 3 }, 6 * sizeof(uint16_t));
+      memcpy(indexCursor, (uint32_t[6]) { I + 0, I + 1, I + 2, I + 2, I + 1, I + 3 }, 6 * sizeof(uint32_t));
 
       vertexCursor += 32;
       indexCursor += 6;
@@ -155,6 +218,8 @@ void lovrFontRender(Font* font, const char* str, size_t length, float wrap, Hori
 }
 
 void lovrFontMeasure(Font* font, const char* str, size_t length, float wrap, float* width, uint32_t* lineCount, uint32_t* glyphCount) {
+  lovrFontUpdate(font);
+
   float x = 0.f;
   const char* end = str + length;
   size_t bytes;
@@ -219,6 +284,7 @@ float lovrFontGetLineHeight(Font* font) {
 
 void lovrFontSetLineHeight(Font* font, float lineHeight) {
   font->lineHeight = lineHeight;
+  font->version++;
 }
 
 bool lovrFontIsFlipEnabled(Font* font) {
@@ -227,6 +293,7 @@ bool lovrFontIsFlipEnabled(Font* font) {
 
 void lovrFontSetFlipEnabled(Font* font, bool flip) {
   font->flip = flip;
+  font->version++;
 }
 
 int32_t lovrFontGetKerning(Font* font, unsigned int left, unsigned int right) {
@@ -253,65 +320,496 @@ void lovrFontSetPixelDensity(Font* font, float pixelDensity) {
   }
 
   font->pixelDensity = pixelDensity;
+  font->version++;
 }
 
 Glyph* lovrFontGetGlyph(Font* font, uint32_t codepoint) {
-  char key[6];
-  snprintf(key, 6, "%d", codepoint);
+  char key[12];
+  snprintf(key, sizeof(key), "%d", codepoint);
 
   FontAtlas* atlas = &font->atlas;
   map_glyph_t* glyphs = &atlas->glyphs;
   Glyph* glyph = map_get(glyphs, key);
 
-  // Add the glyph to the atlas if it isn't there
-  if (!glyph) {
-    Glyph g;
-    lovrRasterizerLoadGlyph(font->rasterizer, codepoint, &g);
-    map_set(glyphs, key, g);
-    glyph = map_get(glyphs, key);
-    lovrFontAddGlyph(font, glyph);
+  if (glyph) {
+    return glyph;
   }
 
+#ifdef LOVR_ENABLE_THREAD
+  // In async mode, missing glyphs are rasterized in the background.  Until then they're blank, but
+  // still take up space.
+  if (font->async && lovrRasterizerHasGlyph(font->rasterizer, codepoint)) {
+    if (!map_get(&font->pending, key)) {
+      map_set(&font->pending, key, 1);
+      mtx_lock(&font->lock);
+      arr_push(&font->queue, codepoint);
+      cnd_signal(&font->cond);
+      mtx_unlock(&font->lock);
+    }
+
+    memset(&font->placeholder, 0, sizeof(Glyph));
+    font->placeholder.advance = lovrRasterizerGetAdvance(font->rasterizer, codepoint);
+    return &font->placeholder;
+  }
+#endif
+
+  // Add the glyph to the atlas if it isn't there
+  Glyph g;
+  lovrRasterizerLoadGlyph(font->rasterizer, codepoint, &g);
+  lovrFontSaveCache(font, &(PendingGlyph) { codepoint, g }, 1);
+  map_set(glyphs, key, g);
+  glyph = map_get(glyphs, key);
+  lovrFontAddGlyph(font, glyph);
   return glyph;
 }
 
-void lovrFontAddGlyph(Font* font, Glyph* glyph) {
-  FontAtlas* atlas = &font->atlas;
+// Returns the lowest row a rectangle fits at with its left edge at the start of a skyline node, or
+// UINT32_MAX if it doesn't fit there
+static uint32_t lovrFontFitSkyline(FontAtlas* atlas, size_t index, uint32_t width, uint32_t height) {
+  SkylineNode* nodes = atlas->skyline.data;
+  if (nodes[index].x + width > atlas->width - atlas->padding) {
+    return UINT32_MAX;
+  }
+
+  uint32_t y = 0;
+  uint32_t remaining = width;
+  for (size_t i = index; i < atlas->skyline.length && remaining > 0; i++) {
+    y = MAX(y, nodes[i].y);
+    if (y + height > atlas->height - atlas->padding) {
+      return UINT32_MAX;
+    }
+    remaining -= MIN(remaining, nodes[i].width);
+  }
+
+  return y;
+}
+
+// Joins neighboring nodes at the same height and drops empty ones
+static void lovrFontMergeSkyline(FontAtlas* atlas) {
+  SkylineNode* nodes = atlas->skyline.data;
+  size_t count = 0;
+  for (size_t i = 0; i < atlas->skyline.length; i++) {
+    if (nodes[i].width == 0) {
+      continue;
+    } else if (count > 0 && nodes[count - 1].y == nodes[i].y) {
+      nodes[count - 1].width += nodes[i].width;
+    } else {
+      nodes[count++] = nodes[i];
+    }
+  }
+  atlas->skyline.length = count;
+}
+
+// Finds a spot for a glyph using the bottom-left skyline heuristic, returning false if the atlas is
+// full.  Unlike rows, this fills in the gaps left over next to short glyphs.
+static bool lovrFontPlaceGlyph(FontAtlas* atlas, Glyph* glyph) {
+  uint32_t width = glyph->tw + atlas->padding;
+  uint32_t height = glyph->th + atlas->padding;
+  size_t best = SIZE_MAX;
+  uint32_t bestY = UINT32_MAX;
+  uint32_t bestWidth = UINT32_MAX;
+
+  for (size_t i = 0; i < atlas->skyline.length; i++) {
+    uint32_t y = lovrFontFitSkyline(atlas, i, width, height);
+    if (y == UINT32_MAX) {
+      continue;
+    }
+
+    if (y < bestY || (y == bestY && atlas->skyline.data[i].width < bestWidth)) {
+      best = i;
+      bestY = y;
+      bestWidth = atlas->skyline.data[i].width;
+    }
+  }
+
+  if (best == SIZE_MAX) {
+    return false;
+  }
+
+  glyph->x = atlas->skyline.data[best].x;
+  glyph->y = bestY;
+
+  // Add a node on top of the glyph and trim the ones underneath it
+  arr_reserve(&atlas->skyline, atlas->skyline.length + 1);
+  SkylineNode* nodes = atlas->skyline.data;
+  memmove(nodes + best + 1, nodes + best, (atlas->skyline.length - best) * sizeof(SkylineNode));
+  nodes[best] = (SkylineNode) { glyph->x, bestY + height, width };
+  atlas->skyline.length++;
+
+  uint32_t end = glyph->x + width;
+  for (size_t i = best + 1; i < atlas->skyline.length && nodes[i].x < end; i++) {
+    uint32_t overlap = MIN(end - nodes[i].x, nodes[i].width);
+    nodes[i].x += overlap;
+    nodes[i].width -= overlap;
+  }
+
+  lovrFontMergeSkyline(atlas);
+  return true;
+}
 
-  // Don't waste space on empty glyphs
+// Copies a rectangle of RGB pixels.  Rows are in the same order as the texture's, so (x, y) is the
+// texel the rectangle starts at.
+static void lovrFontCopyPixels(TextureData* dst, uint32_t dx, uint32_t dy, TextureData* src, uint32_t sx, uint32_t sy, uint32_t w, uint32_t h) {
+  uint8_t* from = (uint8_t*) src->blob.data + ((size_t) sy * src->width + sx) * 3;
+  uint8_t* to = (uint8_t*) dst->blob.data + ((size_t) dy * dst->width + dx) * 3;
+  for (uint32_t y = 0; y < h; y++) {
+    memcpy(to, from, w * 3);
+    from += src->width * 3;
+    to += dst->width * 3;
+  }
+}
+
+// Places a glyph and copies it into the CPU copy of the atlas.  Returns false for empty glyphs,
+// which don't take up any space.
+static bool lovrFontStageGlyph(Font* font, Glyph* glyph) {
   if (glyph->w == 0 && glyph->h == 0) {
+    return false;
+  }
+
+  while (!lovrFontPlaceGlyph(&font->atlas, glyph)) {
+    lovrFontExpandTexture(font);
+  }
+
+  lovrFontCopyPixels(font->pixels, glyph->x, glyph->y, glyph->data, 0, 0, glyph->tw, glyph->th);
+  return true;
+}
+
+// Once a glyph is in the atlas its pixels aren't needed anymore, since the atlas keeps a copy
+void lovrFontAddGlyph(Font* font, Glyph* glyph) {
+  if (lovrFontStageGlyph(font, glyph)) {
+    lovrTextureReplacePixels(font->texture, glyph->data, glyph->x, glyph->y, 0, 0, false);
+  }
+
+  lovrRelease(TextureData, glyph->data);
+  glyph->data = NULL;
+}
+
+static int compareGlyphHeights(const void* a, const void* b) {
+  uint32_t x = ((const PendingGlyph*) a)->glyph.th;
+  uint32_t y = ((const PendingGlyph*) b)->glyph.th;
+  return (x < y) - (x > y);
+}
+
+// Adds a set of rasterized glyphs to the atlas.  The tallest ones are placed first since that packs
+// tighter.  The glyphs are placed anywhere on the skyline, so the rectangle around all of them is
+// uploaded from the atlas's CPU copy, which already has the pixels of any older glyphs inside it.
+static void lovrFontAddGlyphs(Font* font, PendingGlyph* pending, uint32_t count) {
+  map_glyph_t* glyphs = &font->atlas.glyphs;
+  uint32_t x0 = UINT32_MAX, y0 = UINT32_MAX, x1 = 0, y1 = 0;
+  char key[12];
+
+  qsort(pending, count, sizeof(PendingGlyph), compareGlyphHeights);
+
+  for (uint32_t i = 0; i < count; i++) {
+    snprintf(key, sizeof(key), "%d", pending[i].codepoint);
+    map_set(glyphs, key, pending[i].glyph);
+    Glyph* glyph = map_get(glyphs, key);
+
+    if (lovrFontStageGlyph(font, glyph)) {
+      x0 = MIN(x0, glyph->x);
+      y0 = MIN(y0, glyph->y);
+      x1 = MAX(x1, glyph->x + glyph->tw);
+      y1 = MAX(y1, glyph->y + glyph->th);
+    }
+
+    lovrRelease(TextureData, glyph->data);
+    glyph->data = NULL;
+  }
+
+  if (x1 > x0) {
+    TextureData* region = lovrTextureDataCreate(x1 - x0, y1 - y0, 0x0, FORMAT_RGB);
+    lovrFontCopyPixels(region, 0, 0, font->pixels, x0, y0, x1 - x0, y1 - y0);
+    lovrTextureReplacePixels(font->texture, region, x0, y0, 0, 0, false);
+    lovrRelease(TextureData, region);
+  }
+}
+
+typedef struct {
+  Rasterizer* rasterizer;
+  PendingGlyph* glyphs;
+  uint32_t count;
+  Ref cursor;
+} GlyphJob;
+
+static int lovrFontRasterizeGlyphs(void* userdata) {
+  GlyphJob* job = userdata;
+  uint32_t i;
+  while ((i = ref_inc(&job->cursor) - 1) < job->count) {
+    lovrRasterizerLoadGlyph(job->rasterizer, job->glyphs[i].codepoint, &job->glyphs[i].glyph);
+  }
+  return 0;
+}
+
+void lovrFontPrewarm(Font* font, const uint32_t* codepoints, uint32_t count) {
+  lovrFontUpdate(font);
+
+  // Collect the glyphs that aren't in the atlas yet, skipping duplicates and missing glyphs
+  arr_pendingglyph_t glyphs;
+  arr_init(&glyphs);
+  map_int_t seen;
+  map_init(&seen);
+  char key[12];
+
+  for (uint32_t i = 0; i < count; i++) {
+    snprintf(key, sizeof(key), "%d", codepoints[i]);
+    if (map_get(&font->atlas.glyphs, key) || map_get(&font->pending, key) || map_get(&seen, key)) {
+      continue;
+    }
+
+    if (lovrRasterizerHasGlyph(font->rasterizer, codepoints[i])) {
+      map_set(&seen, key, 1);
+      arr_push(&glyphs, ((PendingGlyph) { .codepoint = codepoints[i] }));
+    }
+  }
+
+  map_deinit(&seen);
+
+  if (glyphs.length == 0) {
+    arr_free(&glyphs);
     return;
   }
 
-  // If the glyph does not fit, you must acquit (new row)
-  if (atlas->x + glyph->tw > atlas->width - 2 * atlas->padding) {
-    atlas->x = atlas->padding;
-    atlas->y += atlas->rowHeight + atlas->padding;
-    atlas->rowHeight = 0;
+  GlyphJob job = { .rasterizer = font->rasterizer, .glyphs = glyphs.data, .count = glyphs.length };
+
+#ifdef LOVR_ENABLE_THREAD
+  // The calling thread helps out too, so small sets don't bother starting any threads
+  thrd_t workers[MAX_FONT_WORKERS];
+  uint32_t workerCount = MIN(glyphs.length / 16, MAX_FONT_WORKERS);
+  uint32_t started = 0;
+  while (started < workerCount && thrd_create(&workers[started], lovrFontRasterizeGlyphs, &job) == thrd_success) {
+    started++;
+  }
+  lovrFontRasterizeGlyphs(&job);
+  for (uint32_t i = 0; i < started; i++) {
+    thrd_join(workers[i], NULL);
   }
+#else
+  lovrFontRasterizeGlyphs(&job);
+#endif
 
-  // Expand the texture if needed. Expanding the texture re-adds all the glyphs, so we can return.
-  if (atlas->y + glyph->th > atlas->height - 2 * atlas->padding) {
-    lovrFontExpandTexture(font);
+  lovrFontSaveCache(font, glyphs.data, glyphs.length);
+  lovrFontAddGlyphs(font, glyphs.data, glyphs.length);
+  arr_free(&glyphs);
+}
+
+#ifdef LOVR_ENABLE_THREAD
+static int lovrFontAsyncWorker(void* userdata) {
+  Font* font = userdata;
+  mtx_lock(&font->lock);
+
+  for (;;) {
+    while (font->queue.length == 0 && !font->stopping) {
+      cnd_wait(&font->cond, &font->lock);
+    }
+
+    if (font->stopping) {
+      break;
+    }
+
+    PendingGlyph pending = { .codepoint = arr_pop(&font->queue) };
+    mtx_unlock(&font->lock);
+    lovrRasterizerLoadGlyph(font->rasterizer, pending.codepoint, &pending.glyph);
+    mtx_lock(&font->lock);
+    arr_push(&font->finished, pending);
+  }
+
+  mtx_unlock(&font->lock);
+  return 0;
+}
+#endif
+
+// Adds any glyphs that finished rasterizing in the background to the atlas, and writes out the glyphs
+// that were cached since the last update
+void lovrFontUpdate(Font* font) {
+  lovrFontFlushCache(font);
+
+#ifdef LOVR_ENABLE_THREAD
+  if (!font->workerRunning) {
+    return;
+  }
+
+  mtx_lock(&font->lock);
+  arr_pendingglyph_t finished = font->finished;
+  arr_init(&font->finished);
+  mtx_unlock(&font->lock);
+
+  if (finished.length == 0) {
+    arr_free(&finished);
+    return;
+  }
+
+  // Glyphs that were rasterized inline after async mode was turned off are already in the atlas
+  char key[12];
+  size_t count = 0;
+  for (size_t i = 0; i < finished.length; i++) {
+    snprintf(key, sizeof(key), "%d", finished.data[i].codepoint);
+    map_remove(&font->pending, key);
+    if (map_get(&font->atlas.glyphs, key)) {
+      lovrRelease(TextureData, finished.data[i].glyph.data);
+    } else {
+      finished.data[count++] = finished.data[i];
+    }
+  }
+  finished.length = count;
+
+  if (finished.length == 0) {
+    arr_free(&finished);
+    return;
+  }
+
+  lovrFontSaveCache(font, finished.data, finished.length);
+  lovrFontAddGlyphs(font, finished.data, finished.length);
+  arr_free(&finished);
+
+  // Anything laid out with blank placeholders needs to be redone
+  font->version++;
+#endif
+}
+
+// The cache is a header followed by glyph records, which are appended as glyphs get rasterized
+#ifdef LOVR_ENABLE_FILESYSTEM
+static void lovrFontGetCachePath(Font* font, char* path, size_t size) {
+  snprintf(path, size, GLYPH_CACHE_DIRECTORY "/%016" PRIx64, font->cacheKey);
+}
+#endif
+
+static void lovrFontLoadCache(Font* font) {
+#ifdef LOVR_ENABLE_FILESYSTEM
+  char path[64];
+  lovrFontGetCachePath(font, path, sizeof(path));
+  GlyphCacheHeader header = { GLYPH_CACHE_MAGIC, GLYPH_CACHE_VERSION, font->cacheKey };
+
+  size_t size;
+  uint8_t* data = lovrFilesystemRead(path, -1, &size);
+  if (!data || size < sizeof(header) || memcmp(data, &header, sizeof(header))) {
+    free(data);
     return;
   }
 
-  // Keep track of glyph's position in the atlas
-  glyph->x = atlas->x;
-  glyph->y = atlas->y;
+  font->cacheExists = true;
+
+  arr_pendingglyph_t glyphs;
+  arr_init(&glyphs);
+  size_t offset = sizeof(header);
+  while (offset + sizeof(GlyphCacheEntry) <= size) {
+    GlyphCacheEntry entry;
+    memcpy(&entry, data + offset, sizeof(entry));
+    uint32_t tw = entry.w + 2 * GLYPH_PADDING;
+    uint32_t th = entry.h + 2 * GLYPH_PADDING;
+    size_t pixelSize = (size_t) tw * th * 3;
+    if (offset + sizeof(entry) + pixelSize > size) {
+      break;
+    }
+
+    PendingGlyph pending = {
+      .codepoint = entry.codepoint,
+      .glyph = {
+        .w = entry.w,
+        .h = entry.h,
+        .tw = tw,
+        .th = th,
+        .dx = entry.dx,
+        .dy = entry.dy,
+        .advance = entry.advance,
+        .data = lovrTextureDataCreate(tw, th, 0x0, FORMAT_RGB)
+      }
+    };
+
+    memcpy(pending.glyph.data->blob.data, data + offset + sizeof(entry), pixelSize);
+    arr_push(&glyphs, pending);
+    offset += sizeof(entry) + pixelSize;
+  }
+
+  // A partial record at the end means a write got cut off, so it's dropped before appending more
+  if (offset < size) {
+    lovrFilesystemWrite(path, (const char*) data, offset, false);
+  }
 
-  // Paste glyph into texture
-  lovrTextureReplacePixels(font->texture, glyph->data, atlas->x, atlas->y, 0, 0);
+  free(data);
 
-  // Advance atlas cursor
-  atlas->x += glyph->tw + atlas->padding;
-  atlas->rowHeight = MAX(atlas->rowHeight, glyph->th);
+  if (glyphs.length > 0) {
+    lovrFontAddGlyphs(font, glyphs.data, glyphs.length);
+  }
+
+  arr_free(&glyphs);
+#endif
 }
 
+// Records are buffered and written by lovrFontFlushCache, so adding glyphs one at a time doesn't
+// open the file for each of them
+static void lovrFontSaveCache(Font* font, PendingGlyph* glyphs, uint32_t count) {
+#ifdef LOVR_ENABLE_FILESYSTEM
+  if (!font->cache) {
+    return;
+  }
+
+  for (uint32_t i = 0; i < count; i++) {
+    Glyph* glyph = &glyphs[i].glyph;
+    GlyphCacheEntry entry = {
+      .codepoint = glyphs[i].codepoint,
+      .w = glyph->w,
+      .h = glyph->h,
+      .dx = glyph->dx,
+      .dy = glyph->dy,
+      .advance = glyph->advance
+    };
+
+    arr_append(&font->cacheWrites, (uint8_t*) &entry, sizeof(entry));
+    arr_append(&font->cacheWrites, (uint8_t*) glyph->data->blob.data, glyph->data->blob.size);
+  }
+#endif
+}
+
+// The directory and the file are only created once there's a glyph to put in them
+static void lovrFontFlushCache(Font* font) {
+#ifdef LOVR_ENABLE_FILESYSTEM
+  if (font->cacheWrites.length == 0) {
+    return;
+  }
+
+  char path[64];
+  lovrFontGetCachePath(font, path, sizeof(path));
+
+  if (!font->cacheExists) {
+    GlyphCacheHeader header = { GLYPH_CACHE_MAGIC, GLYPH_CACHE_VERSION, font->cacheKey };
+    lovrFilesystemCreateDirectory(GLYPH_CACHE_DIRECTORY);
+    lovrFilesystemWrite(path, (const char*) &header, sizeof(header), false);
+    font->cacheExists = true;
+  }
+
+  lovrFilesystemWrite(path, (const char*) font->cacheWrites.data, font->cacheWrites.length, true);
+  font->cacheWrites.length = 0;
+#endif
+}
+
+bool lovrFontIsAsync(Font* font) {
+  return font->async;
+}
+
+void lovrFontSetAsync(Font* font, bool async) {
+#ifdef LOVR_ENABLE_THREAD
+  if (async && !font->workerRunning) {
+    mtx_init(&font->lock, mtx_plain);
+    cnd_init(&font->cond);
+    arr_init(&font->queue);
+    arr_init(&font->finished);
+    lovrAssert(thrd_create(&font->worker, lovrFontAsyncWorker, font) == thrd_success, "Could not create font worker thread");
+    font->workerRunning = true;
+  }
+
+  font->async = async;
+#endif
+}
+
+// Glyphs keep their spots when the atlas grows.  Doubling the width adds free space to the right of
+// the skyline, and doubling the height just moves the limit down.  The new texture is created from
+// the atlas's CPU copy, so the glyphs don't have to be rasterized or uploaded one by one again.
 void lovrFontExpandTexture(Font* font) {
   FontAtlas* atlas = &font->atlas;
 
   if (atlas->width == atlas->height) {
+    arr_push(&atlas->skyline, ((SkylineNode) { atlas->width - atlas->padding, atlas->padding, atlas->width }));
+    lovrFontMergeSkyline(atlas);
     atlas->width *= 2;
   } else {
     atlas->height *= 2;
@@ -321,30 +819,25 @@ void lovrFontExpandTexture(Font* font) {
     return;
   }
 
-  // Recreate the texture
   lovrFontCreateTexture(font);
-
-  // Reset the cursor
-  atlas->x = atlas->padding;
-  atlas->y = atlas->padding;
-  atlas->rowHeight = 0;
-
-  // Re-pack all the glyphs
-  const char* key;
-  map_iter_t iter = map_iter(&atlas->glyphs);
-  while ((key = map_next(&atlas->glyphs, &iter)) != NULL) {
-    Glyph* glyph = map_get(&atlas->glyphs, key);
-    lovrFontAddGlyph(font, glyph);
-  }
 }
 
-// TODO we only need the TextureData here to clear the texture, but it's a big waste of memory.
-// Could look into using glClearTexImage when supported to make this more efficient.
+// Recreating the texture changes the texture coordinates of every glyph, so the version changes to
+// invalidate any cached layout
 void lovrFontCreateTexture(Font* font) {
+  FontAtlas* atlas = &font->atlas;
   lovrRelease(Texture, font->texture);
-  TextureData* textureData = lovrTextureDataCreate(font->atlas.width, font->atlas.height, 0x0, FORMAT_RGB);
-  font->texture = lovrTextureCreate(TEXTURE_2D, &textureData, 1, false, false, 0);
+  font->version++;
+
+  // The CPU copy of the atlas grows with it, keeping the glyphs in the corner
+  TextureData* pixels = lovrTextureDataCreate(atlas->width, atlas->height, 0x0, FORMAT_RGB);
+  if (font->pixels) {
+    lovrFontCopyPixels(pixels, 0, 0, font->pixels, 0, 0, font->pixels->width, font->pixels->height);
+    lovrRelease(TextureData, font->pixels);
+  }
+  font->pixels = pixels;
+
+  font->texture = lovrTextureCreate(TEXTURE_2D, &font->pixels, 1, false, false, 0);
   lovrTextureSetFilter(font->texture, (TextureFilter) { .mode = FILTER_BILINEAR });
   lovrTextureSetWrap(font->texture, (TextureWrap) { .s = WRAP_CLAMP, .t = WRAP_CLAMP });
-  lovrRelease(TextureData, textureData);
 }
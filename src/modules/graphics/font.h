@@ -1,5 +1,9 @@
 #include "data/rasterizer.h"
 #include "lib/map/map.h"
+#include "core/arr.h"
+#ifdef LOVR_ENABLE_THREAD
+#include "lib/tinycthread/tinycthread.h"
+#endif
 #include <stdbool.h>
 #include <stdint.h>
 
@@ -22,31 +26,65 @@ typedef enum {
   ALIGN_BOTTOM
 } VerticalAlign;
 
+// A horizontal segment of the skyline, the lowest free row above each column of the atlas
 typedef struct {
   uint32_t x;
   uint32_t y;
   uint32_t width;
+} SkylineNode;
+
+typedef struct {
+  uint32_t width;
   uint32_t height;
-  uint32_t rowHeight;
   uint32_t padding;
+  arr_t(SkylineNode) skyline;
   map_glyph_t glyphs;
 } FontAtlas;
 
+typedef struct {
+  uint32_t codepoint;
+  Glyph glyph;
+} PendingGlyph;
+
+typedef arr_t(PendingGlyph) arr_pendingglyph_t;
+
 typedef struct Font {
   struct Rasterizer* rasterizer;
   struct Texture* texture;
+  struct TextureData* pixels;
   FontAtlas atlas;
   map_int_t kerning;
   float lineHeight;
   float pixelDensity;
+  uint32_t version;
   bool flip;
+  bool async;
+  bool cache;
+  bool cacheExists;
+  uint64_t cacheKey;
+  arr_t(uint8_t) cacheWrites;
+  map_int_t pending;
+  Glyph placeholder;
+#ifdef LOVR_ENABLE_THREAD
+  thrd_t worker;
+  mtx_t lock;
+  cnd_t cond;
+  arr_t(uint32_t) queue;
+  arr_pendingglyph_t finished;
+  bool workerRunning;
+  bool stopping;
+#endif
 } Font;
 
-Font* lovrFontInit(Font* font, struct Rasterizer* rasterizer);
+Font* lovrFontInit(Font* font, struct Rasterizer* rasterizer, bool cache);
 #define lovrFontCreate(...) lovrFontInit(lovrAlloc(Font), __VA_ARGS__)
 void lovrFontDestroy(void* ref);
 struct Rasterizer* lovrFontGetRasterizer(Font* font);
-void lovrFontRender(Font* font, const char* str, size_t length, float wrap, HorizontalAlign halign, float* vertices, uint16_t* indices, uint16_t baseVertex);
+void lovrFontUpdate(Font* font);
+void lovrFontPrewarm(Font* font, const uint32_t* codepoints, uint32_t count);
+bool lovrFontIsAsync(Font* font);
+void lovrFontSetAsync(Font* font, bool async);
+void lovrFontRender(Font* font, const char* str, size_t length, float wrap, HorizontalAlign halign, float* vertices, uint32_t* indices, uint32_t baseVertex);
 void lovrFontMeasure(Font* font, const char* string, size_t length, float wrap, float* width, uint32_t* lineCount, uint32_t* glyphCount);
 float lovrFontGetHeight(Font* font);
 float lovrFontGetAscent(Font* font);
@@ -4,7 +4,10 @@
 #include "graphics/material.h"
 #include "graphics/mesh.h"
 #include "graphics/shader.h"
+#include "graphics/spriteBatch.h"
+#include "graphics/text.h"
 #include "graphics/texture.h"
+#include "data/blob.h"
 #include "data/rasterizer.h"
 #include "event/event.h"
 #include "math/math.h"
@@ -18,16 +21,9 @@
 #define MAX_TRANSFORMS 64
 #define MAX_BATCHES 4
 #define MAX_DRAWS 256
-
-typedef enum {
-  STREAM_VERTEX,
-  STREAM_DRAWID,
-  STREAM_INDEX,
-  STREAM_MODEL,
-  STREAM_COLOR,
-  STREAM_FRAME,
-  MAX_STREAMS
-} StreamType;
+#define MIN_STREAM_VERTICES 4096
+#define MIN_STREAM_INDICES 4096
+#define MAX_BLOB_BUFFERS 4
 
 typedef enum {
   BATCH_POINTS,
@@ -51,8 +47,9 @@ typedef union {
   struct { DrawStyle style; ArcMode mode; float r1; float r2; int segments; } arc;
   struct { float r1; float r2; bool capped; int segments; } cylinder;
   struct { int segments; } sphere;
+  struct { Texture* texture; } skybox;
   struct { float u; float v; float w; float h; } fill;
-  struct { uint32_t rangeStart; uint32_t rangeCount; uint32_t instances; float* pose; } mesh;
+  struct { uint32_t rangeStart; uint32_t rangeCount; uint32_t instances; Buffer* pose; size_t poseOffset; } mesh;
 } BatchParams;
 
 typedef struct {
@@ -68,8 +65,8 @@ typedef struct {
   uint32_t vertexCount;
   uint32_t indexCount;
   float** vertices;
-  uint16_t** indices;
-  uint16_t* baseVertex;
+  uint32_t** indices;
+  uint32_t* baseVertex;
   bool instanced;
 } BatchRequest;
 
@@ -90,8 +87,19 @@ typedef struct {
   float projection[2][16];
 } FrameData;
 
+// A GPU copy of a Blob's vertices, so drawing the same Blob again doesn't upload it again
+typedef struct {
+  Blob* blob;
+  Buffer* buffer;
+  Mesh* mesh;
+  PointFormat format;
+  uint32_t lastUsed;
+} BlobBuffer;
+
 static struct {
   bool initialized;
+  bool shaderCache;
+  bool glyphCache;
   int width;
   int height;
   Camera camera;
@@ -116,14 +124,20 @@ static struct {
   Mesh* mesh;
   Mesh* instancedMesh;
   Buffer* identityBuffer;
+  Buffer* identityPose;
   Buffer* buffers[MAX_STREAMS];
   uint32_t head[MAX_STREAMS];
   uint32_t tail[MAX_STREAMS];
   Batch batches[MAX_BATCHES];
   uint8_t batchCount;
+  BlobBuffer blobBuffers[MAX_BLOB_BUFFERS];
+  uint32_t blobTick;
+  bool profiling;
+  bool passZone;
 } state;
 
-static const uint32_t bufferCount[] = {
+// The vertex and index stream sizes can be changed in conf.lua, see lovrGraphicsInit
+static uint32_t bufferCount[] = {
   [STREAM_VERTEX] = (1 << 16) - 1,
   [STREAM_DRAWID] = (1 << 16) - 1,
   [STREAM_INDEX] = 1 << 16,
@@ -140,12 +154,17 @@ static const uint32_t bufferCount[] = {
 static const size_t bufferStride[] = {
   [STREAM_VERTEX] = 8 * sizeof(float),
   [STREAM_DRAWID] = sizeof(uint8_t),
-  [STREAM_INDEX] = sizeof(uint16_t),
+  [STREAM_INDEX] = sizeof(uint32_t),
   [STREAM_MODEL] = 16 * sizeof(float),
   [STREAM_COLOR] = 4 * sizeof(float),
   [STREAM_FRAME] = sizeof(FrameData)
 };
 
+static const size_t pointFormatStride[] = {
+  [POINT_FORMAT_XYZ] = 3 * sizeof(float),
+  [POINT_FORMAT_XYZRGBA] = 3 * sizeof(float) + 4 * sizeof(uint8_t)
+};
+
 static const BufferType bufferType[] = {
   [STREAM_VERTEX] = BUFFER_VERTEX,
   [STREAM_DRAWID] = BUFFER_GENERIC,
@@ -176,18 +195,26 @@ static void* lovrGraphicsMapBuffer(StreamType type, uint32_t count) {
   lovrAssert(count <= bufferCount[type], "Whoa there!  Tried to get %d elements from a buffer that only has %d elements.", count, bufferCount[type]);
 
   if (state.head[type] + count > bufferCount[type]) {
-    lovrGraphicsFlush();
+    lovrGraphicsFlushWithReason(FLUSH_BUFFER_FULL);
     lovrBufferDiscard(state.buffers[type]);
     state.tail[type] = 0;
     state.head[type] = 0;
   }
 
+  lovrGraphicsGetStats()->bytesMapped[type] += count * bufferStride[type];
   return lovrBufferMap(state.buffers[type], state.head[type] * bufferStride[type]);
 }
 
 // Base
 
-bool lovrGraphicsInit() {
+bool lovrGraphicsInit(bool shaderCache, bool glyphCache, uint32_t vertexCount, uint32_t indexCount) {
+  lovrAssert(vertexCount >= MIN_STREAM_VERTICES, "The vertex stream needs room for at least %d vertices", MIN_STREAM_VERTICES);
+  lovrAssert(indexCount >= MIN_STREAM_INDICES, "The index stream needs room for at least %d indices", MIN_STREAM_INDICES);
+  state.shaderCache = shaderCache;
+  state.glyphCache = glyphCache;
+  bufferCount[STREAM_VERTEX] = vertexCount;
+  bufferCount[STREAM_DRAWID] = vertexCount;
+  bufferCount[STREAM_INDEX] = indexCount;
   return false; // See lovrGraphicsCreateWindow for actual initialization
 }
 
@@ -202,9 +229,15 @@ void lovrGraphicsDestroy() {
   for (int i = 0; i < MAX_STREAMS; i++) {
     lovrRelease(Buffer, state.buffers[i]);
   }
+  for (int i = 0; i < MAX_BLOB_BUFFERS; i++) {
+    lovrRelease(Mesh, state.blobBuffers[i].mesh);
+    lovrRelease(Buffer, state.blobBuffers[i].buffer);
+    lovrRelease(Blob, state.blobBuffers[i].blob);
+  }
   lovrRelease(Mesh, state.mesh);
   lovrRelease(Mesh, state.instancedMesh);
   lovrRelease(Buffer, state.identityBuffer);
+  lovrRelease(Buffer, state.identityPose);
   lovrRelease(Material, state.defaultMaterial);
   lovrRelease(Font, state.defaultFont);
   lovrRelease(Canvas, state.defaultCanvas);
@@ -212,21 +245,49 @@ void lovrGraphicsDestroy() {
   memset(&state, 0, sizeof(state));
 }
 
+// When profiling, every camera pass gets its own timer zone.  User zones are nested around them, so
+// the pass zone is closed and reopened whenever a user zone starts or stops.
+static void beginPassZone() {
+  if (state.profiling && !state.passZone) {
+    lovrGpuTick("pass");
+    state.passZone = true;
+  }
+}
+
+static void endPassZone() {
+  if (state.passZone) {
+    lovrGpuTock("pass");
+    state.passZone = false;
+  }
+}
+
 void lovrGraphicsPresent() {
   lovrGraphicsFlush();
+  endPassZone();
   lovrPlatformSwapBuffers();
   lovrGpuPresent();
+  beginPassZone();
 }
 
 void lovrGraphicsCreateWindow(WindowFlags* flags) {
   lovrAssert(!state.initialized, "Window is already created");
-  lovrAssert(lovrPlatformCreateWindow(flags), "Could not create window");
+  lovrAssert(lovrPlatformCreateWindow(flags), flags->headless ? "Could not create a headless context (EGL or OSMesa is required)" : "Could not create window");
   lovrPlatformOnWindowClose(onCloseWindow);
   lovrPlatformOnWindowResize(onResizeWindow);
   lovrPlatformGetFramebufferSize(&state.width, &state.height);
-  lovrGpuInit(lovrGetProcAddress);
-
-  state.defaultCanvas = lovrCanvasCreateFromHandle(state.width, state.height, (CanvasFlags) { .stereo = false }, 0, 0, 0, 1, true);
+  lovrGpuInit(lovrGetProcAddress, state.shaderCache);
+
+  // Headless contexts don't have a default framebuffer, so they render to a Canvas instead
+  if (flags->headless) {
+    CanvasFlags canvasFlags = { .depth = { .enabled = true, .format = FORMAT_D24S8 }, .msaa = flags->msaa };
+    state.defaultCanvas = lovrCanvasCreate(state.width, state.height, canvasFlags);
+    Texture* texture = lovrTextureCreate(TEXTURE_2D, NULL, 0, true, false, flags->msaa);
+    lovrTextureAllocate(texture, state.width, state.height, 1, FORMAT_RGBA);
+    lovrCanvasSetAttachments(state.defaultCanvas, &(Attachment) { texture, 0, 0 }, 1);
+    lovrRelease(Texture, texture);
+  } else {
+    state.defaultCanvas = lovrCanvasCreateFromHandle(state.width, state.height, (CanvasFlags) { .stereo = false }, 0, 0, 0, 1, true);
+  }
 
   for (int i = 0; i < MAX_STREAMS; i++) {
     state.buffers[i] = lovrBufferCreate(bufferCount[i] * bufferStride[i], NULL, bufferType[i], USAGE_STREAM, false);
@@ -240,6 +301,14 @@ void lovrGraphicsCreateWindow(WindowFlags* flags) {
   lovrBufferFlush(state.identityBuffer, 0, MAX_DRAWS);
   lovrBufferUnmap(state.identityBuffer);
 
+  // The identity pose is bound to lovrPoseBlock for meshes that don't have a skin
+  size_t poseSize = MAX_BONES * 16 * sizeof(float);
+  state.identityPose = lovrBufferCreate(poseSize, NULL, BUFFER_UNIFORM, USAGE_STATIC, false);
+  float* pose = lovrBufferMap(state.identityPose, 0);
+  for (int i = 0; i < MAX_BONES; i++) mat4_identity(pose + 16 * i);
+  lovrBufferFlush(state.identityPose, 0, poseSize);
+  lovrBufferUnmap(state.identityPose);
+
   Buffer* vertexBuffer = state.buffers[STREAM_VERTEX];
   size_t stride = bufferStride[STREAM_VERTEX];
 
@@ -285,7 +354,9 @@ float lovrGraphicsGetPixelDensity() {
 }
 
 void lovrGraphicsSetCamera(Camera* camera, bool clear) {
-  lovrGraphicsFlush();
+  lovrGraphicsFlushWithReason(FLUSH_CAMERA);
+  endPassZone();
+  beginPassZone();
 
   if (state.camera.canvas && (!camera || camera->canvas != state.camera.canvas)) {
     lovrCanvasResolve(state.camera.canvas);
@@ -316,10 +387,57 @@ void lovrGraphicsSetCamera(Camera* camera, bool clear) {
   }
 }
 
+void lovrGraphicsTick(const char* label) {
+  lovrGraphicsFlush();
+  endPassZone();
+  lovrGpuTick(label);
+  beginPassZone();
+}
+
+double lovrGraphicsTock(const char* label) {
+  lovrGraphicsFlush();
+  endPassZone();
+  double time = lovrGpuTock(label);
+  beginPassZone();
+  return time;
+}
+
+bool lovrGraphicsIsProfiling() {
+  return state.profiling;
+}
+
+void lovrGraphicsSetProfiling(bool profiling) {
+  lovrGraphicsFlush();
+  state.profiling = profiling;
+  if (profiling) {
+    beginPassZone();
+  } else {
+    endPassZone();
+  }
+}
+
+// Reads the contents of the window, or the offscreen Canvas used in headless mode
+TextureData* lovrGraphicsNewScreenshot() {
+  lovrGraphicsFlush();
+  return lovrCanvasNewTextureData(state.defaultCanvas, 0, 0, 0, state.width, state.height, FORMAT_RGBA);
+}
+
 Buffer* lovrGraphicsGetIdentityBuffer() {
   return state.identityBuffer;
 }
 
+Shader* lovrGraphicsGetDefaultShader(DefaultShader type) {
+  if (!state.defaultShaders[type]) {
+    state.defaultShaders[type] = lovrShaderCreateDefault(type, NULL, 0);
+  }
+
+  return state.defaultShaders[type];
+}
+
+bool lovrGraphicsIsGlyphCacheEnabled() {
+  return state.glyphCache;
+}
+
 // State
 
 void lovrGraphicsReset() {
@@ -425,7 +543,7 @@ Font* lovrGraphicsGetFont() {
   if (!state.font) {
     if (!state.defaultFont) {
       Rasterizer* rasterizer = lovrRasterizerCreate(NULL, 32);
-      state.defaultFont = lovrFontCreate(rasterizer);
+      state.defaultFont = lovrFontCreate(rasterizer, state.glyphCache);
       lovrRelease(Rasterizer, rasterizer);
     }
 
@@ -463,6 +581,7 @@ Shader* lovrGraphicsGetShader() {
 
 void lovrGraphicsSetShader(Shader* shader) {
   lovrAssert(!shader || lovrShaderGetType(shader) == SHADER_GRAPHICS, "Compute shaders can not be set as the active shader");
+  lovrAssert(!shader || !lovrShaderGetError(shader), "%s", lovrShaderGetError(shader));
   lovrRetain(shader);
   lovrRelease(Shader, state.shader);
   state.shader = shader;
@@ -527,8 +646,38 @@ void lovrGraphicsMatrixTransform(mat4 transform) {
   mat4_multiply(state.transforms[state.transform], transform);
 }
 
+// Returns how many pixels one unit in the local space of a transform covers at the point of a
+// bounding sphere nearest the camera.  Levels of detail use it, so the first view stands in for
+// both eyes.
+float lovrGraphicsGetPixelScale(mat4 transform, float center[3], float radius) {
+  float m[16];
+  mat4_multiply(mat4_init(m, state.camera.viewMatrix[0]), state.transforms[state.transform]);
+  mat4_multiply(m, transform);
+
+  float sx = vec3_length(m + 0);
+  float sy = vec3_length(m + 4);
+  float sz = vec3_length(m + 8);
+  float scale = MAX(sx, sy);
+  scale = MAX(scale, sz);
+
+  Canvas* canvas = state.canvas ? state.canvas : state.camera.canvas;
+  float height = canvas ? lovrCanvasGetHeight(canvas) : state.height;
+  float* projection = state.camera.projection[0];
+  float pixels = projection[5] * height * .5f * scale;
+
+  // Perspective projections shrink things with distance, orthographic ones don't
+  if (projection[15] == 0.f) {
+    float p[4] = { center[0], center[1], center[2], 1.f };
+    mat4_transform(m, p);
+    float distance = vec3_length(p) - radius * scale;
+    pixels /= MAX(distance, .001f);
+  }
+
+  return pixels;
+}
+
 void lovrGraphicsSetProjection(mat4 projection) {
-  lovrGraphicsFlush();
+  lovrGraphicsFlushWithReason(FLUSH_CAMERA);
   mat4_set(state.camera.projection[0], projection);
   mat4_set(state.camera.projection[1], projection);
   mat4_set(state.frameData.projection[0], projection);
@@ -543,30 +692,20 @@ static void lovrGraphicsBatch(BatchRequest* req) {
   // Resolve objects
   Mesh* mesh = req->mesh ? req->mesh : (req->instanced ? state.instancedMesh : state.mesh);
   Canvas* canvas = state.canvas ? state.canvas : state.camera.canvas;
-  Shader* shader = state.shader ? state.shader : (state.defaultShaders[req->shader] ? state.defaultShaders[req->shader] : (state.defaultShaders[req->shader] = lovrShaderCreateDefault(req->shader, NULL, 0)));
+  Shader* shader = state.shader ? state.shader : lovrGraphicsGetDefaultShader(req->shader);
   Pipeline* pipeline = req->pipeline ? req->pipeline : &state.pipeline;
   Material* material = req->material ? req->material : (state.defaultMaterial ? state.defaultMaterial : (state.defaultMaterial = lovrMaterialCreate()));
 
   if (!req->material) {
-    if (req->type == BATCH_SKYBOX && lovrTextureGetType(req->texture) == TEXTURE_CUBE) {
-      lovrShaderSetTextures(shader, "lovrSkyboxTexture", &req->texture, 0, 1);
-    } else {
+    if (req->type != BATCH_SKYBOX || !req->params.skybox.texture) {
       lovrMaterialSetTexture(material, TEXTURE_DIFFUSE, req->texture);
     }
   }
 
-  if (req->type == BATCH_MESH && lovrShaderHasUniform(shader, "lovrPose")) {
-    if (req->params.mesh.pose) {
-      lovrShaderSetMatrices(shader, "lovrPose", req->params.mesh.pose, 0, MAX_BONES * 16);
-    } else {
-      lovrShaderSetMatrices(shader, "lovrPose", (float[]) MAT4_IDENTITY, 0, 16);
-    }
-  }
-
   // Try to find an existing batch to use
   Batch* batch = NULL;
   for (int i = state.batchCount - 1; i >= 0; i--) {
-    if (req->type == BATCH_MESH && req->params.mesh.instances > 1) { break; }
+    if (req->type == BATCH_MESH && !req->instanced) { break; }
 
     Batch* b = &state.batches[i];
     if (b->type != req->type) { goto next; }
@@ -604,22 +743,27 @@ next:
   }
 
   // Start a new batch
-  if (!batch || state.batchCount == 0) {
+  if (batch && state.batchCount > 0) {
+    lovrGraphicsGetStats()->batchesMerged++;
+  } else {
     if (state.batchCount >= MAX_BATCHES) {
-      lovrGraphicsFlush();
+      lovrGraphicsFlushWithReason(FLUSH_BATCH_LIMIT);
     }
 
     float* transforms = lovrGraphicsMapBuffer(STREAM_MODEL, MAX_DRAWS);
     Color* colors = lovrGraphicsMapBuffer(STREAM_COLOR, MAX_DRAWS);
 
-    uint32_t rangeStart, rangeCount, instances;
+    // Indexed meshes report all of their vertices, since the range doesn't say which ones are used
+    uint32_t rangeStart, rangeCount, vertexCount, instances;
     if (req->type == BATCH_MESH) {
       rangeStart = req->params.mesh.rangeStart;
       rangeCount = req->params.mesh.rangeCount;
+      vertexCount = mesh->indexCount > 0 ? lovrMeshGetVertexCount(mesh) : 0;
       instances = req->instanced ? 0 : req->params.mesh.instances;
     } else {
       rangeStart = req->indexCount > 0 ? state.head[STREAM_INDEX] : state.head[STREAM_VERTEX];
       rangeCount = 0;
+      vertexCount = 0;
       instances = 0;
     }
 
@@ -635,6 +779,7 @@ next:
         .topology = req->topology,
         .rangeStart = rangeStart,
         .rangeCount = rangeCount,
+        .vertexCount = vertexCount,
         .instances = instances
       },
       .material = material,
@@ -667,6 +812,7 @@ next:
     }
 
     batch->draw.rangeCount += batch->indexed ? req->indexCount : req->vertexCount;
+    batch->draw.vertexCount += req->vertexCount;
     state.head[STREAM_VERTEX] += req->vertexCount;
     state.head[STREAM_DRAWID] += req->vertexCount;
     state.head[STREAM_INDEX] += req->indexCount;
@@ -680,10 +826,21 @@ next:
 }
 
 void lovrGraphicsFlush() {
+  lovrGraphicsFlushWithReason(FLUSH_EXPLICIT);
+}
+
+void lovrGraphicsFlushWithReason(FlushReason reason) {
   if (state.batchCount == 0) {
     return;
   }
 
+  GpuStats* stats = lovrGraphicsGetStats();
+  stats->flushes[reason]++;
+
+  if (state.profiling) {
+    lovrGpuTick("flush");
+  }
+
   // Prevent infinite flushing >_>
   int batchCount = state.batchCount;
   state.batchCount = 0;
@@ -697,6 +854,7 @@ void lovrGraphicsFlush() {
 
   // Flush buffers
   for (int i = 0; i < MAX_STREAMS; i++) {
+    stats->bytesFlushed[i] += (state.head[i] - state.tail[i]) * bufferStride[i];
     lovrBufferFlush(state.buffers[i], state.tail[i] * bufferStride[i], (state.head[i] - state.tail[i]) * bufferStride[i]);
     lovrBufferUnmap(state.buffers[i]);
     state.tail[i] = state.head[i];
@@ -705,6 +863,15 @@ void lovrGraphicsFlush() {
   for (int b = 0; b < batchCount; b++) {
     Batch* batch = &state.batches[b];
 
+    // Shaders that are still compiling draw with their fallback, or get skipped
+    if (!lovrShaderIsReady(batch->draw.shader)) {
+      Shader* fallback = lovrShaderGetFallback(batch->draw.shader);
+      if (!fallback || !lovrShaderIsReady(fallback)) {
+        continue;
+      }
+      batch->draw.shader = fallback;
+    }
+
     // Uniforms
     lovrMaterialBind(batch->material, batch->draw.shader);
     lovrShaderSetBlock(batch->draw.shader, "lovrModelBlock", state.buffers[STREAM_MODEL], batch->drawStart * bufferStride[STREAM_MODEL], MAX_DRAWS * bufferStride[STREAM_MODEL], ACCESS_READ);
@@ -714,6 +881,17 @@ void lovrGraphicsFlush() {
       lovrShaderSetFloats(batch->draw.shader, "lovrPointSize", &state.pointSize, 0, 1);
     }
 
+    // Cube skyboxes set their texture here, since the shader may have still been compiling earlier
+    if (batch->type == BATCH_SKYBOX && batch->params.skybox.texture) {
+      lovrShaderSetTextures(batch->draw.shader, "lovrSkyboxTexture", &batch->params.skybox.texture, 0, 1);
+    }
+
+    if (batch->type == BATCH_MESH && batch->params.mesh.pose) {
+      lovrShaderSetBlock(batch->draw.shader, "lovrPoseBlock", batch->params.mesh.pose, batch->params.mesh.poseOffset, MAX_BONES * 16 * sizeof(float), ACCESS_READ);
+    } else {
+      lovrShaderSetBlock(batch->draw.shader, "lovrPoseBlock", state.identityPose, 0, MAX_BONES * 16 * sizeof(float), ACCESS_READ);
+    }
+
     // Other bindings (TODO try to get rid of all this!)
     if (batch->type == BATCH_MESH) {
       lovrMeshSetAttributeEnabled(batch->draw.mesh, "lovrDrawID", batch->params.mesh.instances <= 1);
@@ -723,7 +901,7 @@ void lovrGraphicsFlush() {
       }
 
       if (batch->indexed) {
-        lovrMeshSetIndexBuffer(batch->draw.mesh, state.buffers[STREAM_INDEX], bufferCount[STREAM_INDEX], sizeof(uint16_t), 0);
+        lovrMeshSetIndexBuffer(batch->draw.mesh, state.buffers[STREAM_INDEX], bufferCount[STREAM_INDEX], sizeof(uint32_t), 0);
       } else {
         lovrMeshSetIndexBuffer(batch->draw.mesh, NULL, 0, 0, 0);
       }
@@ -731,12 +909,16 @@ void lovrGraphicsFlush() {
 
     lovrGpuDraw(&batch->draw);
   }
+
+  if (state.profiling) {
+    lovrGpuTock("flush");
+  }
 }
 
 void lovrGraphicsFlushCanvas(Canvas* canvas) {
   for (int i = state.batchCount - 1; i >= 0; i--) {
     if (state.batches[i].draw.canvas == canvas) {
-      lovrGraphicsFlush();
+      lovrGraphicsFlushWithReason(FLUSH_CANVAS);
       return;
     }
   }
@@ -745,7 +927,7 @@ void lovrGraphicsFlushCanvas(Canvas* canvas) {
 void lovrGraphicsFlushShader(Shader* shader) {
   for (int i = state.batchCount - 1; i >= 0; i--) {
     if (state.batches[i].draw.shader == shader) {
-      lovrGraphicsFlush();
+      lovrGraphicsFlushWithReason(FLUSH_RESOURCE);
       return;
     }
   }
@@ -754,7 +936,16 @@ void lovrGraphicsFlushShader(Shader* shader) {
 void lovrGraphicsFlushMaterial(Material* material) {
   for (int i = state.batchCount - 1; i >= 0; i--) {
     if (state.batches[i].material == material) {
-      lovrGraphicsFlush();
+      lovrGraphicsFlushWithReason(FLUSH_RESOURCE);
+      return;
+    }
+  }
+}
+
+void lovrGraphicsFlushBuffer(Buffer* buffer) {
+  for (int i = state.batchCount - 1; i >= 0; i--) {
+    if (state.batches[i].type == BATCH_MESH && state.batches[i].params.mesh.pose == buffer) {
+      lovrGraphicsFlushWithReason(FLUSH_RESOURCE);
       return;
     }
   }
@@ -763,7 +954,7 @@ void lovrGraphicsFlushMaterial(Material* material) {
 void lovrGraphicsFlushMesh(Mesh* mesh) {
   for (int i = state.batchCount - 1; i >= 0; i--) {
     if (state.batches[i].draw.mesh == mesh) {
-      lovrGraphicsFlush();
+      lovrGraphicsFlushWithReason(FLUSH_RESOURCE);
       return;
     }
   }
@@ -782,19 +973,28 @@ void lovrGraphicsDiscard(bool color, bool depth, bool stencil) {
   lovrGpuDiscard(state.canvas ? state.canvas : state.camera.canvas, color, depth, stencil);
 }
 
-void lovrGraphicsPoints(uint32_t count, float** vertices) {
+// Points, lines, and triangles can have more vertices than the streams can hold.  These map as many
+// of the vertices as will fit and return how many that was, and callers draw the rest by calling
+// them again, which flushes the streams in between.  Lines return a chunk that ends on a vertex
+// the next chunk has to start on, so there aren't gaps in the line.
+uint32_t lovrGraphicsPoints(uint32_t count, float** vertices) {
+  count = MIN(count, bufferCount[STREAM_VERTEX]);
+
   lovrGraphicsBatch(&(BatchRequest) {
     .type = BATCH_POINTS,
     .topology = DRAW_POINTS,
     .vertexCount = count,
     .vertices = vertices
   });
+
+  return count;
 }
 
-void lovrGraphicsLine(uint32_t count, float** vertices) {
+uint32_t lovrGraphicsLine(uint32_t count, float** vertices) {
+  count = MIN(count, MIN(bufferCount[STREAM_VERTEX], bufferCount[STREAM_INDEX] - 1));
   uint32_t indexCount = count + 1;
-  uint16_t* indices;
-  uint16_t baseVertex;
+  uint32_t* indices;
+  uint32_t baseVertex;
 
   lovrGraphicsBatch(&(BatchRequest) {
     .type = BATCH_LINES,
@@ -806,16 +1006,20 @@ void lovrGraphicsLine(uint32_t count, float** vertices) {
     .baseVertex = &baseVertex
   });
 
-  indices[0] = 0xffff;
+  indices[0] = 0xffffffff;
   for (uint32_t i = 1; i < indexCount; i++) {
     indices[i] = baseVertex + i - 1;
   }
+
+  return count;
 }
 
-void lovrGraphicsTriangle(DrawStyle style, Material* material, uint32_t count, float** vertices) {
+uint32_t lovrGraphicsTriangle(DrawStyle style, Material* material, uint32_t count, float** vertices) {
+  uint32_t limit = style == STYLE_LINE ? MIN(bufferCount[STREAM_VERTEX], bufferCount[STREAM_INDEX] / 4 * 3) : bufferCount[STREAM_VERTEX];
+  count = MIN(count, limit - limit % 3);
   uint32_t indexCount = style == STYLE_LINE ? (4 * count / 3) : 0;
-  uint16_t* indices;
-  uint16_t baseVertex;
+  uint32_t* indices;
+  uint32_t baseVertex;
 
   lovrGraphicsBatch(&(BatchRequest) {
     .type = BATCH_TRIANGLES,
@@ -831,18 +1035,20 @@ void lovrGraphicsTriangle(DrawStyle style, Material* material, uint32_t count, f
 
   if (style == STYLE_LINE) {
     for (uint32_t i = 0; i < count; i += 3) {
-      *indices++ = 0xffff;
+      *indices++ = 0xffffffff;
       *indices++ = baseVertex + i + 0;
       *indices++ = baseVertex + i + 1;
       *indices++ = baseVertex + i + 2;
     }
   }
+
+  return count;
 }
 
 void lovrGraphicsPlane(DrawStyle style, Material* material, mat4 transform, float u, float v, float w, float h) {
   float* vertices = NULL;
-  uint16_t* indices = NULL;
-  uint16_t baseVertex;
+  uint32_t* indices = NULL;
+  uint32_t baseVertex;
 
   lovrGraphicsBatch(&(BatchRequest) {
     .type = BATCH_PLANE,
@@ -867,7 +1073,7 @@ void lovrGraphicsPlane(DrawStyle style, Material* material, mat4 transform, floa
 
     memcpy(vertices, vertexData, sizeof(vertexData));
 
-    indices[0] = 0xffff;
+    indices[0] = 0xffffffff;
     indices[1] = 0 + baseVertex;
     indices[2] = 1 + baseVertex;
     indices[3] = 2 + baseVertex;
@@ -882,7 +1088,7 @@ void lovrGraphicsPlane(DrawStyle style, Material* material, mat4 transform, floa
 
     memcpy(vertices, vertexData, sizeof(vertexData));
 
-    static uint16_t indexData[] = { 0, 1, 2, 2, 1, 3 };
+    static uint32_t indexData[] = { 0, 1, 2, 2, 1, 3 };
 
     for (size_t i = 0; i < sizeof(indexData) / sizeof(indexData[0]); i++) {
       indices[i] = indexData[i] + baseVertex;
@@ -892,8 +1098,8 @@ void lovrGraphicsPlane(DrawStyle style, Material* material, mat4 transform, floa
 
 void lovrGraphicsBox(DrawStyle style, Material* material, mat4 transform) {
   float* vertices = NULL;
-  uint16_t* indices = NULL;
-  uint16_t baseVertex;
+  uint32_t* indices = NULL;
+  uint32_t baseVertex;
 
   lovrGraphicsBatch(&(BatchRequest) {
     .type = BATCH_BOX,
@@ -924,7 +1130,7 @@ void lovrGraphicsBox(DrawStyle style, Material* material, mat4 transform) {
 
       memcpy(vertices, vertexData, sizeof(vertexData));
 
-      static uint16_t indexData[] = {
+      static uint32_t indexData[] = {
         0, 1, 1, 2, 2, 3, 3, 0, // Front
         4, 5, 5, 6, 6, 7, 7, 4, // Back
         0, 4, 1, 5, 2, 6, 3, 7  // Connections
@@ -963,7 +1169,7 @@ void lovrGraphicsBox(DrawStyle style, Material* material, mat4 transform) {
 
       memcpy(vertices, vertexData, sizeof(vertexData));
 
-      uint16_t indexData[] = {
+      uint32_t indexData[] = {
         0,  1,   2,  2,  1,  3,
         4,  5,   6,  6,  5,  7,
         8,  9,  10, 10,  9, 11,
@@ -1038,8 +1244,8 @@ void lovrGraphicsCylinder(Material* material, mat4 transform, float r1, float r2
   uint32_t vertexCount = ((capped && r1) * (segments + 2) + (capped && r2) * (segments + 2) + 2 * (segments + 1));
   uint32_t indexCount = 3 * segments * ((capped && r1) + (capped && r2) + 2);
   float* vertices = NULL;
-  uint16_t* indices = NULL;
-  uint16_t baseVertex;
+  uint32_t* indices = NULL;
+  uint32_t baseVertex;
 
   lovrGraphicsBatch(&(BatchRequest) {
     .type = BATCH_CYLINDER,
@@ -1100,16 +1306,16 @@ void lovrGraphicsCylinder(Material* material, mat4 transform, float r1, float r2
     // Indices
     for (int i = 0; i < segments; i++) {
       int j = 2 * i + baseVertex;
-      memcpy(indices, (uint16_t[6]) { j, j + 2, j + 1, j + 1, j + 2, j + 3 }, 6 * sizeof(uint16_t));
+      memcpy(indices, (uint32_t[6]) { j, j + 2, j + 1, j + 1, j + 2, j + 3 }, 6 * sizeof(uint32_t));
       indices += 6;
 
       if (capped && r1 != 0.f) {
-        memcpy(indices, (uint16_t[3]) { top, top + i + 2, top + i + 1 }, 3 * sizeof(uint16_t));
+        memcpy(indices, (uint32_t[3]) { top, top + i + 2, top + i + 1 }, 3 * sizeof(uint32_t));
         indices += 3;
       }
 
       if (capped && r2 != 0.f) {
-        memcpy(indices, (uint16_t[3]) { bot, bot + i + 1, bot + i + 2 }, 3 * sizeof(uint16_t));
+        memcpy(indices, (uint32_t[3]) { bot, bot + i + 1, bot + i + 2 }, 3 * sizeof(uint32_t));
         indices += 3;
       }
     }
@@ -1118,8 +1324,8 @@ void lovrGraphicsCylinder(Material* material, mat4 transform, float r1, float r2
 
 void lovrGraphicsSphere(Material* material, mat4 transform, int segments) {
   float* vertices = NULL;
-  uint16_t* indices = NULL;
-  uint16_t baseVertex;
+  uint32_t* indices = NULL;
+  uint32_t baseVertex;
 
   lovrGraphicsBatch(&(BatchRequest) {
     .type = BATCH_SPHERE,
@@ -1151,12 +1357,12 @@ void lovrGraphicsSphere(Material* material, mat4 transform, int segments) {
     }
 
     for (int i = 0; i < segments; i++) {
-      uint16_t offset0 = i * (segments + 1) + baseVertex;
-      uint16_t offset1 = (i + 1) * (segments + 1) + baseVertex;
+      uint32_t offset0 = i * (segments + 1) + baseVertex;
+      uint32_t offset1 = (i + 1) * (segments + 1) + baseVertex;
       for (int j = 0; j < segments; j++) {
-        uint16_t i0 = offset0 + j;
-        uint16_t i1 = offset1 + j;
-        memcpy(indices, ((uint16_t[]) { i0, i0 + 1, i1, i1, i0 + 1, i1 + 1 }), 6 * sizeof(uint16_t));
+        uint32_t i0 = offset0 + j;
+        uint32_t i1 = offset1 + j;
+        memcpy(indices, ((uint32_t[]) { i0, i0 + 1, i1, i1, i0 + 1, i1 + 1 }), 6 * sizeof(uint32_t));
         indices += 6;
       }
     }
@@ -1174,6 +1380,7 @@ void lovrGraphicsSkybox(Texture* texture) {
 
   lovrGraphicsBatch(&(BatchRequest) {
     .type = BATCH_SKYBOX,
+    .params.skybox.texture = type == TEXTURE_CUBE ? texture : NULL,
     .topology = DRAW_TRIANGLE_STRIP,
     .shader = type == TEXTURE_CUBE ? SHADER_CUBE : SHADER_PANO,
     .pipeline = &pipeline,
@@ -1211,8 +1418,8 @@ void lovrGraphicsPrint(const char* str, size_t length, mat4 transform, float wra
   pipeline.blendMode = pipeline.blendMode == BLEND_NONE ? BLEND_ALPHA : pipeline.blendMode;
 
   float* vertices;
-  uint16_t* indices;
-  uint16_t baseVertex;
+  uint32_t* indices;
+  uint32_t baseVertex;
   lovrGraphicsBatch(&(BatchRequest) {
     .type = BATCH_TEXT,
     .topology = DRAW_TRIANGLES,
@@ -1230,6 +1437,58 @@ void lovrGraphicsPrint(const char* str, size_t length, mat4 transform, float wra
   lovrFontRender(font, str, length, wrap, halign, vertices, indices, baseVertex);
 }
 
+void lovrGraphicsDrawText(Text* text, mat4 transform) {
+  Mesh* mesh = lovrTextGetMesh(text);
+  if (!mesh) {
+    return;
+  }
+
+  Font* font = lovrTextGetFont(text);
+  float scale = 1.f / font->pixelDensity;
+  float offsetY = ((text->lineCount + 1) * font->rasterizer->height * font->lineHeight) * (text->valign / 2.f) * (font->flip ? -1 : 1);
+  mat4_scale(transform, scale, scale, scale);
+  mat4_translate(transform, 0.f, offsetY, 0.f);
+
+  Pipeline pipeline = state.pipeline;
+  pipeline.blendMode = pipeline.blendMode == BLEND_NONE ? BLEND_ALPHA : pipeline.blendMode;
+
+  lovrGraphicsBatch(&(BatchRequest) {
+    .type = BATCH_MESH,
+    .params.mesh.rangeStart = 0,
+    .params.mesh.rangeCount = text->glyphCount * 6,
+    .params.mesh.instances = 1,
+    .mesh = mesh,
+    .topology = DRAW_TRIANGLES,
+    .shader = SHADER_FONT,
+    .pipeline = &pipeline,
+    .transform = transform,
+    .texture = font->texture,
+    .instanced = true
+  });
+}
+
+// Sprites are per-instance attributes, so the whole batch is one instanced draw that never merges
+// with other draws (merged draws would read the wrong instances)
+void lovrGraphicsDrawSpriteBatch(SpriteBatch* batch, mat4 transform) {
+  uint32_t count = lovrSpriteBatchGetCount(batch);
+  if (count == 0) {
+    return;
+  }
+
+  lovrGraphicsBatch(&(BatchRequest) {
+    .type = BATCH_MESH,
+    .params.mesh.rangeStart = 0,
+    .params.mesh.rangeCount = 4,
+    .params.mesh.instances = count,
+    .mesh = lovrSpriteBatchGetMesh(batch),
+    .topology = DRAW_TRIANGLE_STRIP,
+    .shader = SHADER_SPRITE,
+    .transform = transform,
+    .texture = lovrSpriteBatchGetTexture(batch),
+    .instanced = false
+  });
+}
+
 void lovrGraphicsFill(Texture* texture, float u, float v, float w, float h) {
   Pipeline pipeline = state.pipeline;
   pipeline.depthTest = COMPARE_NONE;
@@ -1258,7 +1517,7 @@ void lovrGraphicsFill(Texture* texture, float u, float v, float w, float h) {
   }
 }
 
-void lovrGraphicsDrawMesh(Mesh* mesh, mat4 transform, uint32_t instances, float* pose) {
+void lovrGraphicsDrawMesh(Mesh* mesh, mat4 transform, uint32_t instances, Buffer* pose, size_t poseOffset) {
   uint32_t vertexCount = lovrMeshGetVertexCount(mesh);
   uint32_t indexCount = lovrMeshGetIndexCount(mesh);
   uint32_t defaultCount = indexCount > 0 ? indexCount : vertexCount;
@@ -1274,6 +1533,7 @@ void lovrGraphicsDrawMesh(Mesh* mesh, mat4 transform, uint32_t instances, float*
     .params.mesh.rangeCount = rangeCount,
     .params.mesh.instances = instances,
     .params.mesh.pose = pose,
+    .params.mesh.poseOffset = poseOffset,
     .mesh = mesh,
     .topology = mode,
     .transform = transform,
@@ -1281,3 +1541,84 @@ void lovrGraphicsDrawMesh(Mesh* mesh, mat4 transform, uint32_t instances, float*
     .instanced = instances <= 1
   });
 }
+
+static void lovrGraphicsSetBlobFormat(BlobBuffer* entry, PointFormat format) {
+  size_t stride = pointFormatStride[format];
+  uint32_t vertexCount = (uint32_t) (entry->blob->size / stride);
+  lovrRelease(Mesh, entry->mesh);
+  entry->format = format;
+  entry->mesh = lovrMeshCreate(DRAW_POINTS, entry->buffer, vertexCount);
+  lovrMeshAttachAttribute(entry->mesh, "lovrPosition", &(MeshAttribute) { .buffer = entry->buffer, .stride = stride, .type = F32, .components = 3 });
+  lovrMeshAttachAttribute(entry->mesh, "lovrDrawID", &(MeshAttribute) { .buffer = state.identityBuffer, .type = U8, .components = 1, .divisor = 1, .integer = true });
+  if (format == POINT_FORMAT_XYZRGBA) {
+    lovrMeshAttachAttribute(entry->mesh, "lovrVertexColor", &(MeshAttribute) { .buffer = entry->buffer, .offset = 12, .stride = stride, .type = U8, .components = 4, .normalized = true });
+  }
+}
+
+// Finds the GPU copy of a Blob, uploading the Blob into the least recently used slot if there
+// isn't one.  Blobs are retained while they're cached so their address can't get reused.
+static BlobBuffer* lovrGraphicsGetBlobBuffer(Blob* blob, PointFormat format) {
+  BlobBuffer* entry = NULL;
+  for (int i = 0; i < MAX_BLOB_BUFFERS; i++) {
+    if (state.blobBuffers[i].blob == blob) {
+      entry = &state.blobBuffers[i];
+      break;
+    } else if (!entry || state.blobBuffers[i].lastUsed < entry->lastUsed) {
+      entry = &state.blobBuffers[i];
+    }
+  }
+
+  if (entry->blob != blob) {
+    lovrRelease(Mesh, entry->mesh);
+    lovrRelease(Buffer, entry->buffer);
+    lovrRelease(Blob, entry->blob);
+    lovrRetain(blob);
+    entry->blob = blob;
+    entry->buffer = lovrBufferCreate(blob->size, blob->data, BUFFER_VERTEX, USAGE_DYNAMIC, false);
+    entry->mesh = NULL;
+  }
+
+  if (!entry->mesh || entry->format != format) {
+    lovrGraphicsSetBlobFormat(entry, format);
+  }
+
+  entry->lastUsed = ++state.blobTick;
+  return entry;
+}
+
+// Draws vertices straight from a Blob, without copying them into the vertex stream.  start and
+// count are in vertices, and a count of 0 draws the rest of the Blob.
+void lovrGraphicsDrawBlob(Blob* blob, PointFormat format, DrawMode mode, uint32_t start, uint32_t count) {
+  uint32_t vertexCount = (uint32_t) (blob->size / pointFormatStride[format]);
+  lovrAssert(start < vertexCount, "Invalid start vertex %d, the Blob only has %d vertices", start + 1, vertexCount);
+  count = count > 0 ? count : vertexCount - start;
+  lovrAssert(start + count <= vertexCount, "Trying to draw more vertices than the Blob has");
+  BlobBuffer* entry = lovrGraphicsGetBlobBuffer(blob, format);
+
+  lovrGraphicsBatch(&(BatchRequest) {
+    .type = BATCH_MESH,
+    .params.mesh.rangeStart = start,
+    .params.mesh.rangeCount = count,
+    .params.mesh.instances = 1,
+    .mesh = entry->mesh,
+    .topology = mode,
+    .instanced = true
+  });
+}
+
+// Copies a range of a Blob that changed to its GPU copy.  Blobs that aren't cached are uploaded in
+// full the next time they're drawn, so there's nothing to do for them.
+void lovrGraphicsUpdateBlob(Blob* blob, size_t offset, size_t size) {
+  lovrAssert(offset + size <= blob->size, "Tried to update past the end of the Blob");
+  for (int i = 0; i < MAX_BLOB_BUFFERS; i++) {
+    BlobBuffer* entry = &state.blobBuffers[i];
+    if (entry->blob == blob && size > 0) {
+      lovrGraphicsFlushMesh(entry->mesh);
+      void* data = lovrBufferMap(entry->buffer, offset);
+      memcpy(data, (uint8_t*) blob->data + offset, size);
+      lovrBufferFlush(entry->buffer, offset, size);
+      lovrBufferUnmap(entry->buffer);
+      return;
+    }
+  }
+}
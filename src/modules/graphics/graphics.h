@@ -1,4 +1,5 @@
 #include "graphics/font.h"
+#include "graphics/shader.h"
 #include "data/modelData.h"
 #include "core/maf.h"
 #include "util.h"
@@ -8,12 +9,15 @@
 
 #pragma once
 
+struct Blob;
 struct Buffer;
 struct Canvas;
 struct Font;
 struct Material;
 struct Mesh;
 struct Shader;
+struct SpriteBatch;
+struct Text;
 struct Texture;
 
 typedef void (*StencilCallback)(void* userdata);
@@ -55,6 +59,22 @@ typedef enum {
   STYLE_LINE
 } DrawStyle;
 
+typedef enum {
+  FLUSH_BATCH_LIMIT,
+  FLUSH_BUFFER_FULL,
+  FLUSH_CAMERA,
+  FLUSH_CANVAS,
+  FLUSH_RESOURCE,
+  FLUSH_EXPLICIT,
+  FLUSH_STATS,
+  MAX_FLUSH_REASONS
+} FlushReason;
+
+typedef enum {
+  POINT_FORMAT_XYZ,
+  POINT_FORMAT_XYZRGBA
+} PointFormat;
+
 typedef enum {
   STENCIL_REPLACE,
   STENCIL_INCREMENT,
@@ -64,6 +84,16 @@ typedef enum {
   STENCIL_INVERT
 } StencilAction;
 
+typedef enum {
+  STREAM_VERTEX,
+  STREAM_DRAWID,
+  STREAM_INDEX,
+  STREAM_MODEL,
+  STREAM_COLOR,
+  STREAM_FRAME,
+  MAX_STREAMS
+} StreamType;
+
 typedef enum {
   WINDING_CLOCKWISE,
   WINDING_COUNTERCLOCKWISE
@@ -91,7 +121,7 @@ typedef struct {
 } Pipeline;
 
 // Base
-bool lovrGraphicsInit();
+bool lovrGraphicsInit(bool shaderCache, bool glyphCache, uint32_t vertexCount, uint32_t indexCount);
 void lovrGraphicsDestroy(void);
 void lovrGraphicsPresent(void);
 void lovrGraphicsCreateWindow(WindowFlags* flags);
@@ -99,12 +129,22 @@ int lovrGraphicsGetWidth(void);
 int lovrGraphicsGetHeight(void);
 float lovrGraphicsGetPixelDensity(void);
 void lovrGraphicsSetCamera(Camera* camera, bool clear);
+struct TextureData* lovrGraphicsNewScreenshot(void);
 struct Buffer* lovrGraphicsGetIdentityBuffer(void);
-#define lovrGraphicsTick lovrGpuTick
-#define lovrGraphicsTock lovrGpuTock
+struct Shader* lovrGraphicsGetDefaultShader(DefaultShader type);
+bool lovrGraphicsIsGlyphCacheEnabled(void);
+void lovrGraphicsTick(const char* label);
+double lovrGraphicsTock(const char* label);
+bool lovrGraphicsIsProfiling(void);
+void lovrGraphicsSetProfiling(bool profiling);
+#define lovrGraphicsGetZoneCount lovrGpuGetZoneCount
+#define lovrGraphicsGetZoneStats lovrGpuGetZoneStats
 #define lovrGraphicsGetFeatures lovrGpuGetFeatures
 #define lovrGraphicsGetLimits lovrGpuGetLimits
 #define lovrGraphicsGetStats lovrGpuGetStats
+#define lovrGraphicsGetStatsHistory lovrGpuGetStatsHistory
+#define lovrGraphicsGetTextureStreamBudget lovrGpuGetTextureStreamBudget
+#define lovrGraphicsSetTextureStreamBudget lovrGpuSetTextureStreamBudget
 
 // State
 void lovrGraphicsReset(void);
@@ -148,18 +188,21 @@ void lovrGraphicsRotate(quat rotation);
 void lovrGraphicsScale(vec3 scale);
 void lovrGraphicsMatrixTransform(mat4 transform);
 void lovrGraphicsSetProjection(mat4 projection);
+float lovrGraphicsGetPixelScale(mat4 transform, float center[3], float radius);
 
 // Rendering
 void lovrGraphicsFlush(void);
+void lovrGraphicsFlushWithReason(FlushReason reason);
 void lovrGraphicsFlushCanvas(struct Canvas* canvas);
 void lovrGraphicsFlushShader(struct Shader* shader);
 void lovrGraphicsFlushMaterial(struct Material* material);
+void lovrGraphicsFlushBuffer(struct Buffer* buffer);
 void lovrGraphicsFlushMesh(struct Mesh* mesh);
 void lovrGraphicsClear(Color* color, float* depth, int* stencil);
 void lovrGraphicsDiscard(bool color, bool depth, bool stencil);
-void lovrGraphicsPoints(uint32_t count, float** vertices);
-void lovrGraphicsLine(uint32_t count, float** vertices);
-void lovrGraphicsTriangle(DrawStyle style, struct Material* material, uint32_t count, float** vertices);
+uint32_t lovrGraphicsPoints(uint32_t count, float** vertices);
+uint32_t lovrGraphicsLine(uint32_t count, float** vertices);
+uint32_t lovrGraphicsTriangle(DrawStyle style, struct Material* material, uint32_t count, float** vertices);
 void lovrGraphicsPlane(DrawStyle style, struct Material* material, mat4 transform, float u, float v, float w, float h);
 void lovrGraphicsBox(DrawStyle style, struct Material* material, mat4 transform);
 void lovrGraphicsArc(DrawStyle style, ArcMode mode, struct Material* material, mat4 transform, float r1, float r2, int segments);
@@ -168,8 +211,12 @@ void lovrGraphicsCylinder(struct Material* material, mat4 transform, float r1, f
 void lovrGraphicsSphere(struct Material* material, mat4 transform, int segments);
 void lovrGraphicsSkybox(struct Texture* texture);
 void lovrGraphicsPrint(const char* str, size_t length, mat4 transform, float wrap, HorizontalAlign halign, VerticalAlign valign);
+void lovrGraphicsDrawText(struct Text* text, mat4 transform);
+void lovrGraphicsDrawSpriteBatch(struct SpriteBatch* batch, mat4 transform);
 void lovrGraphicsFill(struct Texture* texture, float u, float v, float w, float h);
-void lovrGraphicsDrawMesh(struct Mesh* mesh, mat4 transform, uint32_t instances, float* pose);
+void lovrGraphicsDrawMesh(struct Mesh* mesh, mat4 transform, uint32_t instances, struct Buffer* pose, size_t poseOffset);
+void lovrGraphicsDrawBlob(struct Blob* blob, PointFormat format, DrawMode mode, uint32_t start, uint32_t count);
+void lovrGraphicsUpdateBlob(struct Blob* blob, size_t offset, size_t size);
 #define lovrGraphicsStencil lovrGpuStencil
 #define lovrGraphicsCompute lovrGpuCompute
 
@@ -181,6 +228,7 @@ typedef struct {
   bool dxt;
   bool instancedStereo;
   bool multiview;
+  bool rgtc;
   bool timers;
 } GpuFeatures;
 
@@ -197,8 +245,31 @@ typedef struct {
 typedef struct {
   int shaderSwitches;
   int drawCalls;
+  int bindsAvoided;
+  int textureBinds;
+  int framebufferBinds;
+  int pipelineChanges;
+  int bufferDiscards;
+  int batchesMerged;
+  int flushes[MAX_FLUSH_REASONS];
+  size_t bytesMapped[MAX_STREAMS];
+  size_t bytesFlushed[MAX_STREAMS];
+  size_t textureBytes;
+  uint64_t vertices;
+  uint64_t indices;
 } GpuStats;
 
+typedef struct {
+  const char* name;
+  uint32_t parent;
+  uint32_t depth;
+  uint32_t samples;
+  double last;
+  double min;
+  double average;
+  double max;
+} GpuZoneStats;
+
 typedef struct {
   struct Mesh* mesh;
   struct Canvas* canvas;
@@ -207,10 +278,11 @@ typedef struct {
   DrawMode topology;
   uint32_t rangeStart;
   uint32_t rangeCount;
+  uint32_t vertexCount;
   uint32_t instances;
 } DrawCommand;
 
-void lovrGpuInit(getProcAddressProc getProcAddress);
+void lovrGpuInit(getProcAddressProc getProcAddress, bool shaderCache);
 void lovrGpuDestroy(void);
 void lovrGpuClear(struct Canvas* canvas, Color* color, float* depth, int* stencil);
 void lovrGpuCompute(struct Shader* shader, int x, int y, int z);
@@ -221,6 +293,11 @@ void lovrGpuPresent(void);
 void lovrGpuDirtyTexture(void);
 void lovrGpuTick(const char* label);
 double lovrGpuTock(const char* label);
+uint32_t lovrGpuGetZoneCount(void);
+void lovrGpuGetZoneStats(uint32_t index, GpuZoneStats* stats);
 const GpuFeatures* lovrGpuGetFeatures(void);
 const GpuLimits* lovrGpuGetLimits(void);
-const GpuStats* lovrGpuGetStats(void);
+GpuStats* lovrGpuGetStats(void);
+const GpuStats* lovrGpuGetStatsHistory(uint32_t frame);
+size_t lovrGpuGetTextureStreamBudget(void);
+void lovrGpuSetTextureStreamBudget(size_t budget);
@@ -2,6 +2,7 @@
 #include "graphics/buffer.h"
 #include "graphics/graphics.h"
 #include "graphics/material.h"
+#include "data/blob.h"
 #include "core/ref.h"
 #include <stdlib.h>
 
@@ -13,6 +14,17 @@ Buffer* lovrMeshGetIndexBuffer(Mesh* mesh) {
   return mesh->indexBuffer;
 }
 
+// The Blob aliases the vertex buffer's memory, so the Mesh detaches it when it's destroyed.  The
+// memory is only mapped for reading when the buffer is readable.
+Blob* lovrMeshGetVertexBlob(Mesh* mesh) {
+  if (!mesh->vertexBlob && mesh->vertexBuffer) {
+    lovrAssert(lovrBufferIsReadable(mesh->vertexBuffer), "Mesh:getVertexBlob can only be used if the Mesh was created with the readable flag");
+    void* data = lovrBufferGetPointer(mesh->vertexBuffer);
+    mesh->vertexBlob = lovrBlobCreate(data, lovrBufferGetSize(mesh->vertexBuffer), "Mesh vertices");
+  }
+  return mesh->vertexBlob;
+}
+
 uint32_t lovrMeshGetVertexCount(Mesh* mesh) {
   return mesh->vertexCount;
 }
@@ -29,6 +41,8 @@ void lovrMeshAttachAttribute(Mesh* mesh, const char* name, MeshAttribute* attrib
   lovrAssert(!map_get(&mesh->attributeMap, name), "Mesh already has an attribute named '%s'", name);
   lovrAssert(mesh->attributeCount < MAX_ATTRIBUTES, "Mesh already has the max number of attributes (%d)", MAX_ATTRIBUTES);
   lovrAssert(strlen(name) < MAX_ATTRIBUTE_NAME_LENGTH, "Mesh attribute name '%s' is too long (max is %d)", name, MAX_ATTRIBUTE_NAME_LENGTH);
+  lovrAssert(attribute->type != I10_10_10_2 || (attribute->components == 4 && !attribute->integer), "Mesh attribute '%s' uses the int10_10_10_2 type, so it must have 4 components and can't be an integer attribute", name);
+  lovrAssert(attribute->type != F16 || !attribute->integer, "Mesh attribute '%s' uses the half type, so it can't be an integer attribute", name);
   lovrGraphicsFlushMesh(mesh);
   int index = mesh->attributeCount++;
   mesh->attributes[index] = *attribute;
@@ -8,6 +8,7 @@
 #define MAX_ATTRIBUTES 16
 #define MAX_ATTRIBUTE_NAME_LENGTH 32
 
+struct Blob;
 struct Buffer;
 struct Material;
 
@@ -16,7 +17,7 @@ typedef struct {
   uint32_t offset;
   unsigned stride : 8;
   unsigned divisor : 8;
-  unsigned type : 3; // AttributeType
+  unsigned type : 4; // AttributeType
   unsigned components : 3;
   unsigned normalized : 1;
   unsigned integer : 1;
@@ -34,6 +35,7 @@ typedef struct Mesh {
   uint32_t attributeCount;
   struct Buffer* vertexBuffer;
   struct Buffer* indexBuffer;
+  struct Blob* vertexBlob;
   uint32_t vertexCount;
   uint32_t indexCount;
   size_t indexSize;
@@ -49,6 +51,7 @@ Mesh* lovrMeshInit(Mesh* mesh, DrawMode mode, struct Buffer* vertexBuffer, uint3
 void lovrMeshDestroy(void* ref);
 struct Buffer* lovrMeshGetVertexBuffer(Mesh* mesh);
 struct Buffer* lovrMeshGetIndexBuffer(Mesh* mesh);
+struct Blob* lovrMeshGetVertexBlob(Mesh* mesh);
 void lovrMeshSetIndexBuffer(Mesh* mesh, struct Buffer* buffer, uint32_t indexCount, size_t indexSize, size_t offset);
 uint32_t lovrMeshGetVertexCount(Mesh* mesh);
 uint32_t lovrMeshGetIndexCount(Mesh* mesh);
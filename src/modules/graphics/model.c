@@ -8,6 +8,7 @@
 #include "core/maf.h"
 #include "core/ref.h"
 #include <stdlib.h>
+#include <string.h>
 #include <float.h>
 #include <math.h>
 
@@ -15,6 +16,11 @@ typedef struct {
   float properties[3][4];
 } NodeTransform;
 
+typedef struct {
+  uint32_t index;
+  uint32_t count;
+} LodRange;
+
 struct Model {
   struct ModelData* data;
   struct Buffer** buffers;
@@ -23,7 +29,15 @@ struct Model {
   struct Material** materials;
   NodeTransform* localTransforms;
   float* globalTransforms;
+  struct Buffer* poseBuffer;
+  struct Buffer* lodBuffer;
+  ModelLod* lods;
+  LodRange* lodRanges;
+  size_t* poseOffsets;
+  float* dequantize;
+  float lodThreshold;
   bool transformsDirty;
+  bool posesDirty;
 };
 
 static void updateGlobalTransform(Model* model, uint32_t nodeIndex, mat4 parent) {
@@ -44,30 +58,97 @@ static void updateGlobalTransform(Model* model, uint32_t nodeIndex, mat4 parent)
   }
 }
 
-static void renderNode(Model* model, uint32_t nodeIndex, uint32_t instances) {
-  ModelNode* node = &model->data->nodes[nodeIndex];
-  mat4 globalTransform = model->globalTransforms + 16 * nodeIndex;
-  float poseMatrix[16 * MAX_BONES];
-  float* pose = NULL;
+static void updatePoses(Model* model) {
+  if (model->transformsDirty) {
+    updateGlobalTransform(model, model->data->rootNode, (float[]) MAT4_IDENTITY);
+    model->transformsDirty = false;
+  }
+
+  if (!model->posesDirty || !model->poseBuffer) {
+    model->posesDirty = false;
+    return;
+  }
+
+  // Draws from earlier in the frame may still be waiting to read the old palettes
+  lovrGraphicsFlushBuffer(model->poseBuffer);
+  lovrBufferDiscard(model->poseBuffer);
+
+  for (uint32_t i = 0; i < model->data->nodeCount; i++) {
+    ModelNode* node = &model->data->nodes[i];
+    if (node->skin == ~0u) {
+      continue;
+    }
 
-  if (node->skin != ~0u) {
     ModelSkin* skin = &model->data->skins[node->skin];
-    pose = poseMatrix;
+    float inverseGlobalTransform[16];
+    mat4_invert(mat4_init(inverseGlobalTransform, model->globalTransforms + 16 * i));
+    float* pose = lovrBufferMap(model->poseBuffer, model->poseOffsets[i]);
 
     for (uint32_t j = 0; j < skin->jointCount; j++) {
       mat4 globalJointTransform = model->globalTransforms + 16 * skin->joints[j];
       mat4 inverseBindMatrix = skin->inverseBindMatrices + 16 * j;
       mat4 jointPose = pose + 16 * j;
 
-      mat4_set(jointPose, globalTransform);
-      mat4_invert(jointPose);
+      mat4_set(jointPose, inverseGlobalTransform);
       mat4_multiply(jointPose, globalJointTransform);
       mat4_multiply(jointPose, inverseBindMatrix);
     }
+
+    lovrBufferFlush(model->poseBuffer, model->poseOffsets[i], skin->jointCount * 16 * sizeof(float));
   }
 
+  lovrBufferUnmap(model->poseBuffer);
+  model->posesDirty = false;
+}
+
+static void renderNode(Model* model, uint32_t nodeIndex, uint32_t instances) {
+  ModelNode* node = &model->data->nodes[nodeIndex];
+  mat4 globalTransform = model->globalTransforms + 16 * nodeIndex;
+  Buffer* pose = node->skin == ~0u ? NULL : model->poseBuffer;
+  size_t poseOffset = node->skin == ~0u ? 0 : model->poseOffsets[nodeIndex];
+
   for (uint32_t i = 0; i < node->primitiveCount; i++) {
-    lovrGraphicsDrawMesh(model->meshes[node->primitiveIndex + i], globalTransform, instances, pose);
+    Mesh* mesh = model->meshes[node->primitiveIndex + i];
+    ModelPrimitive* primitive = &model->data->primitives[node->primitiveIndex + i];
+    LodRange* range = model->lodRanges ? &model->lodRanges[node->primitiveIndex + i] : NULL;
+
+    // Instances can be anywhere, so only single draws pick a level of detail and instanced draws
+    // reset the range to full detail
+    if (range && range->count > 0 && instances <= 1) {
+      ModelLod* lods = model->lods + range->index;
+      uint32_t level = 0;
+
+      if (model->lodThreshold > 0.f) {
+        ModelAttribute* position = primitive->attributes[ATTR_POSITION];
+        float center[3], extent[3];
+        for (uint32_t j = 0; j < 3; j++) {
+          center[j] = (position->min[j] + position->max[j]) * .5f;
+          extent[j] = (position->max[j] - position->min[j]) * .5f;
+        }
+
+        float pixelScale = lovrGraphicsGetPixelScale(globalTransform, center, vec3_length(extent));
+        while (level + 1 < range->count && lods[level + 1].error * pixelScale <= model->lodThreshold) {
+          level++;
+        }
+      }
+
+      lovrMeshSetDrawRange(mesh, lods[level].start, lods[level].count);
+    } else if (range && range->count > 0) {
+      ModelLod* lod = &model->lods[range->index];
+      lovrMeshSetDrawRange(mesh, lod->start, lod->count);
+    }
+
+    // Quantized positions are relative to the primitive's bounds
+    float* dequantize = model->dequantize ? model->dequantize + 4 * (node->primitiveIndex + i) : NULL;
+    if (dequantize && dequantize[3] > 0.f) {
+      float transform[16];
+      mat4_init(transform, globalTransform);
+      mat4_translate(transform, dequantize[0], dequantize[1], dequantize[2]);
+      mat4_scale(transform, dequantize[3], dequantize[3], dequantize[3]);
+      lovrGraphicsDrawMesh(mesh, transform, instances, pose, poseOffset);
+    } else {
+      lovrGraphicsDrawMesh(mesh, globalTransform, instances, pose, poseOffset);
+    }
   }
 
   for (uint32_t i = 0; i < node->childCount; i++) {
@@ -75,7 +156,141 @@ static void renderNode(Model* model, uint32_t nodeIndex, uint32_t instances) {
   }
 }
 
-Model* lovrModelCreate(ModelData* data) {
+static bool isQuantizable(ModelAttribute* attribute, uint32_t index) {
+  switch (index) {
+    case ATTR_POSITION: return attribute->type == F32 && attribute->components >= 3;
+    case ATTR_NORMAL: return attribute->type == F32 && attribute->components == 3;
+    case ATTR_TEXCOORD: return attribute->type == F32 && attribute->components == 2;
+    case ATTR_TANGENT: return attribute->type == F32 && attribute->components == 4;
+    default: return false;
+  }
+}
+
+static int32_t quantizeSnorm(float x, int32_t max) {
+  x = CLAMP(x, -1.f, 1.f) * max;
+  return (int32_t) (x >= 0.f ? x + .5f : x - .5f);
+}
+
+// Packs the float positions, normals, texture coordinates, and tangents of a primitive into one
+// vertex buffer that is less than half the size:
+// - Positions become unorm16, relative to their bounding box.  The box is scaled uniformly so
+//   normals are unaffected when the dequantize transform is applied to the draw transform.
+//   Skinned positions are left alone, since the joints expect the original positions.
+// - Normals and tangents use the signed 10_10_10_2 format, the tangent sign goes in the 2 bits.
+// - Texture coordinates become unorm16 if they're in [0, 1] and half floats otherwise.
+// Returns NULL if none of the attributes can be quantized.
+static Buffer* quantizePrimitive(ModelData* data, ModelPrimitive* primitive, MeshAttribute attributes[MAX_DEFAULT_ATTRIBUTES], float dequantize[4]) {
+  uint32_t count = 0;
+  uint32_t stride = 0;
+  ModelAttribute* sources[MAX_DEFAULT_ATTRIBUTES] = { 0 };
+  for (uint32_t i = 0; i < MAX_DEFAULT_ATTRIBUTES; i++) {
+    ModelAttribute* attribute = primitive->attributes[i];
+    if (!attribute || !isQuantizable(attribute, i) || (count > 0 && attribute->count != count)) {
+      continue;
+    }
+
+    if (i == ATTR_POSITION && primitive->attributes[ATTR_BONES]) {
+      continue;
+    }
+
+    sources[i] = attribute;
+    count = attribute->count;
+    attributes[i] = (MeshAttribute) {
+      .offset = stride,
+      .type = i == ATTR_POSITION || i == ATTR_TEXCOORD ? U16 : I10_10_10_2,
+      .components = i == ATTR_TEXCOORD ? 2 : 4,
+      .normalized = true
+    };
+    stride += i == ATTR_POSITION ? 8 : 4;
+  }
+
+  if (stride == 0) {
+    return NULL;
+  }
+
+  char* vertices = calloc(count, stride);
+  lovrAssert(vertices, "Out of memory");
+  for (uint32_t i = 0; i < MAX_DEFAULT_ATTRIBUTES; i++) {
+    ModelAttribute* source = sources[i];
+    if (!source) {
+      continue;
+    }
+
+    ModelBuffer* buffer = &data->buffers[source->buffer];
+    size_t sourceStride = buffer->stride ? buffer->stride : source->components * sizeof(float);
+    char* src = buffer->data + source->offset;
+    char* dst = vertices + attributes[i].offset;
+
+    if (i == ATTR_POSITION) {
+      float min[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+      float max[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+      for (uint32_t v = 0; v < count; v++) {
+        float* p = (float*) (src + v * sourceStride);
+        for (uint32_t j = 0; j < 3; j++) {
+          min[j] = MIN(min[j], p[j]);
+          max[j] = MAX(max[j], p[j]);
+        }
+      }
+
+      float extent[3] = { max[0] - min[0], max[1] - min[1], max[2] - min[2] };
+      float scale = MAX(extent[0], MAX(extent[1], extent[2]));
+      scale = scale > 0.f ? scale : 1.f;
+      dequantize[0] = min[0];
+      dequantize[1] = min[1];
+      dequantize[2] = min[2];
+      dequantize[3] = scale;
+
+      for (uint32_t v = 0; v < count; v++) {
+        float* p = (float*) (src + v * sourceStride);
+        uint16_t* q = (uint16_t*) (dst + v * stride);
+        for (uint32_t j = 0; j < 3; j++) {
+          float x = (p[j] - min[j]) / scale;
+          q[j] = (uint16_t) (CLAMP(x, 0.f, 1.f) * 65535.f + .5f);
+        }
+      }
+    } else if (i == ATTR_TEXCOORD) {
+      bool unorm = true;
+      for (uint32_t v = 0; v < count && unorm; v++) {
+        float* uv = (float*) (src + v * sourceStride);
+        unorm = uv[0] >= 0.f && uv[0] <= 1.f && uv[1] >= 0.f && uv[1] <= 1.f;
+      }
+
+      attributes[i].type = unorm ? U16 : F16;
+      attributes[i].normalized = unorm;
+      for (uint32_t v = 0; v < count; v++) {
+        float* uv = (float*) (src + v * sourceStride);
+        uint16_t* q = (uint16_t*) (dst + v * stride);
+        for (uint32_t j = 0; j < 2; j++) {
+          q[j] = unorm ? (uint16_t) (uv[j] * 65535.f + .5f) : float32to16(uv[j]);
+        }
+      }
+    } else {
+      for (uint32_t v = 0; v < count; v++) {
+        float* n = (float*) (src + v * sourceStride);
+        uint32_t packed = 0;
+        for (uint32_t j = 0; j < 3; j++) {
+          packed = packInt1010102(packed, j, quantizeSnorm(n[j], 511));
+        }
+        if (i == ATTR_TANGENT) {
+          packed = packInt1010102(packed, 3, n[3] < 0.f ? -1 : 1);
+        }
+        memcpy(dst + v * stride, &packed, sizeof(packed));
+      }
+    }
+  }
+
+  Buffer* buffer = lovrBufferCreate(count * stride, vertices, BUFFER_VERTEX, USAGE_STATIC, false);
+  for (uint32_t i = 0; i < MAX_DEFAULT_ATTRIBUTES; i++) {
+    if (sources[i]) {
+      attributes[i].buffer = buffer;
+      attributes[i].stride = stride;
+    }
+  }
+  free(vertices);
+  return buffer;
+}
+
+Model* lovrModelCreate(ModelData* data, bool quantize) {
   Model* model = lovrAlloc(Model);
   model->data = data;
   lovrRetain(data);
@@ -106,7 +321,12 @@ Model* lovrModelCreate(ModelData* data) {
           if (!model->textures[index]) {
             TextureData* textureData = data->textures[index];
             bool srgb = j == TEXTURE_DIFFUSE || j == TEXTURE_EMISSIVE;
-            model->textures[index] = lovrTextureCreate(TEXTURE_2D, &textureData, 1, srgb, true, 0);
+
+            // Compressed mipmap chains stream in over a few frames instead of stalling the load
+            Texture* texture = lovrTextureCreate(TEXTURE_2D, NULL, 0, srgb, true, 0);
+            lovrTextureAllocate(texture, textureData->width, textureData->height, 1, textureData->format);
+            lovrTextureReplacePixels(texture, textureData, 0, 0, 0, 0, textureData->format >= FORMAT_DXT1);
+            model->textures[index] = texture;
             lovrTextureSetFilter(model->textures[index], data->materials[i].filters[j]);
             lovrTextureSetWrap(model->textures[index], data->materials[i].wraps[j]);
           }
@@ -125,11 +345,44 @@ Model* lovrModelCreate(ModelData* data) {
       model->buffers = calloc(data->bufferCount, sizeof(Buffer*));
     }
 
+    // Primitives with the same vertex attributes share their quantized vertex buffer
+    Buffer** quantized = NULL;
+    MeshAttribute (*quantizedAttributes)[MAX_DEFAULT_ATTRIBUTES] = NULL;
+    if (quantize) {
+      model->dequantize = calloc(data->primitiveCount, 4 * sizeof(float));
+      quantized = calloc(data->primitiveCount, sizeof(Buffer*));
+      quantizedAttributes = calloc(data->primitiveCount, sizeof(*quantizedAttributes));
+      lovrAssert(model->dequantize && quantized && quantizedAttributes, "Out of memory");
+    }
+
     model->meshes = calloc(data->primitiveCount, sizeof(Mesh*));
+
+    // The levels are copied, since the index buffer is fixed even if the ModelData's LODs change
+    if (data->lodCount > 0) {
+      model->lods = malloc(data->lodCount * sizeof(ModelLod));
+      model->lodRanges = calloc(data->primitiveCount, sizeof(LodRange));
+      lovrAssert(model->lods && model->lodRanges, "Out of memory");
+      memcpy(model->lods, data->lods, data->lodCount * sizeof(ModelLod));
+    }
+
     for (uint32_t i = 0; i < data->primitiveCount; i++) {
       ModelPrimitive* primitive = &data->primitives[i];
       model->meshes[i] = lovrMeshCreate(primitive->mode, NULL, 0);
 
+      if (quantize) {
+        uint32_t j = 0;
+        while (j < i && memcmp(data->primitives[j].attributes, primitive->attributes, sizeof(primitive->attributes))) {
+          j++;
+        }
+
+        if (j < i) {
+          memcpy(model->dequantize + 4 * i, model->dequantize + 4 * j, 4 * sizeof(float));
+          memcpy(quantizedAttributes[i], quantizedAttributes[j], sizeof(*quantizedAttributes));
+        } else {
+          quantized[i] = quantizePrimitive(data, primitive, quantizedAttributes[i], model->dequantize + 4 * i);
+        }
+      }
+
       if (primitive->material != ~0u) {
         lovrMeshSetMaterial(model->meshes[i], model->materials[primitive->material]);
       }
@@ -139,21 +392,25 @@ Model* lovrModelCreate(ModelData* data) {
         if (primitive->attributes[j]) {
           ModelAttribute* attribute = primitive->attributes[j];
 
-          if (!model->buffers[attribute->buffer]) {
-            ModelBuffer* buffer = &data->buffers[attribute->buffer];
-            model->buffers[attribute->buffer] = lovrBufferCreate(buffer->size, buffer->data, BUFFER_VERTEX, USAGE_STATIC, false);
+          if (quantize && quantizedAttributes[i][j].buffer) {
+            lovrMeshAttachAttribute(model->meshes[i], lovrShaderAttributeNames[j], &quantizedAttributes[i][j]);
+          } else {
+            if (!model->buffers[attribute->buffer]) {
+              ModelBuffer* buffer = &data->buffers[attribute->buffer];
+              model->buffers[attribute->buffer] = lovrBufferCreate(buffer->size, buffer->data, BUFFER_VERTEX, USAGE_STATIC, false);
+            }
+
+            lovrMeshAttachAttribute(model->meshes[i], lovrShaderAttributeNames[j], &(MeshAttribute) {
+              .buffer = model->buffers[attribute->buffer],
+              .offset = attribute->offset,
+              .stride = data->buffers[attribute->buffer].stride,
+              .type = attribute->type,
+              .components = attribute->components,
+              .integer = j == ATTR_BONES,
+              .normalized = attribute->normalized
+            });
           }
 
-          lovrMeshAttachAttribute(model->meshes[i], lovrShaderAttributeNames[j], &(MeshAttribute) {
-            .buffer = model->buffers[attribute->buffer],
-            .offset = attribute->offset,
-            .stride = data->buffers[attribute->buffer].stride,
-            .type = attribute->type,
-            .components = attribute->components,
-            .integer = j == ATTR_BONES,
-            .normalized = attribute->normalized
-          });
-
           if (!setDrawRange && !primitive->indices) {
             lovrMeshSetDrawRange(model->meshes[i], 0, attribute->count);
             setDrawRange = true;
@@ -169,7 +426,17 @@ Model* lovrModelCreate(ModelData* data) {
         .integer = true
       });
 
-      if (primitive->indices) {
+      // All levels of detail share one index buffer, so switching levels only changes the draw range
+      if (primitive->lodCount > 0) {
+        if (!model->lodBuffer) {
+          model->lodBuffer = lovrBufferCreate(data->lodIndexCount * sizeof(uint32_t), data->lodIndices, BUFFER_INDEX, USAGE_STATIC, false);
+        }
+
+        ModelLod* lod = &data->lods[primitive->lodIndex];
+        model->lodRanges[i] = (LodRange) { primitive->lodIndex, primitive->lodCount };
+        lovrMeshSetIndexBuffer(model->meshes[i], model->lodBuffer, data->lodIndexCount, sizeof(uint32_t), 0);
+        lovrMeshSetDrawRange(model->meshes[i], lod->start, lod->count);
+      } else if (primitive->indices) {
         ModelAttribute* attribute = primitive->indices;
 
         if (!model->buffers[attribute->buffer]) {
@@ -182,8 +449,40 @@ Model* lovrModelCreate(ModelData* data) {
         lovrMeshSetDrawRange(model->meshes[i], 0, attribute->count);
       }
     }
+
+    // The meshes hold on to the quantized buffers
+    if (quantize) {
+      for (uint32_t i = 0; i < data->primitiveCount; i++) {
+        lovrRelease(Buffer, quantized[i]);
+      }
+      free(quantized);
+      free(quantizedAttributes);
+    }
+  }
+
+  // Skinning
+  // Each skinned node gets its own joint palette in a uniform buffer, so the palettes only need to
+  // be recomputed when the pose changes instead of on every draw.  Every palette is followed by
+  // enough space to back the full lovrPoseBlock.
+  if (data->skinCount > 0) {
+    size_t align = lovrGraphicsGetLimits()->blockAlign;
+    size_t paletteSize = MAX_BONES * 16 * sizeof(float);
+    size_t size = 0;
+
+    model->poseOffsets = calloc(data->nodeCount, sizeof(size_t));
+    for (uint32_t i = 0; i < data->nodeCount; i++) {
+      if (data->nodes[i].skin != ~0u) {
+        uint32_t jointCount = data->skins[data->nodes[i].skin].jointCount;
+        lovrAssert(jointCount <= MAX_BONES, "Model skin has too many joints (%d), the max is %d", jointCount, MAX_BONES);
+        model->poseOffsets[i] = size;
+        size = ALIGN(size + jointCount * 16 * sizeof(float) + align - 1, align);
+      }
+    }
+
+    model->poseBuffer = lovrBufferCreate(size + paletteSize, NULL, BUFFER_UNIFORM, USAGE_DYNAMIC, false);
   }
 
+  model->lodThreshold = 1.f;
   model->localTransforms = malloc(sizeof(NodeTransform) * data->nodeCount);
   model->globalTransforms = malloc(16 * sizeof(float) * data->nodeCount);
   lovrModelResetPose(model);
@@ -221,7 +520,13 @@ void lovrModelDestroy(void* ref) {
     free(model->materials);
   }
 
+  lovrRelease(Buffer, model->poseBuffer);
+  lovrRelease(Buffer, model->lodBuffer);
   lovrRelease(ModelData, model->data);
+  free(model->lods);
+  free(model->lodRanges);
+  free(model->poseOffsets);
+  free(model->dequantize);
   free(model->globalTransforms);
   free(model->localTransforms);
 }
@@ -231,10 +536,7 @@ ModelData* lovrModelGetModelData(Model* model) {
 }
 
 void lovrModelDraw(Model* model, mat4 transform, uint32_t instances) {
-  if (model->transformsDirty) {
-    updateGlobalTransform(model, model->data->rootNode, (float[]) MAT4_IDENTITY);
-    model->transformsDirty = false;
-  }
+  updatePoses(model);
 
   lovrGraphicsPush();
   lovrGraphicsMatrixTransform(transform);
@@ -242,6 +544,16 @@ void lovrModelDraw(Model* model, mat4 transform, uint32_t instances) {
   lovrGraphicsPop();
 }
 
+float lovrModelGetLodThreshold(Model* model) {
+  return model->lodThreshold;
+}
+
+// The threshold is how many pixels a simplified surface is allowed to drift from the original one
+// before a more detailed level is used.  Zero always draws full detail.
+void lovrModelSetLodThreshold(Model* model, float threshold) {
+  model->lodThreshold = threshold;
+}
+
 void lovrModelAnimate(Model* model, uint32_t animationIndex, float time, float alpha) {
   if (alpha <= 0.f) {
     return;
@@ -319,6 +631,7 @@ void lovrModelAnimate(Model* model, uint32_t animationIndex, float time, float a
   }
 
   model->transformsDirty = true;
+  model->posesDirty = true;
 }
 
 void lovrModelGetNodePose(Model* model, uint32_t nodeIndex, float position[4], float rotation[4], CoordinateSpace space) {
@@ -352,6 +665,7 @@ void lovrModelPose(Model* model, uint32_t nodeIndex, float position[4], float ro
     quat_slerp(transform->properties[PROP_ROTATION], rotation, alpha);
   }
   model->transformsDirty = true;
+  model->posesDirty = true;
 }
 
 void lovrModelResetPose(Model* model) {
@@ -368,6 +682,7 @@ void lovrModelResetPose(Model* model) {
   }
 
   model->transformsDirty = true;
+  model->posesDirty = true;
 }
 
 Material* lovrModelGetMaterial(Model* model, uint32_t material) {
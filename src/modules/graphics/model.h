@@ -12,10 +12,12 @@ typedef enum {
 } CoordinateSpace;
 
 typedef struct Model Model;
-Model* lovrModelCreate(struct ModelData* data);
+Model* lovrModelCreate(struct ModelData* data, bool quantize);
 void lovrModelDestroy(void* ref);
 struct ModelData* lovrModelGetModelData(Model* model);
 void lovrModelDraw(Model* model, float* transform, uint32_t instances);
+float lovrModelGetLodThreshold(Model* model);
+void lovrModelSetLodThreshold(Model* model, float threshold);
 void lovrModelAnimate(Model* model, uint32_t animationIndex, float time, float alpha);
 void lovrModelGetNodePose(Model* model, uint32_t nodeIndex, float position[4], float rotation[4], CoordinateSpace space);
 void lovrModelPose(Model* model, uint32_t nodeIndex, float position[4], float rotation[4], float alpha);
@@ -7,15 +7,28 @@
 #include "graphics/shader.h"
 #include "graphics/texture.h"
 #include "resources/shaders.h"
+#include "data/blob.h"
 #include "data/modelData.h"
 #include "core/ref.h"
 #include "lib/map/map.h"
+#ifdef LOVR_ENABLE_FILESYSTEM
+#include "filesystem/filesystem.h"
+#endif
+#include <inttypes.h>
 #include <math.h>
 #include <limits.h>
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
 
+// The timer query entry points are only in GLES through EXT_disjoint_timer_query
+#ifdef LOVR_GLES
+#undef glQueryCounter
+#define glQueryCounter glQueryCounterEXT
+#undef glGetQueryObjectui64v
+#define glGetQueryObjectui64v glGetQueryObjectui64vEXT
+#endif
+
 // Types
 
 #define MAX_TEXTURES 16
@@ -31,6 +44,23 @@
 #define LOVR_SHADER_BONE_WEIGHTS 6
 #define LOVR_SHADER_DRAW_ID 7
 
+#define SHADER_CACHE_DIRECTORY "shadercache"
+#define SHADER_CACHE_MAGIC 0x4853564c // LVSH
+
+#define MAX_STATS_HISTORY 120
+
+#define LOVR_MAX_ZONE_NAME_LENGTH 64
+#define MAX_TIMER_ZONES 128
+#define MAX_TIMER_DEPTH 16
+#define MAX_TIMER_QUERIES 256
+#define TIMER_WINDOW 60
+
+#define UPLOAD_BUFFER_SIZE (16 * 1024 * 1024)
+#define MAX_PENDING_UPLOADS 64
+
+#define DEFAULT_TEXTURE_STREAM_BUDGET (4 * 1024 * 1024)
+#define MIN_STREAMED_MIPMAP_SIZE 64
+
 typedef enum {
   BARRIER_BLOCK,
   BARRIER_UNIFORM_TEXTURE,
@@ -47,11 +77,33 @@ typedef struct {
 } BlockBuffer;
 
 typedef struct {
-  size_t next;
-  size_t oldest;
-  GLuint timers[4];
-  uint64_t ns;
-} TimerList;
+  uint32_t magic;
+  uint32_t format;
+  uint64_t key;
+} ProgramBinaryHeader;
+
+typedef struct {
+  GLsync fence;
+  size_t offset;
+  size_t size;
+} PendingUpload;
+
+typedef struct {
+  char name[LOVR_MAX_ZONE_NAME_LENGTH];
+  uint32_t parent;
+  uint32_t depth;
+  uint32_t sampleCount;
+  uint32_t nextSample;
+  double samples[TIMER_WINDOW];
+  double last;
+} TimerZone;
+
+typedef struct {
+  GLuint begin;
+  GLuint end;
+  uint32_t zone;
+  bool ended;
+} TimerQuery;
 
 static struct {
   Texture* defaultTexture;
@@ -80,13 +132,36 @@ static struct {
   int activeTexture;
   Texture* textures[MAX_TEXTURES];
   Image images[MAX_IMAGES];
+  uint32_t textureGeneration;
+  uint32_t imageGeneration;
   float viewports[2][4];
   uint32_t viewportCount;
   arr_t(void*) incoherents[MAX_BARRIERS];
-  map_t(TimerList) timers;
+  TimerZone zones[MAX_TIMER_ZONES];
+  uint32_t zoneCount;
+  map_int_t zoneMap;
+  TimerQuery timerQueries[MAX_TIMER_QUERIES];
+  uint32_t timerHead;
+  uint32_t timerCount;
+  uint32_t zoneStack[MAX_TIMER_DEPTH];
+  uint32_t queryStack[MAX_TIMER_DEPTH];
+  uint32_t timerDepth;
+  Buffer* uploadBuffer;
+  size_t uploadCursor;
+  PendingUpload uploads[MAX_PENDING_UPLOADS];
+  uint32_t uploadHead;
+  uint32_t uploadCount;
+  uint64_t uploadsSubmitted;
+  uint64_t uploadsCompleted;
+  arr_t(Texture*) streamingTextures;
+  size_t textureStreamBudget;
+  bool shaderCache;
+  uint64_t driverHash;
   GpuFeatures features;
   GpuLimits limits;
   GpuStats stats;
+  GpuStats statsHistory[MAX_STATS_HISTORY];
+  uint32_t statsFrame;
 } state;
 
 // Helper functions
@@ -143,6 +218,11 @@ static GLenum convertTextureFormat(TextureFormat format) {
     case FORMAT_DXT1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
     case FORMAT_DXT3: return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
     case FORMAT_DXT5: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+#ifdef LOVR_WEBGL
+    case FORMAT_BC5: return GL_COMPRESSED_RED_GREEN_RGTC2_EXT;
+#else
+    case FORMAT_BC5: return GL_COMPRESSED_RG_RGTC2;
+#endif
     case FORMAT_ASTC_4x4:
     case FORMAT_ASTC_5x4:
     case FORMAT_ASTC_5x5:
@@ -182,6 +262,11 @@ static GLenum convertTextureFormatInternal(TextureFormat format, bool srgb) {
     case FORMAT_DXT1: return srgb ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
     case FORMAT_DXT3: return srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT : GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
     case FORMAT_DXT5: return srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+#ifdef LOVR_WEBGL
+    case FORMAT_BC5: return GL_COMPRESSED_RED_GREEN_RGTC2_EXT;
+#else
+    case FORMAT_BC5: return GL_COMPRESSED_RG_RGTC2;
+#endif
 #ifdef LOVR_WEBGL
     case FORMAT_ASTC_4x4: return srgb ? GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR : GL_COMPRESSED_RGBA_ASTC_4x4_KHR;
     case FORMAT_ASTC_5x4: return srgb ? GL_COMPRESSED_SRGB8_ALPHA8_ASTC_5x4_KHR : GL_COMPRESSED_RGBA_ASTC_5x4_KHR;
@@ -237,6 +322,7 @@ static GLenum convertTextureFormatType(TextureFormat format) {
     case FORMAT_DXT1:
     case FORMAT_DXT3:
     case FORMAT_DXT5:
+    case FORMAT_BC5:
     case FORMAT_ASTC_4x4:
     case FORMAT_ASTC_5x4:
     case FORMAT_ASTC_5x5:
@@ -262,6 +348,7 @@ static bool isTextureFormatCompressed(TextureFormat format) {
     case FORMAT_DXT1:
     case FORMAT_DXT3:
     case FORMAT_DXT5:
+    case FORMAT_BC5:
     case FORMAT_ASTC_4x4:
     case FORMAT_ASTC_5x4:
     case FORMAT_ASTC_5x5:
@@ -298,6 +385,8 @@ static GLenum convertAttributeType(AttributeType type) {
     case I32: return GL_INT;
     case U32: return GL_UNSIGNED_INT;
     case F32: return GL_FLOAT;
+    case F16: return GL_HALF_FLOAT;
+    case I10_10_10_2: return GL_INT_2_10_10_10_REV;
     default: lovrThrow("Unreachable");
   }
 }
@@ -309,6 +398,7 @@ static GLenum convertBufferType(BufferType type) {
     case BUFFER_UNIFORM: return GL_UNIFORM_BUFFER;
     case BUFFER_SHADER_STORAGE: return GL_SHADER_STORAGE_BUFFER;
     case BUFFER_GENERIC: return GL_COPY_WRITE_BUFFER;
+    case BUFFER_UPLOAD: return GL_PIXEL_UNPACK_BUFFER;
     default: lovrThrow("Unreachable");
   }
 }
@@ -469,10 +559,70 @@ static void lovrGpuDestroySyncResource(void* resource, uint8_t incoherent) {
   }
 }
 
+#ifndef LOVR_WEBGL
+// Uploads finish in the order they were submitted, so the oldest one is always the next to retire
+static bool lovrGpuRetireUpload(bool wait) {
+  PendingUpload* upload = &state.uploads[state.uploadHead];
+
+  if (wait) {
+    while (glClientWaitSync(upload->fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED);
+  } else if (glClientWaitSync(upload->fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+    return false;
+  }
+
+  glDeleteSync(upload->fence);
+  state.uploadHead = (state.uploadHead + 1) % MAX_PENDING_UPLOADS;
+  state.uploadCount--;
+  state.uploadsCompleted++;
+  return true;
+}
+
+// Returns an offset into the upload ring with room for size bytes, waiting for the GPU to finish
+// reading any older uploads that are still using that region
+static size_t lovrGpuAllocateUpload(size_t size) {
+  if (!state.uploadBuffer) {
+    state.uploadBuffer = lovrBufferCreate(UPLOAD_BUFFER_SIZE, NULL, BUFFER_UPLOAD, USAGE_STREAM, false);
+  }
+
+  size_t offset = ALIGN(state.uploadCursor + 15, 16);
+  if (offset + size > UPLOAD_BUFFER_SIZE) {
+    offset = 0;
+  }
+
+  for (;;) {
+    bool busy = state.uploadCount == MAX_PENDING_UPLOADS;
+    for (uint32_t i = 0; i < state.uploadCount && !busy; i++) {
+      PendingUpload* upload = &state.uploads[(state.uploadHead + i) % MAX_PENDING_UPLOADS];
+      busy = upload->offset < offset + size && offset < upload->offset + upload->size;
+    }
+
+    if (!busy) {
+      break;
+    }
+
+    lovrGpuRetireUpload(true);
+  }
+
+  state.uploadCursor = offset + size;
+  return offset;
+}
+
+static uint64_t lovrGpuSubmitUpload(size_t offset, size_t size) {
+  uint32_t index = (state.uploadHead + state.uploadCount++) % MAX_PENDING_UPLOADS;
+  state.uploads[index] = (PendingUpload) {
+    .fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0),
+    .offset = offset,
+    .size = size
+  };
+  return ++state.uploadsSubmitted;
+}
+#endif
+
 static void lovrGpuBindFramebuffer(uint32_t framebuffer) {
   if (state.framebuffer != framebuffer) {
     state.framebuffer = framebuffer;
     glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    state.stats.framebufferBinds++;
   }
 }
 
@@ -535,11 +685,15 @@ static void lovrGpuBindTexture(Texture* texture, int slot) {
     lovrRetain(texture);
     lovrRelease(Texture, state.textures[slot]);
     state.textures[slot] = texture;
+    state.textureGeneration++;
     if (state.activeTexture != slot) {
       glActiveTexture(GL_TEXTURE0 + slot);
       state.activeTexture = slot;
     }
     glBindTexture(texture->target, texture->id);
+    state.stats.textureBinds++;
+  } else {
+    state.stats.bindsAvoided++;
   }
 }
 
@@ -564,6 +718,7 @@ static void lovrGpuBindImage(Image* image, int slot) {
     lovrRelease(Texture, state.images[slot].texture);
     glBindImageTexture(slot, texture->id, image->mipmap, layered, slice, glAccess, glFormat);
     memcpy(state.images + slot, image, sizeof(Image));
+    state.imageGeneration++;
   }
 }
 #endif
@@ -703,6 +858,7 @@ static void lovrGpuBindPipeline(Pipeline* pipeline) {
 
   // Alpha Coverage
   if (state.alphaToCoverage != pipeline->alphaSampling) {
+    state.stats.pipelineChanges++;
     state.alphaToCoverage = pipeline->alphaSampling;
     if (state.alphaToCoverage) {
       glEnable(GL_SAMPLE_ALPHA_TO_COVERAGE);
@@ -713,6 +869,7 @@ static void lovrGpuBindPipeline(Pipeline* pipeline) {
 
   // Blend mode
   if (state.blendMode != pipeline->blendMode || state.blendAlphaMode != pipeline->blendAlphaMode) {
+    state.stats.pipelineChanges++;
     state.blendMode = pipeline->blendMode;
     state.blendAlphaMode = pipeline->blendAlphaMode;
 
@@ -775,6 +932,7 @@ static void lovrGpuBindPipeline(Pipeline* pipeline) {
 
   // Culling
   if (state.culling != pipeline->culling) {
+    state.stats.pipelineChanges++;
     state.culling = pipeline->culling;
     if (state.culling) {
       glEnable(GL_CULL_FACE);
@@ -785,6 +943,7 @@ static void lovrGpuBindPipeline(Pipeline* pipeline) {
 
   // Depth test
   if (state.depthTest != pipeline->depthTest) {
+    state.stats.pipelineChanges++;
     state.depthTest = pipeline->depthTest;
     if (state.depthTest != COMPARE_NONE) {
       if (!state.depthEnabled) {
@@ -800,18 +959,21 @@ static void lovrGpuBindPipeline(Pipeline* pipeline) {
 
   // Depth write
   if (state.depthWrite != (pipeline->depthWrite && !state.stencilWriting)) {
+    state.stats.pipelineChanges++;
     state.depthWrite = pipeline->depthWrite && !state.stencilWriting;
     glDepthMask(state.depthWrite);
   }
 
   // Line width
   if (state.lineWidth != pipeline->lineWidth) {
+    state.stats.pipelineChanges++;
     state.lineWidth = pipeline->lineWidth;
     glLineWidth(state.lineWidth);
   }
 
   // Stencil mode
   if (!state.stencilWriting && (state.stencilMode != pipeline->stencilMode || state.stencilValue != pipeline->stencilValue)) {
+    state.stats.pipelineChanges++;
     state.stencilMode = pipeline->stencilMode;
     state.stencilValue = pipeline->stencilValue;
     if (state.stencilMode != COMPARE_NONE) {
@@ -841,6 +1003,7 @@ static void lovrGpuBindPipeline(Pipeline* pipeline) {
 
   // Winding
   if (state.winding != pipeline->winding) {
+    state.stats.pipelineChanges++;
     state.winding = pipeline->winding;
     glFrontFace(state.winding == WINDING_CLOCKWISE ? GL_CW : GL_CCW);
   }
@@ -848,6 +1011,7 @@ static void lovrGpuBindPipeline(Pipeline* pipeline) {
   // Wireframe
 #ifdef LOVR_GL
   if (state.wireframe != pipeline->wireframe) {
+    state.stats.pipelineChanges++;
     state.wireframe = pipeline->wireframe;
     glPolygonMode(GL_FRONT_AND_BACK, state.wireframe ? GL_LINE : GL_FILL);
   }
@@ -860,33 +1024,37 @@ static void lovrGpuBindShader(Shader* shader) {
   // Figure out if we need to wait for pending writes on resources to complete
 #ifndef LOVR_WEBGL
   uint8_t flags = 0;
-  for (size_t i = 0; i < shader->blocks[BLOCK_COMPUTE].length; i++) {
-    UniformBlock* block = &shader->blocks[BLOCK_COMPUTE].data[i];
-    if (block->source && (block->source->incoherent >> BARRIER_BLOCK) & 1) {
-      flags |= 1 << BARRIER_BLOCK;
-      break;
+  if (state.incoherents[BARRIER_BLOCK].length > 0) {
+    for (size_t i = 0; i < shader->blocks[BLOCK_COMPUTE].length; i++) {
+      UniformBlock* block = &shader->blocks[BLOCK_COMPUTE].data[i];
+      if (block->source && (block->source->incoherent >> BARRIER_BLOCK) & 1) {
+        flags |= 1 << BARRIER_BLOCK;
+        break;
+      }
     }
   }
 
-  for (size_t i = 0; i < shader->uniforms.length; i++) {
-    Uniform* uniform = &shader->uniforms.data[i];
-    if (uniform->type == UNIFORM_SAMPLER) {
-      for (int i = 0; i < uniform->count; i++) {
-        Texture* texture = uniform->value.textures[i];
-        if (texture && texture->incoherent && (texture->incoherent >> BARRIER_UNIFORM_TEXTURE) & 1) {
-          flags |= 1 << BARRIER_UNIFORM_TEXTURE;
-          if (flags & (1 << BARRIER_UNIFORM_IMAGE)) {
-            break;
+  if (state.incoherents[BARRIER_UNIFORM_TEXTURE].length > 0 || state.incoherents[BARRIER_UNIFORM_IMAGE].length > 0) {
+    for (size_t i = 0; i < shader->uniforms.length; i++) {
+      Uniform* uniform = &shader->uniforms.data[i];
+      if (uniform->type == UNIFORM_SAMPLER) {
+        for (int i = 0; i < uniform->count; i++) {
+          Texture* texture = uniform->value.textures[i];
+          if (texture && texture->incoherent && (texture->incoherent >> BARRIER_UNIFORM_TEXTURE) & 1) {
+            flags |= 1 << BARRIER_UNIFORM_TEXTURE;
+            if (flags & (1 << BARRIER_UNIFORM_IMAGE)) {
+              break;
+            }
           }
         }
-      }
-    } else if (uniform->type == UNIFORM_IMAGE) {
-      for (int i = 0; i < uniform->count; i++) {
-        Texture* texture = uniform->value.images[i].texture;
-        if (texture && texture->incoherent && (texture->incoherent >> BARRIER_UNIFORM_IMAGE) & 1) {
-          flags |= 1 << BARRIER_UNIFORM_IMAGE;
-          if (flags & (1 << BARRIER_UNIFORM_TEXTURE)) {
-            break;
+      } else if (uniform->type == UNIFORM_IMAGE) {
+        for (int i = 0; i < uniform->count; i++) {
+          Texture* texture = uniform->value.images[i].texture;
+          if (texture && texture->incoherent && (texture->incoherent >> BARRIER_UNIFORM_IMAGE) & 1) {
+            flags |= 1 << BARRIER_UNIFORM_IMAGE;
+            if (flags & (1 << BARRIER_UNIFORM_TEXTURE)) {
+              break;
+            }
           }
         }
       }
@@ -896,6 +1064,16 @@ static void lovrGpuBindShader(Shader* shader) {
   lovrGpuSync(flags);
 #endif
 
+  // If none of the uniforms changed and nothing else has touched the texture/image units since
+  // this shader last bound them, the GL state is already correct.  Images are the exception, since
+  // writable images need to be marked incoherent on every bind.
+  bool texturesStale = shader->textureGeneration != state.textureGeneration;
+  bool imagesStale = shader->imageGeneration != state.imageGeneration;
+
+  if (!shader->dirty && !texturesStale && !imagesStale && shader->imageCount == 0) {
+    goto blocks;
+  }
+
   // Bind uniforms
   for (size_t i = 0; i < shader->uniforms.length; i++) {
     Uniform* uniform = &shader->uniforms.data[i];
@@ -904,6 +1082,7 @@ static void lovrGpuBindShader(Shader* shader) {
       continue;
     }
 
+    bool dirty = uniform->dirty;
     uniform->dirty = false;
     int count = uniform->count;
     void* data = uniform->value.data;
@@ -950,12 +1129,20 @@ static void lovrGpuBindShader(Shader* shader) {
             }
           }
 
-          lovrGpuBindImage(image, uniform->baseSlot + i);
+          if (dirty || imagesStale) {
+            lovrGpuBindImage(image, uniform->baseSlot + i);
+          } else {
+            state.stats.bindsAvoided++;
+          }
         }
 #endif
         break;
 
       case UNIFORM_SAMPLER:
+        if (!dirty && !texturesStale) {
+          break;
+        }
+
         for (int i = 0; i < count; i++) {
           Texture* texture = uniform->value.textures[i];
           lovrAssert(!texture || texture->type == uniform->textureType, "Uniform texture type mismatch for uniform %s", uniform->name);
@@ -965,6 +1152,11 @@ static void lovrGpuBindShader(Shader* shader) {
     }
   }
 
+  shader->dirty = false;
+  shader->textureGeneration = state.textureGeneration;
+  shader->imageGeneration = state.imageGeneration;
+
+blocks:
   // Bind uniform blocks
   for (BlockType type = BLOCK_UNIFORM; type <= BLOCK_COMPUTE; type++) {
     for (size_t i = 0; i < shader->blocks[type].length; i++) {
@@ -984,6 +1176,17 @@ static void lovrGpuBindShader(Shader* shader) {
   }
 }
 
+static void lovrGpuSetBuiltinUniform(int location, int* cache, int value) {
+  if (location == -1) {
+    return;
+  } else if (*cache == value) {
+    state.stats.bindsAvoided++;
+  } else {
+    glUniform1i(location, value);
+    *cache = value;
+  }
+}
+
 static void lovrGpuSetViewports(float* viewport, uint32_t count) {
   if (state.viewportCount != count || memcmp(state.viewports, viewport, count * 4 * sizeof(float))) {
     memcpy(state.viewports, viewport, count * 4 * sizeof(float));
@@ -1002,7 +1205,7 @@ static void lovrGpuSetViewports(float* viewport, uint32_t count) {
 
 // GPU
 
-void lovrGpuInit(getProcAddressProc getProcAddress) {
+void lovrGpuInit(getProcAddressProc getProcAddress, bool shaderCache) {
 #ifdef LOVR_GL
   gladLoadGLLoader((GLADloadproc) getProcAddress);
 #elif defined(LOVR_GLES)
@@ -1013,6 +1216,7 @@ void lovrGpuInit(getProcAddressProc getProcAddress) {
   state.features.astc = GLAD_GL_ES_VERSION_3_2;
   state.features.compute = GLAD_GL_ARB_compute_shader;
   state.features.dxt = GLAD_GL_EXT_texture_compression_s3tc;
+  state.features.rgtc = GLAD_GL_VERSION_3_0 || GLAD_GL_EXT_texture_compression_rgtc;
   state.features.instancedStereo = GLAD_GL_ARB_viewport_array && GLAD_GL_AMD_vertex_shader_viewport_index && GLAD_GL_ARB_fragment_layer_viewport;
   state.features.multiview = GLAD_GL_OVR_multiview2 && GLAD_GL_OVR_multiview_multisampled_render_to_texture;
   state.features.timers = GLAD_GL_VERSION_3_3 || GLAD_GL_EXT_disjoint_timer_query;
@@ -1024,6 +1228,28 @@ void lovrGpuInit(getProcAddressProc getProcAddress) {
 #endif
   glGetFloatv(GL_POINT_SIZE_RANGE, state.limits.pointSizes);
 
+  // Let the driver pick how many threads to use for async shader compilation
+  if (GLAD_GL_KHR_parallel_shader_compile) {
+    glMaxShaderCompilerThreadsKHR(0xffffffff);
+  }
+
+#ifdef LOVR_ENABLE_FILESYSTEM
+  // Program binaries are only valid for the exact driver that produced them
+  if (shaderCache && (GLAD_GL_ARB_get_program_binary || GLAD_GL_ES_VERSION_3_0)) {
+    int formatCount;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    state.shaderCache = formatCount > 0;
+
+    int version[3] = { LOVR_VERSION_MAJOR, LOVR_VERSION_MINOR, LOVR_VERSION_PATCH };
+    GLenum strings[3] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+    state.driverHash = hash64(HASH_SEED, version, sizeof(version));
+    for (int i = 0; i < 3; i++) {
+      const char* string = (const char*) glGetString(strings[i]);
+      state.driverHash = string ? hash64(state.driverHash, string, strlen(string) + 1) : state.driverHash;
+    }
+  }
+#endif
+
   if (state.features.multiview && GLAD_GL_ES_VERSION_3_0) {
     state.singlepass = MULTIVIEW;
   } else if (state.features.instancedStereo) {
@@ -1041,6 +1267,7 @@ void lovrGpuInit(getProcAddressProc getProcAddress) {
   glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &state.limits.blockAlign);
   glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &state.limits.textureAnisotropy);
   glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
 
 #ifdef LOVR_GLES
   glEnable(GL_PRIMITIVE_RESTART_FIXED_INDEX);
@@ -1091,6 +1318,9 @@ void lovrGpuInit(getProcAddressProc getProcAddress) {
     arr_init(&state.incoherents[i]);
   }
 
+  arr_init(&state.streamingTextures);
+  state.textureStreamBudget = DEFAULT_TEXTURE_STREAM_BUDGET;
+
   TextureData* textureData = lovrTextureDataCreate(1, 1, 0xff, FORMAT_RGBA);
   state.defaultTexture = lovrTextureCreate(TEXTURE_2D, &textureData, 1, true, false, 0);
   lovrTextureSetFilter(state.defaultTexture, (TextureFilter) { .mode = FILTER_NEAREST });
@@ -1109,6 +1339,19 @@ void lovrGpuDestroy() {
   for (int i = 0; i < MAX_BARRIERS; i++) {
     arr_free(&state.incoherents[i]);
   }
+  arr_free(&state.streamingTextures);
+  for (uint32_t i = 0; i < state.uploadCount; i++) {
+    glDeleteSync(state.uploads[(state.uploadHead + i) % MAX_PENDING_UPLOADS].fence);
+  }
+  lovrRelease(Buffer, state.uploadBuffer);
+#ifndef LOVR_WEBGL
+  if (state.timerQueries[0].begin) {
+    for (uint32_t i = 0; i < MAX_TIMER_QUERIES; i++) {
+      glDeleteQueries(2, &state.timerQueries[i].begin);
+    }
+  }
+#endif
+  map_deinit(&state.zoneMap);
   memset(&state, 0, sizeof(state));
 }
 
@@ -1185,7 +1428,6 @@ void lovrGpuDraw(DrawCommand* draw) {
   float w = state.singlepass == MULTIVIEW ? draw->canvas->width : draw->canvas->width / (float) viewportCount;
   float h = draw->canvas->height;
   float viewports[2][4] = { { 0.f, 0.f, w, h }, { w, 0.f, w, h } };
-  lovrShaderSetInts(draw->shader, "lovrViewportCount", &(int) { viewportCount }, 0, 1);
 
   lovrGpuBindCanvas(draw->canvas, true);
   lovrGpuBindPipeline(&draw->pipeline);
@@ -1193,8 +1435,9 @@ void lovrGpuDraw(DrawCommand* draw) {
 
   for (uint32_t i = 0; i < drawCount; i++) {
     lovrGpuSetViewports(&viewports[i][0], viewportsPerDraw);
-    lovrShaderSetInts(draw->shader, "lovrViewID", &(int) { i }, 0, 1);
     lovrGpuBindShader(draw->shader);
+    lovrGpuSetBuiltinUniform(draw->shader->viewportCountLocation, &draw->shader->viewportCount, viewportCount);
+    lovrGpuSetBuiltinUniform(draw->shader->viewIdLocation, &draw->shader->viewId, i);
 
     Mesh* mesh = draw->mesh;
     GLenum topology = convertTopology(draw->topology);
@@ -1214,12 +1457,135 @@ void lovrGpuDraw(DrawCommand* draw) {
       }
     }
 
+    // Meshes without their own vertex buffer (like Model meshes) don't know their vertex count, so
+    // their index count is used instead
+    if (mesh->indexCount > 0) {
+      uint32_t vertexCount = draw->vertexCount > 0 ? draw->vertexCount : draw->rangeCount;
+      state.stats.indices += (uint64_t) draw->rangeCount * instances;
+      state.stats.vertices += (uint64_t) vertexCount * instances;
+    } else {
+      state.stats.vertices += (uint64_t) draw->rangeCount * instances;
+    }
+
     state.stats.drawCalls++;
   }
 }
 
+#ifndef LOVR_WEBGL
+// Zones are identified by their name and their parent, so the same label used in different places
+// shows up as separate entries in the hierarchy
+static uint32_t lovrGpuGetZone(const char* label, uint32_t parent) {
+  char key[LOVR_MAX_ZONE_NAME_LENGTH + 16];
+  snprintf(key, sizeof(key), "%u/%s", parent, label);
+
+  int* index = map_get(&state.zoneMap, key);
+  if (index) {
+    return *index;
+  }
+
+  lovrAssert(state.zoneCount < MAX_TIMER_ZONES, "Too many timer zones (the max is %d)", MAX_TIMER_ZONES);
+  TimerZone* zone = &state.zones[state.zoneCount];
+  memset(zone, 0, sizeof(*zone));
+  strncpy(zone->name, label, LOVR_MAX_ZONE_NAME_LENGTH - 1);
+  zone->parent = parent;
+  zone->depth = state.timerDepth;
+  map_set(&state.zoneMap, key, state.zoneCount);
+  return state.zoneCount++;
+}
+
+// Timestamps are written in order, so queries are read back oldest first.  Nothing blocks: results
+// that aren't available yet are picked up on a later frame.
+static void lovrGpuResolveTimers() {
+  while (state.timerCount > 0) {
+    TimerQuery* query = &state.timerQueries[state.timerHead];
+    if (!query->ended) {
+      break;
+    }
+
+    GLuint available;
+    glGetQueryObjectuiv(query->end, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) {
+      break;
+    }
+
+    uint64_t begin, end;
+    glGetQueryObjectui64v(query->begin, GL_QUERY_RESULT, &begin);
+    glGetQueryObjectui64v(query->end, GL_QUERY_RESULT, &end);
+
+    TimerZone* zone = &state.zones[query->zone];
+    zone->last = (end - begin) / 1e9;
+    zone->samples[zone->nextSample] = zone->last;
+    zone->nextSample = (zone->nextSample + 1) % TIMER_WINDOW;
+    zone->sampleCount = MIN(zone->sampleCount + 1, TIMER_WINDOW);
+
+    state.timerHead = (state.timerHead + 1) % MAX_TIMER_QUERIES;
+    state.timerCount--;
+  }
+}
+#endif
+
+static void lovrTextureUploadStreamLevel(Texture* texture) {
+  uint32_t level = --texture->streamLevel;
+  TextureData* textureData = texture->streamData;
+  Mipmap* m = &textureData->mipmaps[level];
+  GLenum glInternalFormat = convertTextureFormatInternal(textureData->format, texture->srgb);
+  lovrGpuBindTexture(texture, 0);
+  glCompressedTexImage2D(texture->target, level, glInternalFormat, m->width, m->height, 0, (GLsizei) m->size, m->data);
+  glTexParameteri(texture->target, GL_TEXTURE_BASE_LEVEL, level);
+  state.stats.textureBytes += m->size;
+}
+
+static void lovrTextureStopStream(Texture* texture) {
+  if (!texture->streamData) {
+    return;
+  }
+
+  for (size_t i = 0; i < state.streamingTextures.length; i++) {
+    if (state.streamingTextures.data[i] == texture) {
+      state.streamingTextures.data[i] = state.streamingTextures.data[--state.streamingTextures.length];
+      break;
+    }
+  }
+
+  lovrRelease(TextureData, texture->streamData);
+  texture->streamData = NULL;
+}
+
+// Uploads the next mipmap levels of streaming textures, up to the per-frame byte budget.  At least
+// one level is uploaded each frame, even if it's bigger than the budget, so streaming always ends.
+static void lovrGpuStreamTextures() {
+  size_t spent = 0;
+  while (state.streamingTextures.length > 0) {
+    Texture* texture = state.streamingTextures.data[0];
+    size_t size = texture->streamData->mipmaps[texture->streamLevel - 1].size;
+    if (spent > 0 && spent + size > state.textureStreamBudget) {
+      break;
+    }
+
+    lovrTextureUploadStreamLevel(texture);
+    spent += size;
+
+    if (texture->streamLevel == 0) {
+      lovrTextureStopStream(texture);
+    }
+  }
+}
+
 void lovrGpuPresent() {
+  state.statsHistory[state.statsFrame++ % MAX_STATS_HISTORY] = state.stats;
   memset(&state.stats, 0, sizeof(state.stats));
+#ifndef LOVR_WEBGL
+  lovrGpuResolveTimers();
+#endif
+  lovrGpuStreamTextures();
+}
+
+size_t lovrGpuGetTextureStreamBudget() {
+  return state.textureStreamBudget;
+}
+
+void lovrGpuSetTextureStreamBudget(size_t budget) {
+  state.textureStreamBudget = budget;
 }
 
 void lovrGpuStencil(StencilAction action, int replaceValue, StencilCallback callback, void* userdata) {
@@ -1257,50 +1623,93 @@ void lovrGpuStencil(StencilAction action, int replaceValue, StencilCallback call
 void lovrGpuDirtyTexture() {
   lovrRelease(Texture, state.textures[state.activeTexture]);
   state.textures[state.activeTexture] = NULL;
+  state.textureGeneration++;
 }
 
 void lovrGpuTick(const char* label) {
 #ifndef LOVR_WEBGL
-  TimerList* timer = map_get(&state.timers, label);
+  if (!state.features.timers) {
+    return;
+  }
+
+  lovrAssert(state.timerDepth < MAX_TIMER_DEPTH, "Timers can only be nested %d levels deep", MAX_TIMER_DEPTH);
 
-  if (!timer) {
-    map_set(&state.timers, label, ((TimerList) { .oldest = 0 }));
-    timer = map_get(&state.timers, label);
-    glGenQueries(sizeof(timer->timers) / sizeof(timer->timers[0]), timer->timers);
+  if (!state.timerQueries[0].begin) {
+    for (uint32_t i = 0; i < MAX_TIMER_QUERIES; i++) {
+      glGenQueries(2, &state.timerQueries[i].begin);
+    }
   }
 
-  glBeginQuery(GL_TIME_ELAPSED, timer->timers[timer->next]);
+  uint32_t parent = state.timerDepth > 0 ? state.zoneStack[state.timerDepth - 1] : ~0u;
+  uint32_t zone = lovrGpuGetZone(label, parent);
 
-  size_t next = (timer->next + 1) % 4;
-  if (next != timer->oldest) {
-    timer->next = next;
+  // If every query is in flight, this sample is dropped instead of stalling
+  uint32_t slot = ~0u;
+  lovrGpuResolveTimers();
+  if (state.timerCount < MAX_TIMER_QUERIES) {
+    slot = (state.timerHead + state.timerCount++) % MAX_TIMER_QUERIES;
+    TimerQuery* query = &state.timerQueries[slot];
+    query->zone = zone;
+    query->ended = false;
+    glQueryCounter(query->begin, GL_TIMESTAMP);
   }
+
+  state.zoneStack[state.timerDepth] = zone;
+  state.queryStack[state.timerDepth] = slot;
+  state.timerDepth++;
 #endif
 }
 
 double lovrGpuTock(const char* label) {
 #ifndef LOVR_WEBGL
-  TimerList* timer = map_get(&state.timers, label);
-  if (!timer) return 0.;
+  if (!state.features.timers || state.timerDepth == 0) {
+    return 0.;
+  }
 
-  glEndQuery(GL_TIME_ELAPSED);
+  // The zone is only popped once the label matches, so a mismatch leaves the stack intact
+  uint32_t depth = state.timerDepth - 1;
+  TimerZone* zone = &state.zones[state.zoneStack[depth]];
+  uint32_t slot = state.queryStack[depth];
+  lovrAssert(!strcmp(zone->name, label), "Trying to stop timer '%s', but the active timer is '%s'", label, zone->name);
+  state.timerDepth = depth;
 
-  while (timer->oldest != timer->next) {
-    GLuint available;
-    glGetQueryObjectuiv(timer->timers[timer->oldest], GL_QUERY_RESULT_AVAILABLE, &available);
-    if (!available) {
-      break;
-    }
-
-    glGetQueryObjectui64v(timer->timers[timer->oldest], GL_QUERY_RESULT, &timer->ns);
-    timer->oldest = (timer->oldest + 1) % 4;
+  if (slot != ~0u) {
+    glQueryCounter(state.timerQueries[slot].end, GL_TIMESTAMP);
+    state.timerQueries[slot].ended = true;
   }
 
-  return timer->ns / 1e9;
+  lovrGpuResolveTimers();
+  return zone->last;
 #endif
   return 0.;
 }
 
+uint32_t lovrGpuGetZoneCount() {
+  return state.zoneCount;
+}
+
+void lovrGpuGetZoneStats(uint32_t index, GpuZoneStats* stats) {
+  lovrAssert(index < state.zoneCount, "Invalid timer zone index %d", index);
+  TimerZone* zone = &state.zones[index];
+  *stats = (GpuZoneStats) {
+    .name = zone->name,
+    .parent = zone->parent,
+    .depth = zone->depth,
+    .samples = zone->sampleCount,
+    .last = zone->last
+  };
+
+  if (zone->sampleCount > 0) {
+    stats->min = stats->max = zone->samples[0];
+    for (uint32_t i = 0; i < zone->sampleCount; i++) {
+      stats->min = MIN(stats->min, zone->samples[i]);
+      stats->max = MAX(stats->max, zone->samples[i]);
+      stats->average += zone->samples[i];
+    }
+    stats->average /= zone->sampleCount;
+  }
+}
+
 const GpuFeatures* lovrGpuGetFeatures() {
   return &state.features;
 }
@@ -1309,10 +1718,19 @@ const GpuLimits* lovrGpuGetLimits() {
   return &state.limits;
 }
 
-const GpuStats* lovrGpuGetStats() {
+GpuStats* lovrGpuGetStats() {
   return &state.stats;
 }
 
+// Stats for a previously presented frame, where 1 is the most recent one
+const GpuStats* lovrGpuGetStatsHistory(uint32_t frame) {
+  if (frame < 1 || frame > MIN(state.statsFrame, MAX_STATS_HISTORY)) {
+    return NULL;
+  }
+
+  return &state.statsHistory[(state.statsFrame - frame) % MAX_STATS_HISTORY];
+}
+
 // Texture
 
 Texture* lovrTextureInit(Texture* texture, TextureType type, TextureData** slices, uint32_t sliceCount, bool srgb, bool mipmaps, uint32_t msaa) {
@@ -1334,7 +1752,7 @@ Texture* lovrTextureInit(Texture* texture, TextureType type, TextureData** slice
   if (sliceCount > 0) {
     lovrTextureAllocate(texture, slices[0]->width, slices[0]->height, sliceCount, slices[0]->format);
     for (uint32_t i = 0; i < sliceCount; i++) {
-      lovrTextureReplacePixels(texture, slices[i], 0, 0, i, 0);
+      lovrTextureReplacePixels(texture, slices[i], 0, 0, i, 0, false);
     }
   }
 
@@ -1360,6 +1778,7 @@ Texture* lovrTextureInitFromHandle(Texture* texture, uint32_t handle, TextureTyp
 
 void lovrTextureDestroy(void* ref) {
   Texture* texture = ref;
+  lovrTextureStopStream(texture);
   glDeleteTextures(1, &texture->id);
   glDeleteRenderbuffers(1, &texture->msaaId);
   lovrGpuDestroySyncResource(texture, texture->incoherent);
@@ -1434,7 +1853,7 @@ void lovrTextureAllocate(Texture* texture, uint32_t width, uint32_t height, uint
   }
 }
 
-void lovrTextureReplacePixels(Texture* texture, TextureData* textureData, uint32_t x, uint32_t y, uint32_t slice, uint32_t mipmap) {
+void lovrTextureReplacePixels(Texture* texture, TextureData* textureData, uint32_t x, uint32_t y, uint32_t slice, uint32_t mipmap, bool async) {
   lovrGraphicsFlush();
   lovrAssert(texture->allocated, "Texture is not allocated");
 
@@ -1459,8 +1878,36 @@ void lovrTextureReplacePixels(Texture* texture, TextureData* textureData, uint32
   if (isTextureFormatCompressed(textureData->format)) {
     lovrAssert(width == maxWidth && height == maxHeight, "Compressed texture pixels must be fully replaced");
     lovrAssert(mipmap == 0, "Unable to replace a specific mipmap of a compressed texture");
+    lovrTextureStopStream(texture);
+
+    // Async uploads of 2D mipmap chains stream in over the next frames, smallest levels first.  The
+    // small levels are uploaded right away so the texture is usable immediately.
+    if (async && texture->type == TEXTURE_2D && textureData->mipmapCount > 1 && state.textureStreamBudget > 0) {
+      lovrRetain(textureData);
+      texture->streamData = textureData;
+      texture->streamLevel = textureData->mipmapCount;
+      glTexParameteri(texture->target, GL_TEXTURE_MAX_LEVEL, textureData->mipmapCount - 1);
+      while (texture->streamLevel > 0) {
+        Mipmap* next = &textureData->mipmaps[texture->streamLevel - 1];
+        if (texture->streamLevel < textureData->mipmapCount && MAX(next->width, next->height) > MIN_STREAMED_MIPMAP_SIZE) {
+          break;
+        }
+        lovrTextureUploadStreamLevel(texture);
+      }
+
+      if (texture->streamLevel > 0) {
+        arr_push(&state.streamingTextures, texture);
+      } else {
+        lovrTextureStopStream(texture);
+      }
+      return;
+    }
+
+    glTexParameteri(texture->target, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(texture->target, GL_TEXTURE_MAX_LEVEL, 1000);
     for (uint32_t i = 0; i < textureData->mipmapCount; i++) {
       Mipmap* m = textureData->mipmaps + i;
+      state.stats.textureBytes += m->size;
       switch (texture->type) {
         case TEXTURE_2D:
         case TEXTURE_CUBE:
@@ -1475,19 +1922,63 @@ void lovrTextureReplacePixels(Texture* texture, TextureData* textureData, uint32
   } else {
     lovrAssert(textureData->blob.data, "Trying to replace Texture pixels with empty pixel data");
     GLenum glType = convertTextureFormatType(textureData->format);
+    const void* pixels = textureData->blob.data;
+    state.stats.textureBytes += textureData->blob.size;
+
+#ifndef LOVR_WEBGL
+    // Async uploads copy the pixels into the upload ring and have the driver read them from there,
+    // instead of making it copy all of the client memory before glTexSubImage returns
+    size_t uploadSize = textureData->blob.size;
+    size_t uploadOffset = 0;
+    async = async && uploadSize <= UPLOAD_BUFFER_SIZE;
+    if (async) {
+      uploadOffset = lovrGpuAllocateUpload(uploadSize);
+      memcpy(lovrBufferMap(state.uploadBuffer, uploadOffset), pixels, uploadSize);
+      lovrBufferFlush(state.uploadBuffer, uploadOffset, uploadSize);
+      lovrBufferUnmap(state.uploadBuffer);
+      lovrGpuBindBuffer(BUFFER_UPLOAD, state.uploadBuffer->id);
+      pixels = (void*) uploadOffset;
+    }
+#endif
 
     switch (texture->type) {
       case TEXTURE_2D:
       case TEXTURE_CUBE:
-        glTexSubImage2D(binding, mipmap, x, y, width, height, glFormat, glType, textureData->blob.data);
+        glTexSubImage2D(binding, mipmap, x, y, width, height, glFormat, glType, pixels);
         break;
       case TEXTURE_ARRAY:
       case TEXTURE_VOLUME:
-        glTexSubImage3D(binding, mipmap, x, y, slice, width, height, 1, glFormat, glType, textureData->blob.data);
+        glTexSubImage3D(binding, mipmap, x, y, slice, width, height, 1, glFormat, glType, pixels);
         break;
     }
 
-    if (texture->mipmaps) {
+#ifndef LOVR_WEBGL
+    // Client memory uploads (and everything else using unpack state) expect the PBO to be unbound
+    if (async) {
+      lovrGpuBindBuffer(BUFFER_UPLOAD, 0);
+      texture->upload = lovrGpuSubmitUpload(uploadOffset, uploadSize);
+    }
+#endif
+
+    // Mipmaps computed on the CPU (TextureData:generateMipmaps) are used instead of glGenerateMipmap
+    bool fullUpload = mipmap == 0 && x == 0 && y == 0 && width == maxWidth && height == maxHeight;
+    bool mipmapChain = texture->mipmaps && fullUpload && texture->type != TEXTURE_VOLUME && textureData->mipmapCount >= texture->mipmapCount;
+    for (uint32_t i = 1; mipmapChain && i < texture->mipmapCount; i++) {
+      Mipmap* m = textureData->mipmaps + i;
+      state.stats.textureBytes += m->size;
+      switch (texture->type) {
+        case TEXTURE_2D:
+        case TEXTURE_CUBE:
+          glTexSubImage2D(binding, i, 0, 0, m->width, m->height, glFormat, glType, m->data);
+          break;
+        case TEXTURE_ARRAY:
+        case TEXTURE_VOLUME:
+          glTexSubImage3D(binding, i, 0, 0, slice, m->width, m->height, 1, glFormat, glType, m->data);
+          break;
+      }
+    }
+
+    if (texture->mipmaps && !mipmapChain) {
 #if defined(__APPLE__) || defined(LOVR_WEBGL) // glGenerateMipmap doesn't work on big cubemap textures on macOS
       if (texture->type != TEXTURE_CUBE || width < 2048) {
         glGenerateMipmap(texture->target);
@@ -1501,6 +1992,13 @@ void lovrTextureReplacePixels(Texture* texture, TextureData* textureData, uint32
   }
 }
 
+bool lovrTextureIsReady(Texture* texture) {
+#ifndef LOVR_WEBGL
+  while (state.uploadCount > 0 && lovrGpuRetireUpload(false));
+#endif
+  return texture->upload <= state.uploadsCompleted && !texture->streamData;
+}
+
 void lovrTextureSetFilter(Texture* texture, TextureFilter filter) {
   lovrGraphicsFlush();
   float anisotropy = filter.mode == FILTER_ANISOTROPIC ? MAX(filter.anisotropy, 1.f) : 1.f;
@@ -1662,31 +2160,124 @@ void lovrCanvasResolve(Canvas* canvas) {
   canvas->needsResolve = false;
 }
 
-TextureData* lovrCanvasNewTextureData(Canvas* canvas, uint32_t index) {
+// Validates the region before anything is allocated for it
+static void lovrCanvasCheckRegion(Canvas* canvas, uint32_t x, uint32_t y, uint32_t width, uint32_t height, TextureFormat format) {
+  lovrAssert(x <= canvas->width && width <= canvas->width - x, "Trying to read pixels outside the Canvas's bounds");
+  lovrAssert(y <= canvas->height && height <= canvas->height - y, "Trying to read pixels outside the Canvas's bounds");
+  lovrAssert(!isTextureFormatCompressed(format) && !isTextureFormatDepth(format), "Canvas pixels can not be read into compressed or depth formats");
+}
+
+// Reads a region of a Canvas attachment into client memory, or into the bound pixel pack buffer
+static void lovrCanvasReadPixels(Canvas* canvas, uint32_t index, uint32_t x, uint32_t y, uint32_t width, uint32_t height, TextureFormat format, void* data) {
   lovrGraphicsFlushCanvas(canvas);
+  lovrCanvasResolve(canvas);
   lovrGpuBindCanvas(canvas, false);
 
+  // Multisampled pixels can't be read directly, so they're read from the resolve framebuffer
+  if (canvas->flags.msaa && canvas->resolveBuffer) {
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, canvas->resolveBuffer);
+  }
+
 #ifndef LOVR_WEBGL
+  // Canvases created from a handle (like the window) don't have textures
   Texture* texture = canvas->attachments[index].texture;
-  if ((texture->incoherent >> BARRIER_TEXTURE) & 1) {
+  if (texture && (texture->incoherent >> BARRIER_TEXTURE) & 1) {
     lovrGpuSync(1 << BARRIER_TEXTURE);
   }
 #endif
 
   if (index != 0) {
-    glReadBuffer(index);
+    glReadBuffer(GL_COLOR_ATTACHMENT0 + index);
   }
 
-  TextureData* textureData = lovrTextureDataCreate(canvas->width, canvas->height, 0x0, FORMAT_RGBA);
-  glReadPixels(0, 0, canvas->width, canvas->height, GL_RGBA, GL_UNSIGNED_BYTE, textureData->blob.data);
+  glReadPixels(x, y, width, height, convertTextureFormat(format), convertTextureFormatType(format), data);
 
   if (index != 0) {
-    glReadBuffer(0);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
   }
 
+  if (canvas->flags.msaa && canvas->resolveBuffer) {
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, canvas->framebuffer);
+  }
+}
+
+TextureData* lovrCanvasNewTextureData(Canvas* canvas, uint32_t index, uint32_t x, uint32_t y, uint32_t width, uint32_t height, TextureFormat format) {
+  lovrCanvasCheckRegion(canvas, x, y, width, height, format);
+  TextureData* textureData = lovrTextureDataCreate(width, height, 0x0, format);
+  lovrCanvasReadPixels(canvas, index, x, y, width, height, format, textureData->blob.data);
   return textureData;
 }
 
+// Readback
+
+Readback* lovrReadbackInit(Readback* readback, Canvas* canvas, uint32_t index, uint32_t x, uint32_t y, uint32_t width, uint32_t height, TextureFormat format) {
+  lovrCanvasCheckRegion(canvas, x, y, width, height, format);
+  readback->textureData = lovrTextureDataCreate(width, height, 0x0, format);
+
+#ifdef LOVR_WEBGL
+  lovrCanvasReadPixels(canvas, index, x, y, width, height, format, readback->textureData->blob.data);
+#else
+  // The pixels get copied into a buffer on the GPU timeline, a fence says when they can be mapped
+  glGenBuffers(1, &readback->buffer);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, readback->buffer);
+  glBufferData(GL_PIXEL_PACK_BUFFER, readback->textureData->blob.size, NULL, GL_STREAM_READ);
+  lovrCanvasReadPixels(canvas, index, x, y, width, height, format, NULL);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  readback->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+#endif
+
+  return readback;
+}
+
+void lovrReadbackDestroy(void* ref) {
+  Readback* readback = ref;
+#ifndef LOVR_WEBGL
+  if (readback->fence) {
+    glDeleteSync(readback->fence);
+    glDeleteBuffers(1, &readback->buffer);
+  }
+#endif
+  lovrRelease(TextureData, readback->textureData);
+}
+
+#ifndef LOVR_WEBGL
+static void lovrReadbackFinish(Readback* readback) {
+  size_t size = readback->textureData->blob.size;
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, readback->buffer);
+  void* data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+  memcpy(readback->textureData->blob.data, data, size);
+  glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  glDeleteBuffers(1, &readback->buffer);
+  glDeleteSync(readback->fence);
+  readback->buffer = 0;
+  readback->fence = NULL;
+}
+#endif
+
+bool lovrReadbackIsComplete(Readback* readback) {
+#ifndef LOVR_WEBGL
+  if (readback->fence) {
+    if (glClientWaitSync(readback->fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0) == GL_TIMEOUT_EXPIRED) {
+      return false;
+    }
+
+    lovrReadbackFinish(readback);
+  }
+#endif
+  return true;
+}
+
+TextureData* lovrReadbackGetTextureData(Readback* readback) {
+#ifndef LOVR_WEBGL
+  if (readback->fence) {
+    while (glClientWaitSync(readback->fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED);
+    lovrReadbackFinish(readback);
+  }
+#endif
+  return readback->textureData;
+}
+
 // Buffer
 
 Buffer* lovrBufferInit(Buffer* buffer, size_t size, void* data, BufferType type, BufferUsage usage, bool readable) {
@@ -1725,12 +2316,16 @@ void lovrBufferDestroy(void* ref) {
   glDeleteBuffers(1, &buffer->id);
 #ifdef LOVR_WEBGL
   free(buffer->data);
+#else
+  if (buffer->shadow) {
+    free(buffer->data);
+  }
 #endif
 }
 
 void* lovrBufferMap(Buffer* buffer, size_t offset) {
 #ifndef LOVR_WEBGL
-  if (!GLAD_GL_ARB_buffer_storage && !buffer->mapped) {
+  if (!GLAD_GL_ARB_buffer_storage && !buffer->mapped && !buffer->shadow) {
     buffer->mapped = true;
     lovrGpuBindBuffer(buffer->type, buffer->id);
     GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT | GL_MAP_UNSYNCHRONIZED_BIT | (buffer->readable ? GL_MAP_READ_BIT : 0);
@@ -1740,42 +2335,116 @@ void* lovrBufferMap(Buffer* buffer, size_t offset) {
   return (uint8_t*) buffer->data + offset;
 }
 
+// Returns a pointer to the Buffer's contents that stays valid for the lifetime of the Buffer.  If
+// the Buffer can't be persistently mapped, it switches to a CPU-side copy that gets uploaded when
+// the Buffer is unmapped.
+void* lovrBufferGetPointer(Buffer* buffer) {
+#ifndef LOVR_WEBGL
+  if (!GLAD_GL_ARB_buffer_storage && !buffer->shadow) {
+    lovrBufferUnmap(buffer);
+    void* shadow = malloc(buffer->size);
+    lovrAssert(shadow, "Out of memory");
+    lovrGpuBindBuffer(buffer->type, buffer->id);
+    GLenum glType = convertBufferType(buffer->type);
+    void* contents = glMapBufferRange(glType, 0, buffer->size, GL_MAP_READ_BIT);
+    memcpy(shadow, contents, buffer->size);
+    glUnmapBuffer(glType);
+    buffer->data = shadow;
+    buffer->shadow = true;
+  }
+#endif
+  return buffer->data;
+}
+
+// Dirty ranges that overlap or touch are merged.  Once all of the slots are used, the new range is
+// merged into whichever existing range is closest to it.
 void lovrBufferFlush(Buffer* buffer, size_t offset, size_t size) {
-  buffer->flushFrom = MIN(buffer->flushFrom, offset);
-  buffer->flushTo = MAX(buffer->flushTo, offset + size);
+  if (size == 0) {
+    return;
+  }
+
+  BufferRange range = { offset, offset + size };
+
+  for (uint32_t i = 0; i < buffer->flushCount;) {
+    BufferRange* other = &buffer->flushes[i];
+    if (range.start <= other->end && other->start <= range.end) {
+      range.start = MIN(range.start, other->start);
+      range.end = MAX(range.end, other->end);
+      *other = buffer->flushes[--buffer->flushCount];
+    } else {
+      i++;
+    }
+  }
+
+  if (buffer->flushCount == MAX_BUFFER_RANGES) {
+    uint32_t closest = 0;
+    size_t minGap = SIZE_MAX;
+    for (uint32_t i = 0; i < buffer->flushCount; i++) {
+      BufferRange* other = &buffer->flushes[i];
+      size_t gap = other->start > range.end ? other->start - range.end : range.start - other->end;
+      if (gap < minGap) {
+        minGap = gap;
+        closest = i;
+      }
+    }
+
+    range.start = MIN(range.start, buffer->flushes[closest].start);
+    range.end = MAX(range.end, buffer->flushes[closest].end);
+    buffer->flushes[closest] = buffer->flushes[--buffer->flushCount];
+  }
+
+  buffer->flushes[buffer->flushCount++] = range;
 }
 
 void lovrBufferUnmap(Buffer* buffer) {
+  GLenum glType = convertBufferType(buffer->type);
 #ifdef LOVR_WEBGL
-  if (buffer->flushTo > buffer->flushFrom) {
+  if (buffer->flushCount > 0) {
     lovrGpuBindBuffer(buffer->type, buffer->id);
-    void* data = (uint8_t*) buffer->data + buffer->flushFrom;
-    glBufferSubData(convertBufferType(buffer->type), buffer->flushFrom, buffer->flushTo - buffer->flushFrom, data);
+    for (uint32_t i = 0; i < buffer->flushCount; i++) {
+      BufferRange* range = &buffer->flushes[i];
+      glBufferSubData(glType, range->start, range->end - range->start, (uint8_t*) buffer->data + range->start);
+    }
   }
 #else
-  if (buffer->mapped || GLAD_GL_ARB_buffer_storage) {
+  if (buffer->shadow) {
+    if (buffer->flushCount > 0) {
+      lovrGpuBindBuffer(buffer->type, buffer->id);
+      for (uint32_t i = 0; i < buffer->flushCount; i++) {
+        BufferRange* range = &buffer->flushes[i];
+        glBufferSubData(glType, range->start, range->end - range->start, (uint8_t*) buffer->data + range->start);
+      }
+    }
+  } else if (buffer->mapped || GLAD_GL_ARB_buffer_storage) {
     lovrGpuBindBuffer(buffer->type, buffer->id);
 
-    if (buffer->flushTo > buffer->flushFrom) {
-      glFlushMappedBufferRange(convertBufferType(buffer->type), buffer->flushFrom, buffer->flushTo - buffer->flushFrom);
+    for (uint32_t i = 0; i < buffer->flushCount; i++) {
+      BufferRange* range = &buffer->flushes[i];
+      glFlushMappedBufferRange(glType, range->start, range->end - range->start);
     }
 
     if (buffer->mapped) {
-      glUnmapBuffer(convertBufferType(buffer->type));
+      glUnmapBuffer(glType);
       buffer->mapped = false;
     }
   }
 #endif
-  buffer->flushFrom = SIZE_MAX;
-  buffer->flushTo = 0;
+  buffer->flushCount = 0;
 }
 
 void lovrBufferDiscard(Buffer* buffer) {
+  state.stats.bufferDiscards++;
   lovrGpuBindBuffer(buffer->type, buffer->id);
   GLenum glType = convertBufferType(buffer->type);
 #ifdef LOVR_WEBGL
   glBufferData(glType, buffer->size, NULL, convertBufferUsage(buffer->usage));
 #else
+  // Shadowed Buffers keep their CPU copy, so orphaning the storage is enough
+  if (buffer->shadow) {
+    glBufferData(glType, buffer->size, NULL, convertBufferUsage(buffer->usage));
+    return;
+  }
+
   // We unmap even if persistent mapping is supported
   if (buffer->mapped || GLAD_GL_ARB_buffer_storage) {
     glUnmapBuffer(glType);
@@ -1798,44 +2467,122 @@ static GLuint compileShader(GLenum type, const char** sources, int count) {
   GLuint shader = glCreateShader(type);
   glShaderSource(shader, count, sources, NULL);
   glCompileShader(shader);
+  return shader;
+}
 
+// Returns the error message, which the caller frees, or NULL if the shader compiled
+static char* checkShader(GLuint shader, GLenum type) {
   int isShaderCompiled;
   glGetShaderiv(shader, GL_COMPILE_STATUS, &isShaderCompiled);
-  if (!isShaderCompiled) {
-    int logLength;
-    glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
-    char* log = malloc(logLength);
-    lovrAssert(log, "Out of memory");
-    glGetShaderInfoLog(shader, logLength, &logLength, log);
-    const char* name;
-    switch (type) {
-      case GL_VERTEX_SHADER: name = "vertex shader"; break;
-      case GL_FRAGMENT_SHADER: name = "fragment shader"; break;
-      case GL_COMPUTE_SHADER: name = "compute shader"; break;
-      default: name = "shader"; break;
-    }
-    lovrThrow("Could not compile %s:\n%s", name, log);
+  if (isShaderCompiled) {
+    return NULL;
   }
 
-  return shader;
-}
+  const char* name;
+  switch (type) {
+    case GL_VERTEX_SHADER: name = "vertex shader"; break;
+    case GL_FRAGMENT_SHADER: name = "fragment shader"; break;
+    case GL_COMPUTE_SHADER: name = "compute shader"; break;
+    default: name = "shader"; break;
+  }
 
-static GLuint linkProgram(GLuint program) {
-  glLinkProgram(program);
+  int logLength;
+  glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
+  size_t prefixLength = strlen("Could not compile :\n") + strlen(name);
+  char* error = malloc(prefixLength + logLength + 1);
+  lovrAssert(error, "Out of memory");
+  snprintf(error, prefixLength + 1, "Could not compile %s:\n", name);
+  error[prefixLength] = '\0';
+  glGetShaderInfoLog(shader, logLength + 1, NULL, error + prefixLength);
+  return error;
+}
 
+static char* checkProgram(GLuint program) {
   int isLinked;
   glGetProgramiv(program, GL_LINK_STATUS, &isLinked);
-  if (!isLinked) {
-    int logLength;
-    glGetProgramiv(program, GL_INFO_LOG_LENGTH, &logLength);
-    char* log = malloc(logLength);
-    lovrAssert(log, "Out of memory");
-    glGetProgramInfoLog(program, logLength, &logLength, log);
-    lovrThrow("Could not link shader:\n%s", log);
+  if (isLinked) {
+    return NULL;
+  }
+
+  int logLength;
+  glGetProgramiv(program, GL_INFO_LOG_LENGTH, &logLength);
+  size_t prefixLength = strlen("Could not link shader:\n");
+  char* error = malloc(prefixLength + logLength + 1);
+  lovrAssert(error, "Out of memory");
+  memcpy(error, "Could not link shader:\n", prefixLength + 1);
+  glGetProgramInfoLog(program, logLength + 1, NULL, error + prefixLength);
+  return error;
+}
+
+static void throwShaderError(char* error) {
+  if (error) {
+    lovrThrow("%s", error);
+  }
+}
+
+#ifdef LOVR_ENABLE_FILESYSTEM
+static uint64_t lovrShaderGetCacheKey(const char** vertexSources, int vertexCount, const char** fragmentSources, int fragmentCount, bool multiview) {
+  uint64_t key = hash64(state.driverHash, &multiview, sizeof(multiview));
+  for (int i = 0; i < vertexCount; i++) {
+    key = hash64(key, vertexSources[i], strlen(vertexSources[i]) + 1);
+  }
+  for (int i = 0; i < fragmentCount; i++) {
+    key = hash64(key, fragmentSources[i], strlen(fragmentSources[i]) + 1);
+  }
+  return key;
+}
+
+static bool lovrShaderLoadBinary(GLuint program, uint64_t key) {
+  char path[64];
+  snprintf(path, sizeof(path), SHADER_CACHE_DIRECTORY "/%016" PRIx64, key);
+
+  size_t size;
+  uint8_t* data = lovrFilesystemRead(path, -1, &size);
+  if (!data) {
+    return false;
+  }
+
+  ProgramBinaryHeader* header = (ProgramBinaryHeader*) data;
+  bool valid = size > sizeof(ProgramBinaryHeader) && header->magic == SHADER_CACHE_MAGIC && header->key == key;
+
+  // The driver is allowed to reject binaries at any time (e.g. after an update), which leaves the
+  // program unlinked.  In that case it gets compiled from source and the cache entry is replaced.
+  if (valid) {
+    int isLinked;
+    glProgramBinary(program, header->format, data + sizeof(ProgramBinaryHeader), (GLsizei) (size - sizeof(ProgramBinaryHeader)));
+    glGetProgramiv(program, GL_LINK_STATUS, &isLinked);
+    valid = isLinked;
+  }
+
+  free(data);
+  return valid;
+}
+
+static void lovrShaderSaveBinary(GLuint program, uint64_t key) {
+  int length;
+  glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0) {
+    return;
+  }
+
+  size_t size = sizeof(ProgramBinaryHeader) + length;
+  uint8_t* data = malloc(size);
+  if (!data) {
+    return;
   }
 
-  return program;
+  ProgramBinaryHeader* header = (ProgramBinaryHeader*) data;
+  header->magic = SHADER_CACHE_MAGIC;
+  header->key = key;
+  glGetProgramBinary(program, length, NULL, &header->format, data + sizeof(ProgramBinaryHeader));
+
+  char path[64];
+  snprintf(path, sizeof(path), SHADER_CACHE_DIRECTORY "/%016" PRIx64, key);
+  lovrFilesystemCreateDirectory(SHADER_CACHE_DIRECTORY);
+  lovrFilesystemWrite(path, (const char*) data, size, false);
+  free(data);
 }
+#endif
 
 static void lovrShaderSetupUniforms(Shader* shader) {
   uint32_t program = shader->program;
@@ -1942,6 +2689,7 @@ static void lovrShaderSetupUniforms(Shader* shader) {
 #endif
     uniform.textureType = getUniformTextureType(glType);
     uniform.baseSlot = uniform.type == UNIFORM_SAMPLER ? textureSlot : (uniform.type == UNIFORM_IMAGE ? imageSlot : -1);
+    uniform.dirty = uniform.type == UNIFORM_SAMPLER || uniform.type == UNIFORM_IMAGE;
 
     int blockIndex;
     glGetActiveUniformsiv(program, 1, &i, GL_UNIFORM_BLOCK_INDEX, &blockIndex);
@@ -2027,6 +2775,15 @@ static void lovrShaderSetupUniforms(Shader* shader) {
     textureSlot += uniform.type == UNIFORM_SAMPLER ? uniform.count : 0;
     imageSlot += uniform.type == UNIFORM_IMAGE ? uniform.count : 0;
   }
+
+  shader->imageCount = imageSlot;
+  shader->dirty = true;
+
+  // Built-in uniforms that change between draws are resolved up front and set by location
+  shader->viewIdLocation = glGetUniformLocation(program, "lovrViewID");
+  shader->viewportCountLocation = glGetUniformLocation(program, "lovrViewportCount");
+  shader->viewId = 0;
+  shader->viewportCount = 0;
 }
 
 static char* lovrShaderGetFlagCode(ShaderFlag* flags, uint32_t flagCount) {
@@ -2064,7 +2821,60 @@ static char* lovrShaderGetFlagCode(ShaderFlag* flags, uint32_t flagCount) {
   return code;
 }
 
-Shader* lovrShaderInitGraphics(Shader* shader, const char* vertexSource, const char* fragmentSource, ShaderFlag* flags, uint32_t flagCount, bool multiview) {
+// Checks the results of compilation and does the work that needs a linked program.  For async
+// shaders this is deferred until the driver reports completion (or someone needs the shader).
+// This can run in the middle of a flush, so errors are stored on the Shader instead of thrown.
+static void lovrShaderFinishGraphics(Shader* shader) {
+  uint32_t program = shader->program;
+
+  if (shader->vertexShader) {
+    char* error = checkShader(shader->vertexShader, GL_VERTEX_SHADER);
+    error = error ? error : checkShader(shader->fragmentShader, GL_FRAGMENT_SHADER);
+    error = error ? error : checkProgram(program);
+    glDetachShader(program, shader->vertexShader);
+    glDeleteShader(shader->vertexShader);
+    glDetachShader(program, shader->fragmentShader);
+    glDeleteShader(shader->fragmentShader);
+    shader->vertexShader = shader->fragmentShader = 0;
+
+    if (error) {
+      shader->error = error;
+      shader->pending = false;
+      return;
+    }
+
+#ifdef LOVR_ENABLE_FILESYSTEM
+    if (state.shaderCache) {
+      lovrShaderSaveBinary(program, shader->cacheKey);
+    }
+#endif
+  }
+
+  shader->pending = false;
+
+  // Generic attributes
+  lovrGpuUseProgram(program);
+  glVertexAttrib4fv(LOVR_SHADER_VERTEX_COLOR, (float[4]) { 1., 1., 1., 1. });
+  glVertexAttribI4uiv(LOVR_SHADER_BONES, (uint32_t[4]) { 0., 0., 0., 0. });
+  glVertexAttrib4fv(LOVR_SHADER_BONE_WEIGHTS, (float[4]) { 1., 0., 0., 0. });
+  glVertexAttribI4ui(LOVR_SHADER_DRAW_ID, 0, 0, 0, 0);
+
+  lovrShaderSetupUniforms(shader);
+
+  // Attribute cache
+  int32_t attributeCount;
+  glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &attributeCount);
+  map_init(&shader->attributes);
+  for (int i = 0; i < attributeCount; i++) {
+    char name[LOVR_MAX_ATTRIBUTE_LENGTH];
+    GLint size;
+    GLenum type;
+    glGetActiveAttrib(program, i, LOVR_MAX_ATTRIBUTE_LENGTH, NULL, &size, &type, name);
+    map_set(&shader->attributes, name, glGetAttribLocation(program, name));
+  }
+}
+
+Shader* lovrShaderInitGraphics(Shader* shader, const char* vertexSource, const char* fragmentSource, ShaderFlag* flags, uint32_t flagCount, bool multiview, bool async) {
 #if defined(LOVR_WEBGL) || defined(LOVR_GLES)
   const char* version = "#version 300 es\n";
   const char* precision[2] = { "precision highp float;\nprecision highp int;\n", "precision mediump float;\nprecision mediump int;\n" };
@@ -2082,61 +2892,56 @@ Shader* lovrShaderInitGraphics(Shader* shader, const char* vertexSource, const c
   }
 
   char* flagSource = lovrShaderGetFlagCode(flags, flagCount);
-
-  // Vertex
   vertexSource = vertexSource == NULL ? lovrUnlitVertexShader : vertexSource;
-  const char* vertexSources[] = { version, singlepass[0], precision[0], flagSource ? flagSource : "", lovrShaderVertexPrefix, vertexSource, lovrShaderVertexSuffix };
-  GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSources, sizeof(vertexSources) / sizeof(vertexSources[0]));
-
-  // Fragment
   fragmentSource = fragmentSource == NULL ? lovrUnlitFragmentShader : fragmentSource;
+  const char* vertexSources[] = { version, singlepass[0], precision[0], flagSource ? flagSource : "", lovrShaderVertexPrefix, vertexSource, lovrShaderVertexSuffix };
   const char* fragmentSources[] = { version, singlepass[1], precision[1], flagSource ? flagSource : "", lovrShaderFragmentPrefix, fragmentSource, lovrShaderFragmentSuffix };
-  GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSources, sizeof(fragmentSources) / sizeof(fragmentSources[0]));
-
-  free(flagSource);
-
-  // Link
+  int vertexSourceCount = sizeof(vertexSources) / sizeof(vertexSources[0]);
+  int fragmentSourceCount = sizeof(fragmentSources) / sizeof(fragmentSources[0]);
   uint32_t program = glCreateProgram();
-  glAttachShader(program, vertexShader);
-  glAttachShader(program, fragmentShader);
-  glBindAttribLocation(program, LOVR_SHADER_POSITION, "lovrPosition");
-  glBindAttribLocation(program, LOVR_SHADER_NORMAL, "lovrNormal");
-  glBindAttribLocation(program, LOVR_SHADER_TEX_COORD, "lovrTexCoord");
-  glBindAttribLocation(program, LOVR_SHADER_VERTEX_COLOR, "lovrVertexColor");
-  glBindAttribLocation(program, LOVR_SHADER_TANGENT, "lovrTangent");
-  glBindAttribLocation(program, LOVR_SHADER_BONES, "lovrBones");
-  glBindAttribLocation(program, LOVR_SHADER_BONE_WEIGHTS, "lovrBoneWeights");
-  glBindAttribLocation(program, LOVR_SHADER_DRAW_ID, "lovrDrawID");
-  linkProgram(program);
-  glDetachShader(program, vertexShader);
-  glDeleteShader(vertexShader);
-  glDetachShader(program, fragmentShader);
-  glDeleteShader(fragmentShader);
-  shader->program = program;
-  shader->type = SHADER_GRAPHICS;
 
-  // Generic attributes
-  lovrGpuUseProgram(program);
-  glVertexAttrib4fv(LOVR_SHADER_VERTEX_COLOR, (float[4]) { 1., 1., 1., 1. });
-  glVertexAttribI4uiv(LOVR_SHADER_BONES, (uint32_t[4]) { 0., 0., 0., 0. });
-  glVertexAttrib4fv(LOVR_SHADER_BONE_WEIGHTS, (float[4]) { 1., 0., 0., 0. });
-  glVertexAttribI4ui(LOVR_SHADER_DRAW_ID, 0, 0, 0, 0);
+  bool cached = false;
 
-  lovrShaderSetupUniforms(shader);
+#ifdef LOVR_ENABLE_FILESYSTEM
+  if (state.shaderCache) {
+    shader->cacheKey = lovrShaderGetCacheKey(vertexSources, vertexSourceCount, fragmentSources, fragmentSourceCount, multiview);
+    cached = lovrShaderLoadBinary(program, shader->cacheKey);
+  }
+#endif
 
-  // Attribute cache
-  int32_t attributeCount;
-  glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &attributeCount);
-  map_init(&shader->attributes);
-  for (int i = 0; i < attributeCount; i++) {
-    char name[LOVR_MAX_ATTRIBUTE_LENGTH];
-    GLint size;
-    GLenum type;
-    glGetActiveAttrib(program, i, LOVR_MAX_ATTRIBUTE_LENGTH, NULL, &size, &type, name);
-    map_set(&shader->attributes, name, glGetAttribLocation(program, name));
+  // Compile and link without waiting on the results, those get checked when the shader is finished
+  if (!cached) {
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSources, vertexSourceCount);
+    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSources, fragmentSourceCount);
+
+    // Link
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glBindAttribLocation(program, LOVR_SHADER_POSITION, "lovrPosition");
+    glBindAttribLocation(program, LOVR_SHADER_NORMAL, "lovrNormal");
+    glBindAttribLocation(program, LOVR_SHADER_TEX_COORD, "lovrTexCoord");
+    glBindAttribLocation(program, LOVR_SHADER_VERTEX_COLOR, "lovrVertexColor");
+    glBindAttribLocation(program, LOVR_SHADER_TANGENT, "lovrTangent");
+    glBindAttribLocation(program, LOVR_SHADER_BONES, "lovrBones");
+    glBindAttribLocation(program, LOVR_SHADER_BONE_WEIGHTS, "lovrBoneWeights");
+    glBindAttribLocation(program, LOVR_SHADER_DRAW_ID, "lovrDrawID");
+    if (state.shaderCache) {
+      glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    glLinkProgram(program);
+    shader->vertexShader = vertexShader;
+    shader->fragmentShader = fragmentShader;
   }
 
+  free(flagSource);
+  shader->program = program;
+  shader->type = SHADER_GRAPHICS;
   shader->multiview = multiview;
+  shader->pending = true;
+
+  if (!async || cached) {
+    lovrShaderWait(shader);
+  }
 
   return shader;
 }
@@ -2149,10 +2954,12 @@ Shader* lovrShaderInitCompute(Shader* shader, const char* source, ShaderFlag* fl
   char* flagSource = lovrShaderGetFlagCode(flags, flagCount);
   const char* sources[] = { lovrShaderComputePrefix, flagSource ? flagSource : "", source, lovrShaderComputeSuffix };
   GLuint computeShader = compileShader(GL_COMPUTE_SHADER, sources, sizeof(sources) / sizeof(sources[0]));
+  throwShaderError(checkShader(computeShader, GL_COMPUTE_SHADER));
   free(flagSource);
   GLuint program = glCreateProgram();
   glAttachShader(program, computeShader);
-  linkProgram(program);
+  glLinkProgram(program);
+  throwShaderError(checkProgram(program));
   glDetachShader(program, computeShader);
   glDeleteShader(computeShader);
   shader->program = program;
@@ -2165,7 +2972,13 @@ Shader* lovrShaderInitCompute(Shader* shader, const char* source, ShaderFlag* fl
 void lovrShaderDestroy(void* ref) {
   Shader* shader = ref;
   lovrGraphicsFlushShader(shader);
+  if (shader->vertexShader) {
+    glDeleteShader(shader->vertexShader);
+    glDeleteShader(shader->fragmentShader);
+  }
   glDeleteProgram(shader->program);
+  free(shader->error);
+  lovrRelease(Shader, shader->fallback);
   for (size_t i = 0; i < shader->uniforms.length; i++) {
     free(shader->uniforms.data[i].value.data);
   }
@@ -2182,6 +2995,39 @@ void lovrShaderDestroy(void* ref) {
   map_deinit(&shader->blockMap);
 }
 
+// Shaders that failed to compile are never ready
+bool lovrShaderIsReady(Shader* shader) {
+  if (!shader->pending) {
+    return !shader->error;
+  }
+
+#ifndef LOVR_WEBGL
+  // Without the extension there's no way to ask, so the shader gets finished synchronously
+  if (GLAD_GL_KHR_parallel_shader_compile) {
+    int complete;
+    glGetProgramiv(shader->program, GL_COMPLETION_STATUS_KHR, &complete);
+    if (!complete) {
+      return false;
+    }
+  }
+#endif
+
+  lovrShaderFinishGraphics(shader);
+  return !shader->error;
+}
+
+void lovrShaderWait(Shader* shader) {
+  if (shader->pending) {
+    lovrShaderFinishGraphics(shader);
+  }
+
+  throwShaderError(shader->error);
+}
+
+const char* lovrShaderGetError(Shader* shader) {
+  return shader->error;
+}
+
 // Mesh
 
 Mesh* lovrMeshInit(Mesh* mesh, DrawMode mode, Buffer* vertexBuffer, uint32_t vertexCount) {
@@ -2203,6 +3049,11 @@ void lovrMeshDestroy(void* ref) {
     lovrRelease(Buffer, mesh->attributes[i].buffer);
   }
   map_deinit(&mesh->attributeMap);
+  if (mesh->vertexBlob) {
+    mesh->vertexBlob->data = NULL;
+    mesh->vertexBlob->size = 0;
+    lovrRelease(Blob, mesh->vertexBlob);
+  }
   lovrRelease(Buffer, mesh->vertexBuffer);
   lovrRelease(Buffer, mesh->indexBuffer);
   lovrRelease(Material, mesh->material);
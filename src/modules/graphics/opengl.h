@@ -13,6 +13,7 @@
 
 #define GPU_BUFFER_FIELDS \
   uint8_t incoherent; \
+  bool shadow; \
   uint32_t id;
 
 #define GPU_CANVAS_FIELDS \
@@ -21,15 +22,31 @@
   uint32_t resolveBuffer; \
   uint32_t depthBuffer;
 
+#define GPU_READBACK_FIELDS \
+  uint32_t buffer; \
+  GLsync fence;
+
 #define GPU_MESH_FIELDS \
   uint32_t vao; \
   uint32_t ibo;
 
 #define GPU_SHADER_FIELDS \
-  uint32_t program;
+  uint32_t program; \
+  uint32_t vertexShader; \
+  uint32_t fragmentShader; \
+  uint64_t cacheKey; \
+  char* error; \
+  uint32_t textureGeneration; \
+  uint32_t imageGeneration; \
+  int imageCount; \
+  int viewIdLocation; \
+  int viewportCountLocation; \
+  int viewId; \
+  int viewportCount;
 
 #define GPU_TEXTURE_FIELDS \
   uint8_t incoherent; \
+  uint64_t upload; \
   GLuint id; \
   GLuint msaaId; \
   GLenum target;
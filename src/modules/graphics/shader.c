@@ -62,12 +62,13 @@ static const char* getUniformTypeName(const Uniform* uniform) {
 
 Shader* lovrShaderInitDefault(Shader* shader, DefaultShader type, ShaderFlag* flags, uint32_t flagCount) {
   switch (type) {
-    case SHADER_UNLIT: return lovrShaderInitGraphics(shader, NULL, NULL, flags, flagCount, true);
-    case SHADER_STANDARD: return lovrShaderInitGraphics(shader, lovrStandardVertexShader, lovrStandardFragmentShader, flags, flagCount, true);
-    case SHADER_CUBE: return lovrShaderInitGraphics(shader, lovrCubeVertexShader, lovrCubeFragmentShader, flags, flagCount, true);
-    case SHADER_PANO: return lovrShaderInitGraphics(shader, lovrCubeVertexShader, lovrPanoFragmentShader, flags, flagCount, true);
-    case SHADER_FONT: return lovrShaderInitGraphics(shader, NULL, lovrFontFragmentShader, flags, flagCount, true);
-    case SHADER_FILL: return lovrShaderInitGraphics(shader, lovrFillVertexShader, NULL, flags, flagCount, true);
+    case SHADER_UNLIT: return lovrShaderInitGraphics(shader, NULL, NULL, flags, flagCount, true, false);
+    case SHADER_STANDARD: return lovrShaderInitGraphics(shader, lovrStandardVertexShader, lovrStandardFragmentShader, flags, flagCount, true, false);
+    case SHADER_CUBE: return lovrShaderInitGraphics(shader, lovrCubeVertexShader, lovrCubeFragmentShader, flags, flagCount, true, false);
+    case SHADER_PANO: return lovrShaderInitGraphics(shader, lovrCubeVertexShader, lovrPanoFragmentShader, flags, flagCount, true, false);
+    case SHADER_FONT: return lovrShaderInitGraphics(shader, NULL, lovrFontFragmentShader, flags, flagCount, true, false);
+    case SHADER_FILL: return lovrShaderInitGraphics(shader, lovrFillVertexShader, NULL, flags, flagCount, true, false);
+    case SHADER_SPRITE: return lovrShaderInitGraphics(shader, lovrSpriteVertexShader, NULL, flags, flagCount, true, false);
     default: lovrThrow("Unknown default shader type"); return NULL;
   }
 }
@@ -76,16 +77,31 @@ ShaderType lovrShaderGetType(Shader* shader) {
   return shader->type;
 }
 
+Shader* lovrShaderGetFallback(Shader* shader) {
+  return shader->fallback;
+}
+
+void lovrShaderSetFallback(Shader* shader, Shader* fallback) {
+  lovrAssert(fallback != shader, "A Shader can not be its own fallback");
+  lovrAssert(!fallback || lovrShaderGetType(fallback) == SHADER_GRAPHICS, "Compute shaders can not be used as a fallback");
+  lovrRetain(fallback);
+  lovrRelease(Shader, shader->fallback);
+  shader->fallback = fallback;
+}
+
 int lovrShaderGetAttributeLocation(Shader* shader, const char* name) {
+  lovrShaderWait(shader);
   int* location = map_get(&shader->attributes, name);
   return location ? *location : -1;
 }
 
 bool lovrShaderHasUniform(Shader* shader, const char* name) {
+  lovrShaderWait(shader);
   return map_get(&shader->uniformMap, name) != NULL;
 }
 
 const Uniform* lovrShaderGetUniform(Shader* shader, const char* name) {
+  lovrShaderWait(shader);
   size_t* index = map_get(&shader->uniformMap, name);
   if (!index) {
     return false;
@@ -95,6 +111,7 @@ const Uniform* lovrShaderGetUniform(Shader* shader, const char* name) {
 }
 
 static void lovrShaderSetUniform(Shader* shader, const char* name, UniformType type, void* data, int start, int count, int size, const char* debug) {
+  lovrShaderWait(shader);
   size_t* index = map_get(&shader->uniformMap, name);
   if (!index) {
     return;
@@ -109,6 +126,7 @@ static void lovrShaderSetUniform(Shader* shader, const char* name, UniformType t
     lovrGraphicsFlushShader(shader);
     memcpy(dest, data, count * size);
     uniform->dirty = true;
+    shader->dirty = true;
   }
 }
 
@@ -140,6 +158,7 @@ void lovrShaderSetColor(Shader* shader, const char* name, Color color) {
 }
 
 void lovrShaderSetBlock(Shader* shader, const char* name, Buffer* buffer, size_t offset, size_t size, UniformAccess access) {
+  lovrShaderWait(shader);
   int* id = map_get(&shader->blockMap, name);
   if (!id) return;
 
@@ -58,6 +58,7 @@ typedef enum {
   SHADER_PANO,
   SHADER_FONT,
   SHADER_FILL,
+  SHADER_SPRITE,
   MAX_DEFAULT_SHADERS
 } DefaultShader;
 
@@ -112,18 +113,21 @@ typedef arr_t(UniformBlock) arr_block_t;
 
 typedef struct Shader {
   ShaderType type;
+  struct Shader* fallback;
   arr_uniform_t uniforms;
   arr_block_t blocks[2];
   map_int_t attributes;
   map_t(size_t) uniformMap;
   map_int_t blockMap;
   bool multiview;
+  bool dirty;
+  bool pending;
   GPU_SHADER_FIELDS
 } Shader;
 
 // Shader
 
-Shader* lovrShaderInitGraphics(Shader* shader, const char* vertexSource, const char* fragmentSource, ShaderFlag* flags, uint32_t flagCount, bool multiview);
+Shader* lovrShaderInitGraphics(Shader* shader, const char* vertexSource, const char* fragmentSource, ShaderFlag* flags, uint32_t flagCount, bool multiview, bool async);
 Shader* lovrShaderInitCompute(Shader* shader, const char* source, ShaderFlag* flags, uint32_t flagCount);
 Shader* lovrShaderInitDefault(Shader* shader, DefaultShader type, ShaderFlag* flags, uint32_t flagCount);
 #define lovrShaderCreateGraphics(...) lovrShaderInitGraphics(lovrAlloc(Shader), __VA_ARGS__)
@@ -131,6 +135,11 @@ Shader* lovrShaderInitDefault(Shader* shader, DefaultShader type, ShaderFlag* fl
 #define lovrShaderCreateDefault(...) lovrShaderInitDefault(lovrAlloc(Shader), __VA_ARGS__)
 void lovrShaderDestroy(void* ref);
 ShaderType lovrShaderGetType(Shader* shader);
+bool lovrShaderIsReady(Shader* shader);
+void lovrShaderWait(Shader* shader);
+const char* lovrShaderGetError(Shader* shader);
+Shader* lovrShaderGetFallback(Shader* shader);
+void lovrShaderSetFallback(Shader* shader, Shader* fallback);
 int lovrShaderGetAttributeLocation(Shader* shader, const char* name);
 bool lovrShaderHasUniform(Shader* shader, const char* name);
 const Uniform* lovrShaderGetUniform(Shader* shader, const char* name);
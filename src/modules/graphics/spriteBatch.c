@@ -0,0 +1,109 @@
+#include "graphics/spriteBatch.h"
+#include "graphics/buffer.h"
+#include "graphics/graphics.h"
+#include "graphics/mesh.h"
+#include "graphics/texture.h"
+#include "core/ref.h"
+#include "core/util.h"
+#include <stddef.h>
+#include <stdlib.h>
+
+SpriteBatch* lovrSpriteBatchInit(SpriteBatch* batch, Texture* texture, uint32_t capacity) {
+  lovrAssert(capacity > 0, "SpriteBatch capacity must be positive");
+  batch->capacity = capacity;
+  lovrSpriteBatchSetTexture(batch, texture);
+
+  // A unit quad in the xy plane, drawn as a strip once per sprite
+  float vertices[] = {
+    -.5f,  .5f, 0.f, 0.f, 1.f,
+    -.5f, -.5f, 0.f, 0.f, 0.f,
+     .5f,  .5f, 0.f, 1.f, 1.f,
+     .5f, -.5f, 0.f, 1.f, 0.f
+  };
+
+  size_t stride = 5 * sizeof(float);
+  batch->vertexBuffer = lovrBufferCreate(sizeof(vertices), vertices, BUFFER_VERTEX, USAGE_STATIC, false);
+  batch->instanceBuffer = lovrBufferCreate(capacity * sizeof(Sprite), NULL, BUFFER_VERTEX, USAGE_DYNAMIC, true);
+  batch->sprites = lovrBufferGetPointer(batch->instanceBuffer);
+  batch->mesh = lovrMeshCreate(DRAW_TRIANGLE_STRIP, batch->vertexBuffer, 4);
+
+  Buffer* instances = batch->instanceBuffer;
+  lovrMeshAttachAttribute(batch->mesh, "lovrPosition", &(MeshAttribute) { .buffer = batch->vertexBuffer, .offset = 0, .stride = stride, .type = F32, .components = 3 });
+  lovrMeshAttachAttribute(batch->mesh, "lovrTexCoord", &(MeshAttribute) { .buffer = batch->vertexBuffer, .offset = 12, .stride = stride, .type = F32, .components = 2 });
+  lovrMeshAttachAttribute(batch->mesh, "lovrSpritePosition", &(MeshAttribute) { .buffer = instances, .offset = offsetof(Sprite, position), .stride = sizeof(Sprite), .type = F32, .components = 3, .divisor = 1 });
+  lovrMeshAttachAttribute(batch->mesh, "lovrSpriteRotation", &(MeshAttribute) { .buffer = instances, .offset = offsetof(Sprite, rotation), .stride = sizeof(Sprite), .type = F32, .components = 4, .divisor = 1 });
+  lovrMeshAttachAttribute(batch->mesh, "lovrSpriteScale", &(MeshAttribute) { .buffer = instances, .offset = offsetof(Sprite, scale), .stride = sizeof(Sprite), .type = F32, .components = 2, .divisor = 1 });
+  lovrMeshAttachAttribute(batch->mesh, "lovrSpriteRect", &(MeshAttribute) { .buffer = instances, .offset = offsetof(Sprite, rect), .stride = sizeof(Sprite), .type = F32, .components = 4, .divisor = 1 });
+  lovrMeshAttachAttribute(batch->mesh, "lovrSpriteColor", &(MeshAttribute) { .buffer = instances, .offset = offsetof(Sprite, color), .stride = sizeof(Sprite), .type = U8, .components = 4, .divisor = 1, .normalized = true });
+
+  // Only used when a single sprite is drawn, otherwise the draw id is disabled and reads as zero
+  lovrMeshAttachAttribute(batch->mesh, "lovrDrawID", &(MeshAttribute) {
+    .buffer = lovrGraphicsGetIdentityBuffer(),
+    .type = U8,
+    .components = 1,
+    .divisor = 1,
+    .integer = true
+  });
+
+  return batch;
+}
+
+void lovrSpriteBatchDestroy(void* ref) {
+  SpriteBatch* batch = ref;
+  lovrRelease(Texture, batch->texture);
+  lovrRelease(Mesh, batch->mesh);
+  lovrRelease(Buffer, batch->vertexBuffer);
+  lovrRelease(Buffer, batch->instanceBuffer);
+}
+
+Texture* lovrSpriteBatchGetTexture(SpriteBatch* batch) {
+  return batch->texture;
+}
+
+void lovrSpriteBatchSetTexture(SpriteBatch* batch, Texture* texture) {
+  lovrAssert(!texture || lovrTextureGetType(texture) == TEXTURE_2D, "SpriteBatch textures must be 2D");
+  lovrRetain(texture);
+  lovrRelease(Texture, batch->texture);
+  batch->texture = texture;
+}
+
+uint32_t lovrSpriteBatchGetCapacity(SpriteBatch* batch) {
+  return batch->capacity;
+}
+
+uint32_t lovrSpriteBatchGetCount(SpriteBatch* batch) {
+  return batch->count;
+}
+
+const Sprite* lovrSpriteBatchGetSprite(SpriteBatch* batch, uint32_t index) {
+  lovrAssert(index < batch->count, "Invalid sprite index '%d'", index + 1);
+  return &batch->sprites[index];
+}
+
+// Setting the sprite just past the end appends it.  Only the bytes of the changed sprite are
+// uploaded, so moving a few sprites in a large batch is cheap.
+void lovrSpriteBatchSetSprite(SpriteBatch* batch, uint32_t index, Sprite* sprite) {
+  lovrAssert(index <= batch->count, "Invalid sprite index '%d'", index + 1);
+  lovrAssert(index < batch->capacity, "SpriteBatch is full (capacity is %d)", batch->capacity);
+  lovrGraphicsFlushMesh(batch->mesh);
+  batch->sprites[index] = *sprite;
+  lovrBufferFlush(batch->instanceBuffer, index * sizeof(Sprite), sizeof(Sprite));
+  batch->count += index == batch->count;
+}
+
+// Moves the last sprite into the removed slot, so the index of the last sprite changes
+void lovrSpriteBatchRemove(SpriteBatch* batch, uint32_t index) {
+  lovrAssert(index < batch->count, "Invalid sprite index '%d'", index + 1);
+  uint32_t last = --batch->count;
+  if (index != last) {
+    lovrSpriteBatchSetSprite(batch, index, &batch->sprites[last]);
+  }
+}
+
+void lovrSpriteBatchClear(SpriteBatch* batch) {
+  batch->count = 0;
+}
+
+Mesh* lovrSpriteBatchGetMesh(SpriteBatch* batch) {
+  return batch->mesh;
+}
@@ -0,0 +1,39 @@
+#include <stdint.h>
+
+#pragma once
+
+struct Buffer;
+struct Mesh;
+struct Texture;
+
+// Matches the layout of the per-instance vertex attributes read by the sprite shader
+typedef struct {
+  float position[3];
+  float rotation[4];
+  float scale[2];
+  float rect[4];
+  uint8_t color[4];
+} Sprite;
+
+typedef struct SpriteBatch {
+  struct Texture* texture;
+  struct Buffer* vertexBuffer;
+  struct Buffer* instanceBuffer;
+  struct Mesh* mesh;
+  Sprite* sprites;
+  uint32_t capacity;
+  uint32_t count;
+} SpriteBatch;
+
+SpriteBatch* lovrSpriteBatchInit(SpriteBatch* batch, struct Texture* texture, uint32_t capacity);
+#define lovrSpriteBatchCreate(...) lovrSpriteBatchInit(lovrAlloc(SpriteBatch), __VA_ARGS__)
+void lovrSpriteBatchDestroy(void* ref);
+struct Texture* lovrSpriteBatchGetTexture(SpriteBatch* batch);
+void lovrSpriteBatchSetTexture(SpriteBatch* batch, struct Texture* texture);
+uint32_t lovrSpriteBatchGetCapacity(SpriteBatch* batch);
+uint32_t lovrSpriteBatchGetCount(SpriteBatch* batch);
+const Sprite* lovrSpriteBatchGetSprite(SpriteBatch* batch, uint32_t index);
+void lovrSpriteBatchSetSprite(SpriteBatch* batch, uint32_t index, Sprite* sprite);
+void lovrSpriteBatchRemove(SpriteBatch* batch, uint32_t index);
+void lovrSpriteBatchClear(SpriteBatch* batch);
+struct Mesh* lovrSpriteBatchGetMesh(SpriteBatch* batch);
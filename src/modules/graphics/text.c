@@ -0,0 +1,145 @@
+#include "graphics/text.h"
+#include "graphics/buffer.h"
+#include "graphics/font.h"
+#include "graphics/graphics.h"
+#include "graphics/mesh.h"
+#include "core/ref.h"
+#include "core/util.h"
+#include <stdlib.h>
+#include <string.h>
+
+Text* lovrTextInit(Text* text, Font* font, const char* string, size_t length, float wrap, HorizontalAlign halign, VerticalAlign valign) {
+  lovrRetain(font);
+  text->font = font;
+  text->wrap = wrap;
+  text->halign = halign;
+  text->valign = valign;
+  lovrTextSetString(text, string, length);
+  return text;
+}
+
+void lovrTextDestroy(void* ref) {
+  Text* text = ref;
+  lovrRelease(Font, text->font);
+  lovrRelease(Mesh, text->mesh);
+  lovrRelease(Buffer, text->vertexBuffer);
+  lovrRelease(Buffer, text->indexBuffer);
+  free(text->string);
+}
+
+Font* lovrTextGetFont(Text* text) {
+  return text->font;
+}
+
+const char* lovrTextGetString(Text* text, size_t* length) {
+  *length = text->length;
+  return text->string;
+}
+
+void lovrTextSetString(Text* text, const char* string, size_t length) {
+  if (text->string && length == text->length && !memcmp(string, text->string, length)) {
+    return;
+  }
+
+  text->string = realloc(text->string, length + 1);
+  lovrAssert(text->string, "Out of memory");
+  memcpy(text->string, string, length);
+  text->string[length] = '\0';
+  text->length = length;
+  text->dirty = true;
+}
+
+float lovrTextGetWrap(Text* text) {
+  return text->wrap;
+}
+
+void lovrTextSetWrap(Text* text, float wrap) {
+  text->dirty |= wrap != text->wrap;
+  text->wrap = wrap;
+}
+
+void lovrTextGetAlign(Text* text, HorizontalAlign* halign, VerticalAlign* valign) {
+  *halign = text->halign;
+  *valign = text->valign;
+}
+
+// Vertical alignment is applied when the Text is drawn, so only the horizontal one needs a rebuild
+void lovrTextSetAlign(Text* text, HorizontalAlign halign, VerticalAlign valign) {
+  text->dirty |= halign != text->halign;
+  text->halign = halign;
+  text->valign = valign;
+}
+
+// Rebuilds the glyph geometry if the string, the layout, or the Font's atlas has changed
+static void lovrTextUpdate(Text* text) {
+  Font* font = text->font;
+  lovrFontUpdate(font);
+
+  if (!text->dirty && text->fontVersion == font->version) {
+    return;
+  }
+
+  // Measuring adds any missing glyphs to the atlas, so it happens before the atlas version is saved
+  lovrFontMeasure(font, text->string, text->length, text->wrap, &text->width, &text->lineCount, &text->glyphCount);
+  text->fontVersion = font->version;
+  text->dirty = false;
+
+  if (text->glyphCount == 0) {
+    return;
+  }
+
+  if (text->glyphCount > text->capacity) {
+    text->capacity = 16;
+    while (text->capacity < text->glyphCount) {
+      text->capacity <<= 1;
+    }
+
+    lovrRelease(Mesh, text->mesh);
+    lovrRelease(Buffer, text->vertexBuffer);
+    lovrRelease(Buffer, text->indexBuffer);
+
+    size_t stride = 8 * sizeof(float);
+    text->vertexBuffer = lovrBufferCreate(text->capacity * 4 * stride, NULL, BUFFER_VERTEX, USAGE_DYNAMIC, false);
+    text->indexBuffer = lovrBufferCreate(text->capacity * 6 * sizeof(uint32_t), NULL, BUFFER_INDEX, USAGE_DYNAMIC, false);
+    text->mesh = lovrMeshCreate(DRAW_TRIANGLES, text->vertexBuffer, text->capacity * 4);
+
+    lovrMeshAttachAttribute(text->mesh, "lovrPosition", &(MeshAttribute) { .buffer = text->vertexBuffer, .offset = 0, .stride = stride, .type = F32, .components = 3 });
+    lovrMeshAttachAttribute(text->mesh, "lovrNormal", &(MeshAttribute) { .buffer = text->vertexBuffer, .offset = 12, .stride = stride, .type = F32, .components = 3 });
+    lovrMeshAttachAttribute(text->mesh, "lovrTexCoord", &(MeshAttribute) { .buffer = text->vertexBuffer, .offset = 24, .stride = stride, .type = F32, .components = 2 });
+    lovrMeshAttachAttribute(text->mesh, "lovrDrawID", &(MeshAttribute) {
+      .buffer = lovrGraphicsGetIdentityBuffer(),
+      .type = U8,
+      .components = 1,
+      .divisor = 1,
+      .integer = true
+    });
+  } else {
+    lovrGraphicsFlushMesh(text->mesh);
+  }
+
+  size_t vertexSize = text->glyphCount * 4 * 8 * sizeof(float);
+  size_t indexSize = text->glyphCount * 6 * sizeof(uint32_t);
+  float* vertices = lovrBufferMap(text->vertexBuffer, 0);
+  uint32_t* indices = lovrBufferMap(text->indexBuffer, 0);
+  lovrFontRender(font, text->string, text->length, text->wrap, text->halign, vertices, indices, 0);
+  lovrBufferFlush(text->vertexBuffer, 0, vertexSize);
+  lovrBufferFlush(text->indexBuffer, 0, indexSize);
+  lovrBufferUnmap(text->vertexBuffer);
+  lovrBufferUnmap(text->indexBuffer);
+
+  lovrMeshSetIndexBuffer(text->mesh, text->indexBuffer, text->capacity * 6, sizeof(uint32_t), 0);
+  lovrMeshSetDrawRange(text->mesh, 0, text->glyphCount * 6);
+}
+
+void lovrTextMeasure(Text* text, float* width, uint32_t* lineCount, uint32_t* glyphCount) {
+  lovrTextUpdate(text);
+  *width = text->width;
+  *lineCount = text->lineCount;
+  *glyphCount = text->glyphCount;
+}
+
+// Returns NULL if there's nothing to draw
+struct Mesh* lovrTextGetMesh(Text* text) {
+  lovrTextUpdate(text);
+  return text->glyphCount > 0 ? text->mesh : NULL;
+}
@@ -0,0 +1,41 @@
+#include "graphics/font.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#pragma once
+
+struct Buffer;
+struct Font;
+struct Mesh;
+
+typedef struct Text {
+  struct Font* font;
+  char* string;
+  size_t length;
+  float wrap;
+  HorizontalAlign halign;
+  VerticalAlign valign;
+  float width;
+  uint32_t lineCount;
+  uint32_t glyphCount;
+  uint32_t capacity;
+  uint32_t fontVersion;
+  struct Mesh* mesh;
+  struct Buffer* vertexBuffer;
+  struct Buffer* indexBuffer;
+  bool dirty;
+} Text;
+
+Text* lovrTextInit(Text* text, struct Font* font, const char* string, size_t length, float wrap, HorizontalAlign halign, VerticalAlign valign);
+#define lovrTextCreate(...) lovrTextInit(lovrAlloc(Text), __VA_ARGS__)
+void lovrTextDestroy(void* ref);
+struct Font* lovrTextGetFont(Text* text);
+const char* lovrTextGetString(Text* text, size_t* length);
+void lovrTextSetString(Text* text, const char* string, size_t length);
+float lovrTextGetWrap(Text* text);
+void lovrTextSetWrap(Text* text, float wrap);
+void lovrTextGetAlign(Text* text, HorizontalAlign* halign, VerticalAlign* valign);
+void lovrTextSetAlign(Text* text, HorizontalAlign halign, VerticalAlign valign);
+void lovrTextMeasure(Text* text, float* width, uint32_t* lineCount, uint32_t* glyphCount);
+struct Mesh* lovrTextGetMesh(Text* text);
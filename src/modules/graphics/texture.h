@@ -27,6 +27,8 @@ typedef struct Texture {
   bool srgb;
   bool mipmaps;
   bool allocated;
+  struct TextureData* streamData;
+  uint32_t streamLevel;
   GPU_TEXTURE_FIELDS
 } Texture;
 
@@ -36,7 +38,8 @@ Texture* lovrTextureInitFromHandle(Texture* texture, uint32_t handle, TextureTyp
 #define lovrTextureCreateFromHandle(...) lovrTextureInitFromHandle(lovrAlloc(Texture), __VA_ARGS__)
 void lovrTextureDestroy(void* ref);
 void lovrTextureAllocate(Texture* texture, uint32_t width, uint32_t height, uint32_t depth, TextureFormat format);
-void lovrTextureReplacePixels(Texture* texture, struct TextureData* data, uint32_t x, uint32_t y, uint32_t slice, uint32_t mipmap);
+void lovrTextureReplacePixels(Texture* texture, struct TextureData* data, uint32_t x, uint32_t y, uint32_t slice, uint32_t mipmap, bool async);
+bool lovrTextureIsReady(Texture* texture);
 uint32_t lovrTextureGetWidth(Texture* texture, uint32_t mipmap);
 uint32_t lovrTextureGetHeight(Texture* texture, uint32_t mipmap);
 uint32_t lovrTextureGetDepth(Texture* texture, uint32_t mipmap);
@@ -99,6 +99,14 @@ function lovr.boot()
       offset = 1.7,
       msaa = 4
     },
+    graphics = {
+      shadercache = true,
+      glyphcache = false,
+      streams = {
+        vertices = 65535,
+        indices = 65536
+      }
+    },
     math = {
       globals = true
     },
@@ -107,6 +115,7 @@ function lovr.boot()
       height = 600,
       fullscreen = false,
       resizable = false,
+      headless = false,
       msaa = 0,
       title = 'LÖVR',
       icon = nil,
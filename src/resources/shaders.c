@@ -2,7 +2,7 @@
 
 const char* lovrShaderVertexPrefix = ""
 "#define VERTEX VERTEX \n"
-"#define MAX_BONES 48 \n"
+"#define MAX_BONES 256 \n"
 "#define MAX_DRAWS 256 \n"
 "#define lovrView lovrViews[lovrViewID] \n"
 "#define lovrProjection lovrProjections[lovrViewID] \n"
@@ -34,9 +34,9 @@ const char* lovrShaderVertexPrefix = ""
 "layout(std140) uniform lovrModelBlock { mat4 lovrModels[MAX_DRAWS]; }; \n"
 "layout(std140) uniform lovrColorBlock { vec4 lovrColors[MAX_DRAWS]; }; \n"
 "layout(std140) uniform lovrFrameBlock { mat4 lovrViews[2]; mat4 lovrProjections[2]; }; \n"
+"layout(std140) uniform lovrPoseBlock { mat4 lovrPose[MAX_BONES]; }; \n"
 "uniform mat3 lovrMaterialTransform; \n"
 "uniform float lovrPointSize; \n"
-"uniform mat4 lovrPose[MAX_BONES]; \n"
 "uniform lowp int lovrViewportCount; \n"
 "#if defined MULTIVIEW \n"
 "layout(num_views = 2) in; \n"
@@ -294,6 +294,21 @@ const char* lovrCubeVertexShader = ""
 "  return vertex; \n"
 "}";
 
+const char* lovrSpriteVertexShader = ""
+"in vec3 lovrSpritePosition; \n"
+"in vec4 lovrSpriteRotation; \n"
+"in vec2 lovrSpriteScale; \n"
+"in vec4 lovrSpriteRect; \n"
+"in vec4 lovrSpriteColor; \n"
+"vec4 position(mat4 projection, mat4 transform, vec4 vertex) { \n"
+"  vec3 p = vec3(vertex.xy * lovrSpriteScale, vertex.z); \n"
+"  vec3 q = lovrSpriteRotation.xyz; \n"
+"  p += 2. * cross(q, cross(q, p) + lovrSpriteRotation.w * p); \n"
+"  texCoord = (lovrMaterialTransform * vec3(lovrSpriteRect.xy + lovrTexCoord * lovrSpriteRect.zw, 1.)).xy; \n"
+"  vertexColor = lovrSpriteColor; \n"
+"  return projection * transform * vec4(p + lovrSpritePosition, 1.); \n"
+"}";
+
 const char* lovrCubeFragmentShader = ""
 "in vec3 texturePosition[2]; \n"
 "uniform samplerCube lovrSkyboxTexture; \n"
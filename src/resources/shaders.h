@@ -15,6 +15,7 @@ extern const char* lovrCubeFragmentShader;
 extern const char* lovrPanoFragmentShader;
 extern const char* lovrFontFragmentShader;
 extern const char* lovrFillVertexShader;
+extern const char* lovrSpriteVertexShader;
 
 extern const char* lovrShaderScalarUniforms[];
 extern const char* lovrShaderColorUniforms[];